@@ -0,0 +1,101 @@
+/**
+ * @file admission-control.cpp
+ * @brief Implementation of the AdmissionControl class.
+ */
+
+#include "admission-control.h"
+#include <limits>
+
+/**
+ * @brief Constructs admission control.
+ * @param cfg Parameters; with no budget, everything is admitted.
+ */
+AdmissionControl::AdmissionControl(const AdmissionConfig &cfg)
+    : config(cfg), meanDuration(0.0), hasMean(false), offered(), rejected() {}
+
+/**
+ * @brief Retrieves the parameters.
+ * @return Parameters.
+ */
+const AdmissionConfig& AdmissionControl::getConfig() const {
+    return config;
+}
+
+/**
+ * @brief Checks whether a latency budget is set.
+ * @return True if arrivals are measured against a budget.
+ */
+bool AdmissionControl::isEnabled() const {
+    return config.budget > 0.0;
+}
+
+/**
+ * @brief Estimates how long a new arrival would wait.
+ * @param queued Requests waiting ahead of it.
+ * @param serving Servers in service.
+ * @return Expected wait in ticks; infinite with no servers.
+ */
+double AdmissionControl::estimateWait(size_t queued, size_t serving) const {
+    if (serving == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return (double)queued * meanDuration / (double)serving;
+}
+
+/**
+ * @brief Removes the arrivals that would wait past their class's share of the budget,
+ *        keeping the others in order.
+ *
+ * Every arrival updates the mean duration, rejected or not, since it describes
+ * the load being offered. Without shedding, arrivals are only counted.
+ *
+ * @param rs Arriving requests; the kept ones are moved to the front.
+ * @param n Number of requests.
+ * @param queued Requests already waiting; each admitted one queues behind them.
+ * @param serving Servers in service.
+ * @return Number of requests kept.
+ */
+size_t AdmissionControl::filter(Request *rs, size_t n, size_t queued, size_t serving) {
+    if (!isEnabled()) {
+        return n;
+    }
+    // Weight of the newest duration in the moving average, about the last 64 arrivals
+    const double ALPHA = 1.0 / 64.0;
+    size_t kept = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t cls = Scheduler::classOf(rs[i].getJobType());
+        double duration = (double)rs[i].getDuration();
+        meanDuration = hasMean ? meanDuration + ALPHA * (duration - meanDuration) : duration;
+        hasMean = true;
+        offered[cls]++;
+
+        double limit = config.budget;
+        if (rs[i].getJobType() == JobType::Standard) {
+            limit *= config.standardShare;
+        }
+        if (config.shed && estimateWait(queued + kept, serving) > limit) {
+            rejected[cls]++;
+            continue;
+        }
+        rs[kept++] = rs[i];
+    }
+    return kept;
+}
+
+/**
+ * @brief Retrieves the number of arrivals of a class seen so far.
+ * @param cls Class index (see Scheduler::classOf()).
+ * @return Offered requests.
+ */
+uint64_t AdmissionControl::getOffered(size_t cls) const {
+    return offered[cls];
+}
+
+/**
+ * @brief Retrieves the number of arrivals of a class shed so far.
+ * @param cls Class index (see Scheduler::classOf()).
+ * @return Rejected requests.
+ */
+uint64_t AdmissionControl::getRejected(size_t cls) const {
+    return rejected[cls];
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+/**
+ * @file admission-control.h
+ * @brief Header file for the AdmissionControl class that sheds arrivals under overload.
+ */
+
+#ifndef ADMISSIONCONTROL_H
+#define ADMISSIONCONTROL_H
+
+#include <cstddef>
+#include <cstdint>
+#include "request.h"
+#include "scheduler.h"
+
+/**
+ * @struct AdmissionConfig
+ * @brief Parameters of admission control.
+ */
+struct AdmissionConfig {
+    double budget = 0.0;            ///< Longest acceptable wait in ticks; 0 = no budget.
+    bool shed = true;               ///< Whether arrivals are rejected, or only goodput is measured.
+    double standardShare = 0.8;     ///< Share of the budget at which standard requests are shed.
+};
+
+/**
+ * @class AdmissionControl
+ * @brief Rejects arrivals whose expected wait would exceed a latency budget.
+ *
+ * The expected wait of an arrival is the queue ahead of it divided by the
+ * current service rate, which is the servers in service over the mean request
+ * duration. The mean is a moving average over recent arrivals, so it follows
+ * shifts in the workload.
+ *
+ * Standard requests are shed once the estimate passes standardShare of the
+ * budget and priority requests only once it passes the whole budget, so under
+ * overload the standard class gives way first and priority traffic keeps the
+ * headroom in between.
+ */
+class AdmissionControl {
+private:
+    AdmissionConfig config;                     ///< Budget and shedding parameters.
+    double meanDuration;                        ///< Moving average of arrival durations.
+    bool hasMean;                               ///< Whether any arrival was seen yet.
+    uint64_t offered[Scheduler::CLASSES];       ///< Arrivals per class.
+    uint64_t rejected[Scheduler::CLASSES];      ///< Arrivals shed per class.
+
+public:
+    /**
+     * @brief Constructs admission control.
+     * @param cfg Parameters; with no budget, everything is admitted.
+     */
+    explicit AdmissionControl(const AdmissionConfig &cfg = AdmissionConfig());
+
+    /**
+     * @brief Retrieves the parameters.
+     * @return Parameters.
+     */
+    const AdmissionConfig& getConfig() const;
+
+    /**
+     * @brief Checks whether a latency budget is set.
+     * @return True if arrivals are measured against a budget.
+     */
+    bool isEnabled() const;
+
+    /**
+     * @brief Estimates how long a new arrival would wait.
+     * @param queued Requests waiting ahead of it.
+     * @param serving Servers in service.
+     * @return Expected wait in ticks; infinite with no servers.
+     */
+    double estimateWait(size_t queued, size_t serving) const;
+
+    /**
+     * @brief Removes the arrivals that would wait past their class's share of the budget,
+     *        keeping the others in order.
+     * @param rs Arriving requests; the kept ones are moved to the front.
+     * @param n Number of requests.
+     * @param queued Requests already waiting; each admitted one queues behind them.
+     * @param serving Servers in service.
+     * @return Number of requests kept.
+     */
+    size_t filter(Request *rs, size_t n, size_t queued, size_t serving);
+
+    /**
+     * @brief Retrieves the number of arrivals of a class seen so far.
+     * @param cls Class index (see Scheduler::classOf()).
+     * @return Offered requests.
+     */
+    uint64_t getOffered(size_t cls) const;
+
+    /**
+     * @brief Retrieves the number of arrivals of a class shed so far.
+     * @param cls Class index (see Scheduler::classOf()).
+     * @return Rejected requests.
+     */
+    uint64_t getRejected(size_t cls) const;
+};
+
+#endif
\ No newline at end of file
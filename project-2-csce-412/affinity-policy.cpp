@@ -0,0 +1,305 @@
+/**
+ * @file affinity-policy.cpp
+ * @brief Implementation of the consistent-hash routing policies.
+ */
+
+#include "affinity-policy.h"
+#include <algorithm>
+
+namespace {
+
+const size_t MAGLEV_SLOTS_PER_SERVER = 100;         ///< Table slots per server, roughly.
+const size_t MAGLEV_MIN_TABLE = 1021;               ///< Smallest table.
+const size_t MAGLEV_MAX_TABLE = (size_t)1 << 24;    ///< Largest table, to bound rebuild cost.
+
+/**
+ * @brief Finds the smallest prime at or above a value.
+ * @param n Lower bound.
+ * @return Prime.
+ */
+size_t nextPrime(size_t n) {
+    for (;; n++) {
+        bool prime = n >= 2;
+        for (size_t d = 2; d * d <= n && prime; d++) {
+            prime = n % d != 0;
+        }
+        if (prime) {
+            return n;
+        }
+    }
+}
+
+/**
+ * @brief Hashes a request's source address.
+ * @param r Request.
+ * @return Hash.
+ */
+uint64_t keyHash(const Request &r) {
+    return mixHash(r.getIpIn());
+}
+
+} // namespace
+
+/**
+ * @brief Mixes a 64-bit value into a well-distributed hash (the SplitMix64 finalizer).
+ * @param x Value to hash.
+ * @return Hash.
+ */
+uint64_t mixHash(uint64_t x) {
+    x += 0x9e3779b97f4a7c15;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Constructs an empty ring.
+ * @param vnodes Points per server.
+ */
+RingHashPolicy::RingHashPolicy(size_t vnodes)
+    : virtualNodes(std::max<size_t>(vnodes, 1)), servers(0), stale(false), buckets(1, 0),
+      bucketShift(32) {}
+
+/**
+ * @brief Retrieves the policy's name.
+ * @return "ring".
+ */
+const char *RingHashPolicy::name() const {
+    return "ring";
+}
+
+/**
+ * @brief Reports that a source address always maps to the same server.
+ * @return True.
+ */
+bool RingHashPolicy::isAffine() const {
+    return true;
+}
+
+/**
+ * @brief Places the points of servers [0, n) on the ring and rebuilds the bucket index.
+ * @param n Number of servers.
+ */
+void RingHashPolicy::resize(size_t n) {
+    servers = n;
+    if (!speeds.empty()) {
+        speeds.resize(n, 1.0);
+    }
+    build();
+}
+
+/**
+ * @brief Places the points of every server on the ring and rebuilds the bucket index.
+ * 
+ * Point positions depend only on the server index and replica number, so the
+ * points of servers that stay are unchanged.
+ */
+void RingHashPolicy::build() {
+    stale = false;
+    ring.clear();
+    ring.reserve(servers * virtualNodes);
+    for (size_t s = 0; s < servers; s++) {
+        size_t points = virtualNodes;
+        if (!speeds.empty()) {
+            points = std::max<size_t>((size_t)(virtualNodes * speeds[s] + 0.5), 1);
+        }
+        for (size_t v = 0; v < points; v++) {
+            uint32_t position = (uint32_t)(mixHash((uint64_t)s << 32 | v) >> 32);
+            ring.push_back({position, (uint32_t)s});
+        }
+    }
+    std::sort(ring.begin(), ring.end(), [](const Point &a, const Point &b) {
+        return a.position != b.position ? a.position < b.position : a.server < b.server;
+    });
+
+    // About one point per bucket, so a lookup scans a constant number of points
+    unsigned bits = 0;
+    while (((size_t)1 << bits) < ring.size() && bits < 24) {
+        bits++;
+    }
+    bucketShift = 32 - bits;
+    buckets.assign((size_t)1 << bits, 0);
+    size_t i = 0;
+    for (size_t b = 0; b < buckets.size(); b++) {
+        uint64_t start = (uint64_t)b << bucketShift;
+        while (i < ring.size() && ring[i].position < start) {
+            i++;
+        }
+        buckets[b] = (uint32_t)i;
+    }
+}
+
+/**
+ * @brief Ignores load updates; placement depends only on the source address.
+ * @param server Server index.
+ * @param requests Outstanding requests.
+ * @param work Outstanding work.
+ */
+void RingHashPolicy::update(size_t, size_t, size_t) {}
+
+/**
+ * @brief Records a server's speed; the ring is rebuilt before the next pick.
+ * @param server Server index.
+ * @param speed Speed factor.
+ */
+void RingHashPolicy::setSpeed(size_t server, double speed) {
+    if (speeds.empty()) {
+        speeds.assign(servers, 1.0);
+    }
+    if (server < speeds.size()) {
+        speeds[server] = speed;
+        stale = true;
+    }
+}
+
+/**
+ * @brief Finds the owner of a position on the ring.
+ * @param position Hashed key.
+ * @return Server index.
+ */
+size_t RingHashPolicy::owner(uint32_t position) const {
+    size_t i = buckets[(uint64_t)position >> bucketShift];
+    while (i < ring.size() && ring[i].position < position) {
+        i++;
+    }
+    return ring[i == ring.size() ? 0 : i].server;
+}
+
+/**
+ * @brief Picks the server owning the request's source address.
+ * @param r Request to route.
+ * @return Server index.
+ */
+size_t RingHashPolicy::pick(const Request &r) {
+    if (stale) {
+        build();
+    }
+    return owner((uint32_t)(keyHash(r) >> 32));
+}
+
+/**
+ * @brief Constructs an empty table.
+ */
+MaglevPolicy::MaglevPolicy() : servers(0), tableSize(0), stale(false) {}
+
+/**
+ * @brief Retrieves the policy's name.
+ * @return "maglev".
+ */
+const char *MaglevPolicy::name() const {
+    return "maglev";
+}
+
+/**
+ * @brief Reports that a source address always maps to the same server.
+ * @return True.
+ */
+bool MaglevPolicy::isAffine() const {
+    return true;
+}
+
+/**
+ * @brief Refills the table for servers [0, n), enlarging it first if the fleet outgrew it.
+ * @param n Number of servers.
+ */
+void MaglevPolicy::resize(size_t n) {
+    servers = n;
+    if (!speeds.empty()) {
+        speeds.resize(n, 1.0);
+    }
+    size_t wanted = std::min(std::max(n * MAGLEV_SLOTS_PER_SERVER, MAGLEV_MIN_TABLE),
+                             MAGLEV_MAX_TABLE);
+    if (tableSize == 0 || (n * 10 > tableSize && wanted > tableSize)) {
+        tableSize = nextPrime(wanted);
+    }
+    populate();
+}
+
+/**
+ * @brief Refills the table for the current servers.
+ * 
+ * Server i prefers slots offset, offset + skip, offset + 2 skip, ... (mod the
+ * prime table size), with offset and skip derived from hashes of i. Servers
+ * claim slots round-robin, each taking its next preferred slot still free.
+ * With speeds set, each turn earns a server its speed over the fastest speed
+ * in credit, and it only claims a slot once it holds a whole credit.
+ */
+void MaglevPolicy::populate() {
+    stale = false;
+    table.assign(tableSize, UINT32_MAX);
+    if (servers == 0) {
+        return;
+    }
+    std::vector<uint64_t> offset(servers), skip(servers), next(servers, 0);
+    for (size_t i = 0; i < servers; i++) {
+        uint64_t h = mixHash(i);
+        offset[i] = h % tableSize;
+        skip[i] = mixHash(h) % (tableSize - 1) + 1;
+    }
+    std::vector<double> shares;
+    if (!speeds.empty()) {
+        double fastest = *std::max_element(speeds.begin(), speeds.end());
+        for (double speed : speeds) {
+            shares.push_back(speed / fastest);
+        }
+    }
+    std::vector<double> credits(shares.size(), 0.0);
+
+    size_t filled = 0;
+    while (true) {
+        for (size_t i = 0; i < servers; i++) {
+            if (!shares.empty()) {
+                credits[i] += shares[i];
+                if (credits[i] < 1.0) {
+                    continue;
+                }
+                credits[i] -= 1.0;
+            }
+            size_t slot = (offset[i] + next[i] * skip[i]) % tableSize;
+            while (table[slot] != UINT32_MAX) {
+                next[i]++;
+                slot = (offset[i] + next[i] * skip[i]) % tableSize;
+            }
+            table[slot] = (uint32_t)i;
+            next[i]++;
+            if (++filled == tableSize) {
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Ignores load updates; placement depends only on the source address.
+ * @param server Server index.
+ * @param requests Outstanding requests.
+ * @param work Outstanding work.
+ */
+void MaglevPolicy::update(size_t, size_t, size_t) {}
+
+/**
+ * @brief Records a server's speed; the table is refilled before the next pick.
+ * @param server Server index.
+ * @param speed Speed factor.
+ */
+void MaglevPolicy::setSpeed(size_t server, double speed) {
+    if (speeds.empty()) {
+        speeds.assign(servers, 1.0);
+    }
+    if (server < speeds.size()) {
+        speeds[server] = speed;
+        stale = true;
+    }
+}
+
+/**
+ * @brief Picks the server owning the request's source address.
+ * @param r Request to route.
+ * @return Server index.
+ */
+size_t MaglevPolicy::pick(const Request &r) {
+    if (stale) {
+        populate();
+    }
+    return table[keyHash(r) % tableSize];
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+/**
+ * @file affinity-policy.h
+ * @brief Header file for the routing policies that keep each client on one server.
+ */
+
+#ifndef AFFINITYPOLICY_H
+#define AFFINITYPOLICY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "routing-policy.h"
+
+/**
+ * @brief Mixes a 64-bit value into a well-distributed hash (the SplitMix64 finalizer).
+ * @param x Value to hash.
+ * @return Hash.
+ */
+uint64_t mixHash(uint64_t x);
+
+/**
+ * @class RingHashPolicy
+ * @brief Consistent hashing on a ring with virtual nodes, keyed on the source address.
+ *
+ * Each server owns virtualNodes points on a 32-bit ring, placed by hashing the
+ * server index and replica number, and a request goes to the owner of the first
+ * point at or after the hash of its source address. Adding or removing a server
+ * only moves the keys that fall next to its points. A bucket index over the
+ * ring makes the lookup O(1) expected instead of a binary search. With speeds
+ * set, a server gets virtualNodes points per unit of speed, so its share of
+ * the keys follows its capacity.
+ */
+class RingHashPolicy : public RoutingPolicy {
+private:
+    /**
+     * @struct Point
+     * @brief One virtual node.
+     */
+    struct Point {
+        uint32_t position;  ///< Place on the ring.
+        uint32_t server;    ///< Owning server.
+    };
+
+    size_t virtualNodes;            ///< Points per server of speed 1.
+    size_t servers;                 ///< Number of servers on the ring.
+    std::vector<double> speeds;     ///< Speed of each server; empty while all are 1.
+    bool stale;                     ///< Whether speeds changed since the ring was built.
+    std::vector<Point> ring;        ///< Points sorted by position.
+    std::vector<uint32_t> buckets;  ///< First point at or after the start of each bucket.
+    unsigned bucketShift;           ///< Shift from a ring position to its bucket.
+
+    /**
+     * @brief Places the points of every server on the ring and rebuilds the bucket index.
+     */
+    void build();
+
+    /**
+     * @brief Finds the owner of a position on the ring.
+     * @param position Hashed key.
+     * @return Server index.
+     */
+    size_t owner(uint32_t position) const;
+
+public:
+    /**
+     * @brief Constructs an empty ring.
+     * @param vnodes Points per server.
+     */
+    explicit RingHashPolicy(size_t vnodes);
+
+    const char *name() const override;
+    bool isAffine() const override;
+    void resize(size_t servers) override;
+    void update(size_t server, size_t requests, size_t work) override;
+    void setSpeed(size_t server, double speed) override;
+    size_t pick(const Request &r) override;
+};
+
+/**
+ * @class MaglevPolicy
+ * @brief Maglev hashing: a lookup table filled from per-server permutations.
+ *
+ * Every server has its own permutation of the table slots, and servers take
+ * turns claiming their next free preferred slot until the table is full, so
+ * each server owns almost exactly 1/n of the slots. A request is routed by
+ * indexing the table with the hash of its source address, which is O(1). The
+ * table size stays fixed while the fleet changes, so only slots whose owner
+ * changes move; it is chosen as a prime about 100 times the fleet size and is
+ * only enlarged (remapping everything) if the fleet outgrows a tenth of it.
+ * With speeds set, a server claims a slot on a turn only once it has earned
+ * a whole turn at its speed relative to the fastest server, so its share of
+ * the slots follows its capacity.
+ */
+class MaglevPolicy : public RoutingPolicy {
+private:
+    size_t servers;                 ///< Number of servers in the table.
+    size_t tableSize;               ///< Number of slots (a prime).
+    std::vector<double> speeds;     ///< Speed of each server; empty while all are 1.
+    bool stale;                     ///< Whether speeds changed since the table was filled.
+    std::vector<uint32_t> table;    ///< Owning server of each slot.
+
+    /**
+     * @brief Refills the table for the current servers.
+     */
+    void populate();
+
+public:
+    /**
+     * @brief Constructs an empty table.
+     */
+    MaglevPolicy();
+
+    const char *name() const override;
+    bool isAffine() const override;
+    void resize(size_t servers) override;
+    void update(size_t server, size_t requests, size_t work) override;
+    void setSpeed(size_t server, double speed) override;
+    size_t pick(const Request &r) override;
+};
+
+#endif
\ No newline at end of file
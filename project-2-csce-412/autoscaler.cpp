@@ -0,0 +1,87 @@
+/**
+ * @file autoscaler.cpp
+ * @brief Implementation of the Autoscaler class.
+ */
+
+#include "autoscaler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @brief Constructs an autoscaler.
+ * @param cfg Policy parameters. maxServers must already be resolved (non-zero).
+ */
+Autoscaler::Autoscaler(const AutoscalerConfig &cfg)
+    : config(cfg), lastChange(0), hasChanged(false) {}
+
+/**
+ * @brief Retrieves the policy parameters.
+ * @return Policy parameters.
+ */
+const AutoscalerConfig& Autoscaler::getConfig() const {
+    return config;
+}
+
+/**
+ * @brief Checks whether the fleet is evaluated on a tick.
+ * @param now Current simulation time.
+ * @return True if enabled and now is a multiple of the interval.
+ */
+bool Autoscaler::isEvaluationTick(size_t now) const {
+    return config.enabled && now % config.interval == 0;
+}
+
+/**
+ * @brief Retrieves the first evaluation tick after a given tick.
+ * @param now Current simulation time.
+ * @return Next evaluation tick, or SIZE_MAX if disabled.
+ */
+size_t Autoscaler::nextEvaluation(size_t now) const {
+    if (!config.enabled) {
+        return SIZE_MAX;
+    }
+    return (now / config.interval + 1) * config.interval;
+}
+
+/**
+ * @brief Decides the fleet size and records a scaling event if it changes.
+ * 
+ * The step is a fraction of the current fleet, rounded up, so small fleets still
+ * move by at least one server and large ones react in proportion.
+ * 
+ * @param now Current simulation time.
+ * @param serving Servers currently in service.
+ * @param queued Requests waiting.
+ * @param idle Servers in service with nothing to do.
+ * @return Servers that should be in service.
+ */
+size_t Autoscaler::evaluate(size_t now, size_t serving, size_t queued, size_t idle) {
+    if (!config.enabled || (hasChanged && now - lastChange < config.cooldown)) {
+        return serving;
+    }
+
+    double depth = serving == 0 ? (double)queued : (double)queued / (double)serving;
+    size_t step = std::max<size_t>(1, (size_t)std::ceil((double)serving * config.step));
+    size_t target = serving;
+    if (depth > config.highWater && serving < config.maxServers) {
+        target = std::min(config.maxServers, serving + step);
+    } else if (depth < config.lowWater && idle > 0 && serving > config.minServers) {
+        target = serving - std::min({step, idle, serving - config.minServers});
+    }
+
+    if (target != serving) {
+        events.push_back({now, serving, target, queued});
+        lastChange = now;
+        hasChanged = true;
+    }
+    return target;
+}
+
+/**
+ * @brief Retrieves every scaling event so far.
+ * @return Scaling events, oldest first.
+ */
+const std::vector<ScalingEvent>& Autoscaler::getEvents() const {
+    return events;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+/**
+ * @file autoscaler.h
+ * @brief Header file for the Autoscaler class that sizes the server fleet.
+ */
+
+#ifndef AUTOSCALER_H
+#define AUTOSCALER_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @struct AutoscalerConfig
+ * @brief Parameters of the autoscaling policy.
+ */
+struct AutoscalerConfig {
+    bool enabled = false;       ///< Whether the fleet is resized at all.
+    size_t minServers = 1;      ///< Smallest fleet.
+    size_t maxServers = 0;      ///< Largest fleet; 0 = ten times the initial fleet.
+    double highWater = 4.0;     ///< Queued requests per server above which servers are added.
+    double lowWater = 0.5;      ///< Queued requests per server below which idle servers retire.
+    double step = 0.25;         ///< Fraction of the fleet added or retired per scaling event.
+    size_t cooldown = 50;       ///< Minimum ticks between scaling events.
+    size_t interval = 10;       ///< Ticks between evaluations.
+};
+
+/**
+ * @struct ScalingEvent
+ * @brief One change of fleet size.
+ */
+struct ScalingEvent {
+    size_t time;    ///< Tick of the change.
+    size_t from;    ///< Servers in service before.
+    size_t to;      ///< Servers in service after.
+    size_t queued;  ///< Requests waiting when the change was made.
+};
+
+/**
+ * @class Autoscaler
+ * @brief Decides when to grow or shrink the fleet based on queue depth.
+ *
+ * Every interval ticks, the queue depth per server is compared against two
+ * water marks. Above the high mark the fleet grows by step; below the low mark,
+ * and only while some servers are idle, it shrinks by step but never by more
+ * than the idle servers. The gap between the marks gives hysteresis, and the
+ * cooldown keeps consecutive changes apart so the fleet does not oscillate.
+ */
+class Autoscaler {
+private:
+    AutoscalerConfig config;            ///< Policy parameters.
+    size_t lastChange;                  ///< Tick of the last scaling event.
+    bool hasChanged;                    ///< Whether any scaling event happened yet.
+    std::vector<ScalingEvent> events;   ///< Every scaling event so far.
+
+public:
+    /**
+     * @brief Constructs an autoscaler.
+     * @param cfg Policy parameters. maxServers must already be resolved (non-zero).
+     */
+    explicit Autoscaler(const AutoscalerConfig &cfg = AutoscalerConfig());
+
+    /**
+     * @brief Retrieves the policy parameters.
+     * @return Policy parameters.
+     */
+    const AutoscalerConfig& getConfig() const;
+
+    /**
+     * @brief Checks whether the fleet is evaluated on a tick.
+     * @param now Current simulation time.
+     * @return True if enabled and now is a multiple of the interval.
+     */
+    bool isEvaluationTick(size_t now) const;
+
+    /**
+     * @brief Retrieves the first evaluation tick after a given tick.
+     * @param now Current simulation time.
+     * @return Next evaluation tick, or SIZE_MAX if disabled.
+     */
+    size_t nextEvaluation(size_t now) const;
+
+    /**
+     * @brief Decides the fleet size and records a scaling event if it changes.
+     * @param now Current simulation time.
+     * @param serving Servers currently in service.
+     * @param queued Requests waiting.
+     * @param idle Servers in service with nothing to do.
+     * @return Servers that should be in service.
+     */
+    size_t evaluate(size_t now, size_t serving, size_t queued, size_t idle);
+
+    /**
+     * @brief Retrieves every scaling event so far.
+     * @return Scaling events, oldest first.
+     */
+    const std::vector<ScalingEvent>& getEvents() const;
+};
+
+#endif
\ No newline at end of file
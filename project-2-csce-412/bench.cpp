@@ -0,0 +1,686 @@
+/**
+ * @file bench.cpp
+ * @brief Microbenchmarks for the simulation core.
+ * 
+ * Benchmarks are written in the Google Benchmark style: each one receives a
+ * BenchState, does its setup, and times the body of a `for (auto _ : state)`
+ * loop. The harness picks the iteration count, counts heap allocations made
+ * while the timer runs, and reports ns per tick/request/call plus allocations
+ * per request, on the console and optionally as JSON.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <queue>
+#include <string>
+#include <vector>
+#include "load-balancer.h"
+
+namespace {
+
+std::atomic<size_t> allocationCount(0); ///< Heap allocations made by the process.
+
+} // namespace
+
+/**
+ * @brief Counts and forwards a heap allocation.
+ * @param size Bytes requested.
+ * @return Allocated memory.
+ */
+void *operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+/**
+ * @brief Counts and forwards an array allocation.
+ * @param size Bytes requested.
+ * @return Allocated memory.
+ */
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+/**
+ * @brief Releases memory from operator new.
+ * @param p Memory to release.
+ */
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+/**
+ * @brief Releases memory from operator new[].
+ * @param p Memory to release.
+ */
+void operator delete[](void *p) noexcept {
+    free(p);
+}
+
+/**
+ * @brief Sized variant of operator delete.
+ * @param p Memory to release.
+ */
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+/**
+ * @brief Sized variant of operator delete[].
+ * @param p Memory to release.
+ */
+void operator delete[](void *p, size_t) noexcept {
+    free(p);
+}
+
+/**
+ * @class BenchState
+ * @brief Controls and measures one benchmark run.
+ */
+class BenchState {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    size_t iterations;          ///< Iterations the timed loop runs for.
+    Clock::time_point started;  ///< When the timer was last resumed.
+    double elapsedNs;           ///< Time accumulated while the timer ran.
+    size_t allocStart;          ///< Allocation count when the timer was last resumed.
+    size_t allocs;              ///< Allocations accumulated while the timer ran.
+    bool timing;                ///< Whether the timer is running.
+
+public:
+    std::vector<size_t> args;   ///< Benchmark parameters.
+    size_t itemsPerIteration;   ///< Units of work (ticks, calls...) per loop iteration.
+    const char *itemName;       ///< Name of a unit of work.
+    size_t requests;            ///< Requests handled while timed, for the per-request columns.
+
+    /**
+     * @class Iterator
+     * @brief Range-for iterator that stops the timer when the loop ends.
+     */
+    class Iterator {
+    private:
+        BenchState *state;  ///< State being iterated.
+        size_t left;        ///< Iterations still to run.
+
+    public:
+        /**
+         * @brief Constructs an iterator.
+         * @param s State being iterated.
+         * @param n Iterations still to run.
+         */
+        Iterator(BenchState *s, size_t n) : state(s), left(n) {}
+
+        /**
+         * @brief Checks whether the loop continues, stopping the timer when it does not.
+         * @return True while iterations remain.
+         */
+        bool operator!=(const Iterator &) {
+            if (left == 0) {
+                state->pauseTiming();
+                return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Advances to the next iteration.
+         */
+        void operator++() {
+            left--;
+        }
+
+        /**
+         * @brief Dereferences to a dummy value.
+         * @return Zero.
+         */
+        int operator*() const {
+            return 0;
+        }
+    };
+
+    /**
+     * @brief Constructs a state for a given iteration count and parameters.
+     * @param n Iterations to run.
+     * @param parameters Benchmark parameters.
+     */
+    BenchState(size_t n, const std::vector<size_t> &parameters)
+        : iterations(n), elapsedNs(0), allocStart(0), allocs(0), timing(false),
+          args(parameters), itemsPerIteration(1), itemName("iter"), requests(0) {}
+
+    /**
+     * @brief Starts the timer and returns the start of the timed loop.
+     * @return Begin iterator.
+     */
+    Iterator begin() {
+        resumeTiming();
+        return Iterator(this, iterations);
+    }
+
+    /**
+     * @brief Returns the end of the timed loop.
+     * @return End iterator.
+     */
+    Iterator end() {
+        return Iterator(this, 0);
+    }
+
+    /**
+     * @brief Stops the timer, e.g. around per-iteration setup.
+     */
+    void pauseTiming() {
+        if (timing) {
+            elapsedNs += std::chrono::duration<double, std::nano>(Clock::now() - started).count();
+            allocs += allocationCount.load(std::memory_order_relaxed) - allocStart;
+            timing = false;
+        }
+    }
+
+    /**
+     * @brief Restarts the timer.
+     */
+    void resumeTiming() {
+        if (!timing) {
+            allocStart = allocationCount.load(std::memory_order_relaxed);
+            started = Clock::now();
+            timing = true;
+        }
+    }
+
+    /**
+     * @brief Retrieves the iteration count.
+     * @return Iterations the timed loop runs for.
+     */
+    size_t getIterations() const {
+        return iterations;
+    }
+
+    /**
+     * @brief Retrieves the time spent in the timed loop.
+     * @return Elapsed nanoseconds.
+     */
+    double getElapsedNs() const {
+        return elapsedNs;
+    }
+
+    /**
+     * @brief Retrieves the allocations made in the timed loop.
+     * @return Allocation count.
+     */
+    size_t getAllocations() const {
+        return allocs;
+    }
+};
+
+namespace {
+
+/**
+ * @struct Benchmark
+ * @brief A registered benchmark with one set of parameters.
+ */
+struct Benchmark {
+    std::string name;                       ///< Display name, including parameters.
+    std::function<void(BenchState &)> body; ///< Benchmark function.
+    std::vector<size_t> args;               ///< Parameters passed in BenchState::args.
+};
+
+/**
+ * @struct BenchResult
+ * @brief Measurements from one benchmark.
+ */
+struct BenchResult {
+    std::string name;           ///< Benchmark name.
+    size_t iterations;          ///< Iterations timed.
+    std::string itemName;       ///< Unit of work.
+    double nsPerItem;           ///< Nanoseconds per unit of work.
+    double nsPerRequest;        ///< Nanoseconds per request, or -1 if not applicable.
+    double allocsPerRequest;    ///< Allocations per request, or -1 if not applicable.
+    size_t allocations;         ///< Allocations made while timed.
+};
+
+/**
+ * @brief Builds an idle pool whose servers all stay busy for a long time.
+ * @param pool Pool to fill.
+ */
+void makeAllBusy(ServerPool &pool) {
+    Request longRequest(0x0a000001, 0x0a000002, UINT16_MAX, JobType::Standard);
+    for (size_t i = 0; i < pool.size(); i++) {
+        pool.setRequest(i, longRequest);
+    }
+}
+
+/**
+ * @brief Times ServerPool::tick() with a given kernel. args: {kernel index, servers}.
+ * @param state Benchmark state.
+ */
+void benchPoolTick(BenchState &state) {
+    static const char *KERNELS[] = {"scalar", "sse4.2", "avx2"};
+    TickKernel kernel;
+    selectTickKernel(KERNELS[state.args[0]], kernel);
+    ServerPool pool(state.args[1]);
+    pool.setTickKernel(kernel);
+    makeAllBusy(pool);
+    size_t done = 0;
+    state.itemName = "tick";
+    for ([[maybe_unused]] auto _ : state) {
+        // Refill well before the counters would run out
+        if (++done == UINT16_MAX - 1) {
+            state.pauseTiming();
+            makeAllBusy(pool);
+            done = 0;
+            state.resumeTiming();
+        }
+        pool.tick();
+    }
+}
+
+/**
+ * @brief Times the per-server Server::handleRequest() sweep. args: {servers}.
+ * @param state Benchmark state.
+ */
+void benchHandleRequest(BenchState &state) {
+    ServerPool pool(state.args[0]);
+    makeAllBusy(pool);
+    size_t done = 0;
+    state.itemName = "tick";
+    for ([[maybe_unused]] auto _ : state) {
+        if (++done == UINT16_MAX - 1) {
+            state.pauseTiming();
+            makeAllBusy(pool);
+            done = 0;
+            state.resumeTiming();
+        }
+        for (size_t i = 0; i < pool.size(); i++) {
+            Server(pool, i).handleRequest();
+        }
+    }
+}
+
+/**
+ * @brief Times pushing and popping a batch of requests through RequestQueue. args: {batch}.
+ * @param state Benchmark state.
+ */
+void benchRequestQueue(BenchState &state) {
+    size_t batch = state.args[0];
+    Request r(0x0a000001, 0x0a000002, 5, JobType::Priority);
+    RequestQueue queue;
+    uint64_t sink = 0;
+    state.itemName = "request";
+    state.itemsPerIteration = batch;
+    for ([[maybe_unused]] auto _ : state) {
+        for (size_t i = 0; i < batch; i++) {
+            queue.push(r);
+        }
+        while (!queue.empty()) {
+            sink += queue.front().getDuration();
+            queue.pop();
+        }
+        state.requests += batch;
+    }
+    if (sink == 1) {
+        std::puts("");
+    }
+}
+
+/**
+ * @brief Same as benchRequestQueue() but with std::queue, for comparison. args: {batch}.
+ * @param state Benchmark state.
+ */
+void benchStdQueue(BenchState &state) {
+    size_t batch = state.args[0];
+    Request r(0x0a000001, 0x0a000002, 5, JobType::Priority);
+    std::queue<Request> queue;
+    uint64_t sink = 0;
+    state.itemName = "request";
+    state.itemsPerIteration = batch;
+    for ([[maybe_unused]] auto _ : state) {
+        for (size_t i = 0; i < batch; i++) {
+            queue.push(r);
+        }
+        while (!queue.empty()) {
+            sink += queue.front().getDuration();
+            queue.pop();
+        }
+        state.requests += batch;
+    }
+    if (sink == 1) {
+        std::puts("");
+    }
+}
+
+/**
+ * @brief Times completion timers in a TimingWheel: each tick, the timers that fire
+ *        are re-armed 3 to 16 ticks ahead. args: {timers}.
+ * @param state Benchmark state.
+ */
+void benchTimingWheel(BenchState &state) {
+    size_t timers = state.args[0];
+    TimingWheel wheel;
+    std::vector<size_t> due;
+    uint64_t draw = 1;
+    for (size_t i = 0; i < timers; i++) {
+        wheel.insert(1 + i % 16, i);
+    }
+    size_t now = 0;
+    state.itemName = "tick";
+    for ([[maybe_unused]] auto _ : state) {
+        now = wheel.nextTime();
+        due.clear();
+        wheel.advance(now, due);
+        for (size_t id : due) {
+            draw = draw * 6364136223846793005ull + 1442695040888963407ull;
+            wheel.insert(now + 3 + (draw >> 60) % 14, id);
+        }
+        state.requests += due.size();
+    }
+}
+
+/**
+ * @brief Same as benchTimingWheel() but with a binary heap, for comparison. args: {timers}.
+ * @param state Benchmark state.
+ */
+void benchCompletionHeap(BenchState &state) {
+    typedef std::pair<size_t, size_t> Timer;
+    size_t timers = state.args[0];
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> heap;
+    uint64_t draw = 1;
+    for (size_t i = 0; i < timers; i++) {
+        heap.push({1 + i % 16, i});
+    }
+    state.itemName = "tick";
+    for ([[maybe_unused]] auto _ : state) {
+        size_t now = heap.top().first;
+        size_t fired = 0;
+        while (!heap.empty() && heap.top().first == now) {
+            size_t id = heap.top().second;
+            heap.pop();
+            draw = draw * 6364136223846793005ull + 1442695040888963407ull;
+            heap.push({now + 3 + (draw >> 60) % 14, id});
+            fired++;
+        }
+        state.requests += fired;
+    }
+}
+
+/**
+ * @brief Times longest-prefix-match lookups of random addresses. args: {prefixes}.
+ * @param state Benchmark state.
+ */
+void benchPrefixTrie(BenchState &state) {
+    size_t count = state.args[0];
+    uint64_t draw = 1;
+    std::vector<PrefixTrie::Prefix> prefixes;
+    for (size_t i = 0; i < count; i++) {
+        draw = draw * 6364136223846793005ull + 1442695040888963407ull;
+        prefixes.push_back({(uint32_t)(draw >> 32), (uint8_t)(8 + (draw >> 8) % 25), (uint32_t)i});
+    }
+    PrefixTrie trie;
+    trie.build(prefixes);
+    uint32_t address = 1;
+    state.itemName = "lookup";
+    for ([[maybe_unused]] auto _ : state) {
+        address = address * 1664525u + 1013904223u;
+        state.requests += trie.lookup(address) != PrefixTrie::NONE;
+    }
+}
+
+/**
+ * @brief Times rate limiting of batches from uniformly random sources. args: {table size}.
+ * @param state Benchmark state.
+ */
+void benchRateLimiter(BenchState &state) {
+    RateLimitConfig config;
+    config.enabled = true;
+    config.tableSize = state.args[0];
+    RateLimiter limiter(config);
+    Workload workload(RandomStreams::fromSeed(1));
+    Request batch[Workload::BATCH];
+    size_t now = 0;
+    state.itemName = "request";
+    state.itemsPerIteration = Workload::BATCH;
+    for ([[maybe_unused]] auto _ : state) {
+        state.pauseTiming();
+        workload.generate(batch, Workload::BATCH);
+        state.resumeTiming();
+        state.requests += limiter.filter(batch, Workload::BATCH, now++);
+    }
+}
+
+/**
+ * @brief Times request generation (addresses, durations, job types). args: {batch}.
+ * @param state Benchmark state.
+ */
+void benchGenerate(BenchState &state) {
+    size_t batch = state.args[0];
+    Workload workload(RandomStreams::fromSeed(1));
+    Request out[Workload::BATCH];
+    state.itemName = "request";
+    state.itemsPerIteration = batch;
+    for ([[maybe_unused]] auto _ : state) {
+        workload.generate(out, batch);
+        state.requests += batch;
+    }
+}
+
+/**
+ * @brief Times a full LoadBalancer::run() with logging off.
+ *        args: {event mode, servers, ticks, threads}.
+ * @param state Benchmark state.
+ */
+void benchRun(BenchState &state) {
+    SimulationMode mode = state.args[0] ? SimulationMode::Event : SimulationMode::Tick;
+    size_t servers = state.args[1];
+    size_t ticks = state.args[2];
+    size_t threads = state.args[3];
+    state.itemName = "tick";
+    state.itemsPerIteration = ticks;
+    for ([[maybe_unused]] auto _ : state) {
+        state.pauseTiming();
+        {
+            LoadBalancer lb(servers, ticks, 1, mode);
+            lb.setLogSink(makeLogSink(LogLevel::Off, LogFormat::Text, ""));
+            lb.setThreads(threads);
+            state.resumeTiming();
+
+            lb.run();
+
+            state.pauseTiming();
+            state.requests += lb.getCompletedRequests();
+        }
+        // Destroy the balancer and its initial queue outside the timer
+        state.resumeTiming();
+    }
+}
+
+/**
+ * @brief Builds the list of benchmarks and their parameters.
+ * @return Registered benchmarks.
+ */
+std::vector<Benchmark> registerBenchmarks() {
+    std::vector<Benchmark> list;
+    const size_t SERVER_COUNTS[] = {10, 1000, 100000, 1000000};
+    const char *KERNELS[] = {"scalar", "sse4.2", "avx2"};
+
+    for (size_t k = 0; k < 3; k++) {
+        // Skip kernels this CPU cannot run rather than report empty timings
+        TickKernel kernel;
+        if (!selectTickKernel(KERNELS[k], kernel)) {
+            continue;
+        }
+        for (size_t servers : SERVER_COUNTS) {
+            list.push_back({std::string("ServerPool::tick/") + KERNELS[k] + "/" +
+                                std::to_string(servers),
+                            benchPoolTick, {k, servers}});
+        }
+    }
+    for (size_t servers : SERVER_COUNTS) {
+        list.push_back({"Server::handleRequest/" + std::to_string(servers), benchHandleRequest,
+                        {servers}});
+    }
+    for (size_t batch : {16, 1024, 65536}) {
+        list.push_back({"RequestQueue/push-pop/" + std::to_string(batch), benchRequestQueue,
+                        {batch}});
+        list.push_back({"std::queue/push-pop/" + std::to_string(batch), benchStdQueue, {batch}});
+    }
+    for (size_t timers : {1000, 100000, 1000000}) {
+        list.push_back({"TimingWheel/churn/" + std::to_string(timers), benchTimingWheel,
+                        {timers}});
+        list.push_back({"std::priority_queue/churn/" + std::to_string(timers),
+                        benchCompletionHeap, {timers}});
+    }
+    for (size_t prefixes : {100, 10000, 500000}) {
+        list.push_back({"PrefixTrie::lookup/" + std::to_string(prefixes), benchPrefixTrie,
+                        {prefixes}});
+    }
+    for (size_t table : {1024, 65536, 1048576}) {
+        list.push_back({"RateLimiter::filter/" + std::to_string(table), benchRateLimiter,
+                        {table}});
+    }
+    for (size_t batch : {1, 3, 256}) {
+        list.push_back({"Workload::generate/" + std::to_string(batch), benchGenerate, {batch}});
+    }
+    const size_t RUNS[][2] = {{10, 100000}, {1000, 10000}, {100000, 1000}, {1000000, 100}};
+    for (size_t mode = 0; mode < 2; mode++) {
+        for (const auto &run : RUNS) {
+            list.push_back({std::string("LoadBalancer::run/") + (mode ? "event" : "tick") + "/" +
+                                std::to_string(run[0]) + "/" + std::to_string(run[1]),
+                            benchRun, {mode, run[0], run[1], 1}});
+        }
+    }
+    for (size_t threads : {2, 4, 8, 16, 32}) {
+        list.push_back({"LoadBalancer::run/tick/1000000/100/threads:" + std::to_string(threads),
+                        benchRun, {0, 1000000, 100, threads}});
+    }
+    return list;
+}
+
+/**
+ * @brief Runs a benchmark, growing the iteration count until it takes minTime.
+ * @param bench Benchmark to run.
+ * @param minTime Minimum timed duration in seconds.
+ * @return Measurements.
+ */
+BenchResult runBenchmark(const Benchmark &bench, double minTime) {
+    size_t iterations = 1;
+    while (true) {
+        BenchState state(iterations, bench.args);
+        bench.body(state);
+        double seconds = state.getElapsedNs() / 1e9;
+        if (seconds >= minTime || iterations >= ((size_t)1 << 40)) {
+            BenchResult result;
+            result.name = bench.name;
+            result.iterations = iterations;
+            result.itemName = state.itemName;
+            result.nsPerItem = state.getElapsedNs() / ((double)iterations * state.itemsPerIteration);
+            result.nsPerRequest = state.requests ? state.getElapsedNs() / state.requests : -1;
+            result.allocsPerRequest =
+                state.requests ? (double)state.getAllocations() / state.requests : -1;
+            result.allocations = state.getAllocations();
+            return result;
+        }
+        // Aim for minTime with some headroom, growing at most 10x per attempt
+        double scale = seconds > 0 ? 1.4 * minTime / seconds : 10.0;
+        scale = scale > 10.0 ? 10.0 : scale < 2.0 ? 2.0 : scale;
+        iterations = (size_t)(iterations * scale);
+    }
+}
+
+/**
+ * @brief Writes results as a JSON document.
+ * @param path Output path.
+ * @param results Measurements to write.
+ * @return True if the file was written.
+ */
+bool writeJson(const std::string &path, const std::vector<BenchResult> &results) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    TickKernel kernel;
+    selectTickKernel("auto", kernel);
+    out << "{\n  \"context\": {\"date\": " << (long long)time(nullptr)
+        << ", \"tick_kernel\": \"" << tickKernelName(kernel) << "\"},\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+            << ", \"unit\": \"" << r.itemName << "\", \"ns_per_" << r.itemName << "\": "
+            << r.nsPerItem << ", \"allocations\": " << r.allocations;
+        if (r.nsPerRequest >= 0) {
+            out << ", \"ns_per_request\": " << r.nsPerRequest
+                << ", \"allocs_per_request\": " << r.allocsPerRequest;
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return (bool)out;
+}
+
+} // namespace
+
+/**
+ * @brief Runs the benchmarks.
+ * 
+ * Options:
+ *   --filter=TEXT    only run benchmarks whose name contains TEXT
+ *   --min-time=SEC   minimum timed duration per benchmark (default: 0.2)
+ *   --json=PATH      also write the results as JSON to PATH
+ * 
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments.
+ * @return Exit status.
+ */
+int main(int argc, char *argv[]) {
+    std::string filter;
+    std::string jsonPath;
+    double minTime = 0.2;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--filter=", 0) == 0) {
+            filter = arg.substr(9);
+        } else if (arg.rfind("--min-time=", 0) == 0) {
+            minTime = std::stod(arg.substr(11));
+        } else if (arg.rfind("--json=", 0) == 0) {
+            jsonPath = arg.substr(7);
+        } else {
+            std::cerr << "Usage: lb-bench [--filter=TEXT] [--min-time=SEC] [--json=PATH]\n";
+            return 1;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    printf("%-44s %12s %20s %14s %14s\n", "Benchmark", "Iterations", "Time", "ns/request",
+           "allocs/request");
+    for (const Benchmark &bench : registerBenchmarks()) {
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        BenchResult r = runBenchmark(bench, minTime);
+        results.push_back(r);
+
+        char perItem[32];
+        snprintf(perItem, sizeof(perItem), "%.2f ns/%s", r.nsPerItem, r.itemName.c_str());
+        printf("%-44s %12zu %20s", r.name.c_str(), r.iterations, perItem);
+        if (r.nsPerRequest >= 0) {
+            printf(" %14.2f %14.4f\n", r.nsPerRequest, r.allocsPerRequest);
+        } else {
+            printf(" %14s %14s\n", "-", "-");
+        }
+        fflush(stdout);
+    }
+
+    if (!jsonPath.empty() && !writeJson(jsonPath, results)) {
+        std::cerr << "Cannot write " << jsonPath << "\n";
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
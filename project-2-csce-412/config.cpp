@@ -0,0 +1,555 @@
+/**
+ * @file config.cpp
+ * @brief Implementation of the command-line and config-file parsers.
+ */
+
+#include "config.h"
+#include <charconv>
+#include <fstream>
+
+namespace {
+
+/**
+ * @brief Removes leading and trailing whitespace.
+ * @param s String to trim.
+ * @return Trimmed string.
+ */
+std::string trim(const std::string &s) {
+    size_t start = s.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) {
+        return "";
+    }
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(start, end - start + 1);
+}
+
+/**
+ * @brief Parses a whole string as an unsigned integer.
+ * @param value Text to parse.
+ * @param out Parsed number on success.
+ * @return True if the text is a valid number.
+ */
+bool parseUnsigned(const std::string &value, uint64_t &out) {
+    if (value.empty() || value[0] == '-') {
+        return false;
+    }
+    try {
+        size_t used;
+        out = std::stoull(value, &used);
+        return used == value.size();
+    } catch (...) {
+        return false;
+    }
+}
+
+/**
+ * @brief Parses a whole string as a floating-point number.
+ * @param value Text to parse.
+ * @param out Parsed number on success.
+ * @return True if the text is a valid number.
+ */
+bool parseDouble(const std::string &value, double &out) {
+    try {
+        size_t used;
+        out = std::stod(value, &used);
+        return used == value.size();
+    } catch (...) {
+        return false;
+    }
+}
+
+/**
+ * @brief Formats a number in the shortest form that parses back to the same value.
+ * @param value Number to format.
+ * @return Formatted number.
+ */
+std::string formatDouble(double value) {
+    char text[32];
+    return std::string(text, std::to_chars(text, text + sizeof(text), value).ptr);
+}
+
+} // namespace
+
+/**
+ * @brief Applies a single key=value option to a configuration.
+ * @param config Configuration to update.
+ * @param key Option name, without leading dashes.
+ * @param value Option value.
+ * @param error Description of the problem on failure.
+ * @return True if the option was valid.
+ */
+bool applyOption(SimulationConfig &config, const std::string &key, const std::string &value,
+                 std::string &error) {
+    uint64_t number = 0;
+    double real = 0.0;
+    bool ok = true;
+
+    if (key == "servers") {
+        ok = parseUnsigned(value, number);
+        config.servers = number;
+        config.hasServers = ok;
+    } else if (key == "time") {
+        ok = parseUnsigned(value, number);
+        config.runTime = number;
+        config.hasRunTime = ok;
+    } else if (key == "seed") {
+        ok = parseUnsigned(value, config.seed);
+        config.hasSeed = ok;
+    } else if (key == "fleet") {
+        ok = parseFleet(value, config.fleet);
+        if (ok) {
+            config.servers = fleetSlots(config.fleet);
+            config.hasServers = true;
+        }
+    } else if (key == "mode") {
+        if (value == "tick") {
+            config.mode = SimulationMode::Tick;
+        } else if (value == "event") {
+            config.mode = SimulationMode::Event;
+        } else {
+            ok = false;
+        }
+    } else if (key == "kernel") {
+        config.kernel = value;
+    } else if (key == "threads") {
+        ok = parseUnsigned(value, number);
+        config.threads = number;
+    } else if (key == "arrivals") {
+        ok = parseArrivalKind(value, config.arrivals.kind);
+    } else if (key == "arrival-probability") {
+        ok = parseDouble(value, config.arrivals.probability);
+    } else if (key == "max-burst") {
+        ok = parseUnsigned(value, number);
+        config.arrivals.maxBurst = number;
+    } else if (key == "arrival-rate") {
+        ok = parseDouble(value, config.arrivals.rate);
+    } else if (key == "durations") {
+        ok = parseDurationKind(value, config.durations.kind);
+    } else if (key == "duration-min") {
+        ok = parseUnsigned(value, number);
+        config.durations.min = number;
+    } else if (key == "duration-max") {
+        ok = parseUnsigned(value, number);
+        config.durations.max = number;
+    } else if (key == "duration-mean") {
+        ok = parseDouble(value, real);
+        config.durations.mean = real;
+    } else if (key == "scheduler") {
+        ok = parseSchedulingPolicy(value, config.scheduling.policy);
+    } else if (key == "priority-weight") {
+        ok = parseDouble(value, config.scheduling.priorityWeight);
+    } else if (key == "standard-weight") {
+        ok = parseDouble(value, config.scheduling.standardWeight);
+    } else if (key == "aging") {
+        ok = parseUnsigned(value, number);
+        config.scheduling.agingLimit = number;
+    } else if (key == "routing") {
+        ok = parseRoutingKind(value, config.routing.kind);
+    } else if (key == "virtual-nodes") {
+        ok = parseUnsigned(value, number) && number > 0;
+        config.routing.virtualNodes = number;
+    } else if (key == "autoscale") {
+        if (value == "on") {
+            config.autoscaling.enabled = true;
+        } else if (value == "off") {
+            config.autoscaling.enabled = false;
+        } else {
+            ok = false;
+        }
+    } else if (key == "min-servers") {
+        ok = parseUnsigned(value, number);
+        config.autoscaling.minServers = number;
+    } else if (key == "max-servers") {
+        ok = parseUnsigned(value, number);
+        config.autoscaling.maxServers = number;
+    } else if (key == "high-water") {
+        ok = parseDouble(value, config.autoscaling.highWater);
+    } else if (key == "low-water") {
+        ok = parseDouble(value, config.autoscaling.lowWater);
+    } else if (key == "scale-step") {
+        ok = parseDouble(value, config.autoscaling.step);
+    } else if (key == "cooldown") {
+        ok = parseUnsigned(value, number);
+        config.autoscaling.cooldown = number;
+    } else if (key == "scale-interval") {
+        ok = parseUnsigned(value, number);
+        config.autoscaling.interval = number;
+    } else if (key == "rate-limit") {
+        ok = parseDouble(value, config.rateLimit.rate);
+        config.rateLimit.enabled = true;
+    } else if (key == "rate-burst") {
+        ok = parseDouble(value, config.rateLimit.burst);
+    } else if (key == "rate-table") {
+        ok = parseUnsigned(value, number);
+        config.rateLimit.tableSize = number;
+    } else if (key == "latency-budget") {
+        ok = parseDouble(value, config.admission.budget);
+    } else if (key == "admission") {
+        if (value == "on") {
+            config.admission.shed = true;
+        } else if (value == "off") {
+            config.admission.shed = false;
+        } else {
+            ok = false;
+        }
+    } else if (key == "shed-standard-at") {
+        ok = parseDouble(value, config.admission.standardShare);
+    } else if (key == "mtbf") {
+        ok = parseDouble(value, config.failures.mtbf);
+    } else if (key == "mttr") {
+        ok = parseDouble(value, config.failures.mttr);
+    } else if (key == "rack-size") {
+        ok = parseUnsigned(value, number);
+        config.failures.rackSize = number;
+    } else if (key == "rack-mtbf") {
+        ok = parseDouble(value, config.failures.rackMtbf);
+    } else if (key == "degrade-mtbf") {
+        ok = parseDouble(value, config.failures.degradeMtbf);
+    } else if (key == "degrade-speed") {
+        ok = parseDouble(value, config.failures.degradeSpeed);
+    } else if (key == "on-failure") {
+        if (value == "requeue") {
+            config.failures.inFlight = FailurePolicy::Requeue;
+        } else if (value == "lose") {
+            config.failures.inFlight = FailurePolicy::Lose;
+        } else {
+            ok = false;
+        }
+    } else if (key == "probe-interval") {
+        ok = parseUnsigned(value, number);
+        config.health.interval = number;
+    } else if (key == "probe-timeout") {
+        ok = parseUnsigned(value, number);
+        config.health.timeout = number;
+    } else if (key == "unhealthy-after") {
+        ok = parseUnsigned(value, number);
+        config.health.unhealthyThreshold = number;
+    } else if (key == "healthy-after") {
+        ok = parseUnsigned(value, number);
+        config.health.healthyThreshold = number;
+    } else if (key == "replications") {
+        ok = parseUnsigned(value, number);
+        config.replication.replications = number;
+    } else if (key == "jobs") {
+        ok = parseUnsigned(value, number);
+        config.replication.jobs = number;
+    } else if (key == "ci-target") {
+        ok = parseDouble(value, config.replication.ciTarget);
+    } else if (key == "trace") {
+        config.traceFile = value;
+    } else if (key == "record") {
+        config.recordFile = value;
+    } else if (key == "blocklist") {
+        config.blocklistFile = value;
+    } else if (key == "allowlist") {
+        config.allowlistFile = value;
+    } else if (key == "log") {
+        ok = parseLogLevel(value, config.logLevel);
+    } else if (key == "log-format") {
+        if (value == "text") {
+            config.logFormat = LogFormat::Text;
+        } else if (value == "binary") {
+            config.logFormat = LogFormat::Binary;
+        } else {
+            ok = false;
+        }
+    } else if (key == "log-file") {
+        config.logFile = value;
+    } else if (key == "results") {
+        config.resultsFile = value;
+    } else if (key == "config") {
+        return loadConfigFile(value, config, error);
+    } else {
+        error = "unknown option '" + key + "'";
+        return false;
+    }
+
+    if (!ok) {
+        error = "invalid value '" + value + "' for option '" + key + "'";
+    }
+    return ok;
+}
+
+/**
+ * @brief Loads key=value lines from a config file. Blank lines and # comments are ignored.
+ * @param path Config file path.
+ * @param config Configuration to update.
+ * @param error Description of the problem on failure.
+ * @return True if the file was read and every option was valid.
+ */
+bool loadConfigFile(const std::string &path, SimulationConfig &config, std::string &error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open config file '" + path + "'";
+        return false;
+    }
+
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            error = path + ":" + std::to_string(lineNumber) + ": expected key = value";
+            return false;
+        }
+        if (!applyOption(config, trim(line.substr(0, eq)), trim(line.substr(eq + 1)), error)) {
+            error = path + ":" + std::to_string(lineNumber) + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Parses command-line arguments. --config=PATH loads a file at that point.
+ * 
+ * Options are applied in order, so later ones override earlier ones and options
+ * after --config override the file. --event-driven is shorthand for --mode=event.
+ * 
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments.
+ * @param config Configuration to update.
+ * @param error Description of the problem on failure.
+ * @return True if every argument was valid.
+ */
+bool parseArguments(int argc, char *argv[], SimulationConfig &config, std::string &error) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            config.showHelp = true;
+            continue;
+        }
+        if (arg == "--event-driven") {
+            config.mode = SimulationMode::Event;
+            continue;
+        }
+        if (arg.rfind("--", 0) != 0) {
+            error = "unexpected argument '" + arg + "'";
+            return false;
+        }
+
+        std::string key = arg.substr(2);
+        std::string value;
+        size_t eq = key.find('=');
+        if (eq != std::string::npos) {
+            value = key.substr(eq + 1);
+            key = key.substr(0, eq);
+        } else if (i + 1 < argc) {
+            value = argv[++i];
+        } else {
+            error = "missing value for option '" + key + "'";
+            return false;
+        }
+
+        if (!applyOption(config, key, value, error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Checks that the options make sense together.
+ * @param config Configuration to check.
+ * @param error Description of the problem on failure.
+ * @return True if the configuration is usable.
+ */
+bool validateConfig(const SimulationConfig &config, std::string &error) {
+    if (config.threads == 0) {
+        error = "threads must be at least 1";
+    } else if (config.runTime > UINT32_MAX) {
+        error = "time must be below 2^32";
+    } else if (config.arrivals.probability < 0.0 || config.arrivals.probability > 1.0) {
+        error = "arrival-probability must be between 0 and 1";
+    } else if (config.arrivals.maxBurst == 0 || config.arrivals.maxBurst > UINT32_MAX) {
+        error = "max-burst must be at least 1";
+    } else if (config.arrivals.rate < 0.0) {
+        error = "arrival-rate must not be negative";
+    } else if (config.durations.min == 0 || config.durations.min > config.durations.max ||
+               config.durations.max > UINT16_MAX) {
+        error = "duration-min and duration-max must satisfy 1 <= min <= max <= 65535";
+    } else if (config.durations.mean <= 0.0) {
+        error = "duration-mean must be positive";
+    } else if (config.scheduling.priorityWeight <= 0.0 || config.scheduling.standardWeight <= 0.0) {
+        error = "priority-weight and standard-weight must be positive";
+    } else if (config.routing.kind != RoutingKind::Central &&
+               (config.scheduling.policy != SchedulingPolicy::Fifo ||
+                config.scheduling.agingLimit > 0)) {
+        error = "scheduler and aging need the central queue; per-server queues are fifo";
+    } else if (config.autoscaling.lowWater < 0.0 ||
+               config.autoscaling.lowWater >= config.autoscaling.highWater) {
+        error = "low-water must be at least 0 and below high-water";
+    } else if (config.autoscaling.step <= 0.0 || config.autoscaling.interval == 0) {
+        error = "scale-step and scale-interval must be positive";
+    } else if (config.autoscaling.minServers == 0 ||
+               (config.autoscaling.maxServers != 0 &&
+                config.autoscaling.maxServers < config.autoscaling.minServers)) {
+        error = "min-servers must be at least 1 and no more than max-servers";
+    } else if (config.rateLimit.rate <= 0.0 || config.rateLimit.burst < 1.0) {
+        error = "rate-limit must be positive and rate-burst at least 1";
+    } else if (config.rateLimit.tableSize == 0 || config.rateLimit.tableSize > ((size_t)1 << 30)) {
+        error = "rate-table must be between 1 and 2^30";
+    } else if (!(config.admission.budget >= 0.0 && config.admission.budget < 4294967296.0)) {
+        error = "latency-budget must be at least 0 and below 2^32";
+    } else if (config.admission.standardShare <= 0.0 || config.admission.standardShare > 1.0) {
+        error = "shed-standard-at must be above 0 and at most 1";
+    } else if (!config.fleet.empty() && config.servers != fleetSlots(config.fleet)) {
+        error = "servers must equal the slots of the fleet";
+    } else if (!config.fleet.empty() && config.autoscaling.enabled) {
+        error = "fleet cannot be combined with autoscale";
+    } else if (config.failures.mtbf < 0.0 || config.failures.rackMtbf < 0.0 ||
+               config.failures.degradeMtbf < 0.0) {
+        error = "mtbf, rack-mtbf and degrade-mtbf must not be negative";
+    } else if (config.failures.mttr <= 0.0) {
+        error = "mttr must be positive";
+    } else if (config.failures.rackMtbf > 0.0 && config.failures.rackSize == 0) {
+        error = "rack-mtbf needs rack-size";
+    } else if (config.failures.degradeSpeed <= 0.0 || config.failures.degradeSpeed > 1.0) {
+        error = "degrade-speed must be above 0 and at most 1";
+    } else if (config.health.interval == 0 || config.health.unhealthyThreshold == 0 ||
+               config.health.healthyThreshold == 0) {
+        error = "probe-interval, unhealthy-after and healthy-after must be at least 1";
+    } else if (config.failures.enabled() && config.autoscaling.enabled) {
+        error = "failures cannot be combined with autoscale";
+    } else if (config.replication.replications == 0) {
+        error = "replications must be at least 1";
+    } else if (config.replication.ciTarget < 0.0) {
+        error = "ci-target must not be negative";
+    } else if (!config.recordFile.empty() && config.replication.replications > 1) {
+        error = "record needs a single run, not replications";
+    } else {
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Writes the options that decide a run's traffic as config-file lines.
+ * @param config Configuration to describe.
+ * @return Lines that loadConfigFile() reads back.
+ */
+std::string formatConfig(const SimulationConfig &config) {
+    std::string text;
+    text += "servers = " + std::to_string(config.servers) + "\n";
+    text += "time = " + std::to_string(config.runTime) + "\n";
+    text += "seed = " + std::to_string(config.seed) + "\n";
+    if (!config.traceFile.empty()) {
+        return text + "trace = " + config.traceFile + "\n";
+    }
+    text += std::string("arrivals = ") +
+            (config.arrivals.kind == ArrivalKind::Poisson ? "poisson" : "bursty") + "\n";
+    text += "arrival-probability = " + formatDouble(config.arrivals.probability) + "\n";
+    text += "max-burst = " + std::to_string(config.arrivals.maxBurst) + "\n";
+    text += "arrival-rate = " + formatDouble(config.arrivals.rate) + "\n";
+    text += std::string("durations = ") +
+            (config.durations.kind == DurationKind::Exponential ? "exponential" :
+             config.durations.kind == DurationKind::Constant ? "constant" : "uniform") + "\n";
+    text += "duration-min = " + std::to_string(config.durations.min) + "\n";
+    text += "duration-max = " + std::to_string(config.durations.max) + "\n";
+    text += "duration-mean = " + formatDouble(config.durations.mean) + "\n";
+    return text;
+}
+
+/**
+ * @brief Retrieves the usage text listing every option.
+ * @return Usage text.
+ */
+const char *usageText() {
+    return
+        "Usage: loadbalancer [options]\n"
+        "Options (--key=value or --key value; the same keys work as key = value in a config file):\n"
+        "  --servers=N                number of servers (prompted for if missing)\n"
+        "  --time=N                   ticks to simulate, below 2^32 (prompted for if missing)\n"
+        "  --seed=N                   random seed (default: current time)\n"
+        "  --fleet=NAME:N[:SPEED[:SLOTS]],...  mixed fleet: N servers per class, each\n"
+        "                             doing SPEED work per tick on SLOTS requests at once;\n"
+        "                             sets --servers to the total slots (default: uniform)\n"
+        "  --mode=tick|event          simulation engine (default: tick); --event-driven = event\n"
+        "  --kernel=NAME              tick kernel: auto, avx2, sse4.2 or scalar (default: auto)\n"
+        "  --threads=N                split the fleet into N shards run in parallel; with\n"
+        "                             the shared queue, each shard queues separately\n"
+        "                             (default: 1)\n"
+        "  --arrivals=bursty|poisson  arrival process (default: bursty)\n"
+        "  --arrival-probability=P    bursty: chance of a burst per tick (default: 0.05)\n"
+        "  --max-burst=N              bursty: largest burst (default: 3)\n"
+        "  --arrival-rate=R           poisson: mean arrivals per tick (default: 0.1)\n"
+        "  --durations=uniform|exponential|constant  duration distribution (default: uniform)\n"
+        "  --duration-min=N           uniform: shortest duration (default: 3)\n"
+        "  --duration-max=N           uniform: longest duration (default: 16)\n"
+        "  --duration-mean=X          exponential/constant: mean duration (default: 9.5)\n"
+        "  --trace=PATH               replay requests from a text or binary trace instead\n"
+        "                             of generating them; records at tick 0 form the\n"
+        "                             initial queue\n"
+        "  --record=PATH              save the run's requests as a compact binary trace,\n"
+        "                             with the seed and workload options in its header\n"
+        "  --blocklist=PATH           drop arrivals whose source IP falls in one of these\n"
+        "                             CIDR ranges, one per line; SIGHUP reloads the lists\n"
+        "  --allowlist=PATH           CIDR ranges let through even inside blocked ones;\n"
+        "                             the most specific matching range decides\n"
+        "  --scheduler=fifo|strict|wfq  queue discipline across job classes (default: fifo);\n"
+        "                             central routing only, per-server queues are fifo\n"
+        "  --priority-weight=W        wfq: share of the priority class (default: 3)\n"
+        "  --standard-weight=W        wfq: share of the standard class (default: 1)\n"
+        "  --aging=N                  strict/wfq: serve standard requests waiting N+ ticks\n"
+        "                             ahead of newer priority ones (default: 0 = off)\n"
+        "  --routing=NAME             central (shared queue), or per-server queues with\n"
+        "                             round-robin, least-work, jsq, p2c, jiq, or source-IP\n"
+        "                             affinity: ring or maglev (default: central)\n"
+        "  --virtual-nodes=N          ring: points per server (default: 100)\n"
+        "  --autoscale=on|off         resize the fleet on queue depth (default: off)\n"
+        "  --min-servers=N            autoscale: smallest fleet (default: 1)\n"
+        "  --max-servers=N            autoscale: largest fleet (default: 10x --servers)\n"
+        "  --high-water=X             autoscale: queued per server that adds servers (default: 4)\n"
+        "  --low-water=X              autoscale: queued per server that retires idle servers\n"
+        "                             (default: 0.5)\n"
+        "  --scale-step=F             autoscale: fraction of the fleet changed at once (default: 0.25)\n"
+        "  --cooldown=N               autoscale: minimum ticks between changes (default: 50)\n"
+        "  --scale-interval=N         autoscale: ticks between evaluations (default: 10)\n"
+        "  --rate-limit=R             let each source IP send at most R requests per tick\n"
+        "                             on average; excess arrivals are dropped (default: off)\n"
+        "  --rate-burst=B             rate-limit: requests a quiet source may send at once\n"
+        "                             (default: 10)\n"
+        "  --rate-table=N             rate-limit: sources tracked at once; the least\n"
+        "                             recently seen are forgotten (default: 65536)\n"
+        "  --latency-budget=T         reject arrivals expected to wait more than T ticks,\n"
+        "                             judged from queue depth and service rate, and report\n"
+        "                             goodput; below 2^32 (default: 0 = no budget)\n"
+        "  --admission=on|off         latency-budget: shed arrivals, or only measure\n"
+        "                             goodput against the budget (default: on)\n"
+        "  --shed-standard-at=F       latency-budget: shed standard requests from F of the\n"
+        "                             budget, priority ones from all of it (default: 0.8)\n"
+        "  --mtbf=T                   crash each server after T ticks up on average\n"
+        "                             with all its slots (default: 0 = never)\n"
+        "  --mttr=T                   mean ticks to repair a crash, rack or slowdown\n"
+        "                             (default: 100)\n"
+        "  --rack-size=N              group servers, not slots, into racks of N that fail\n"
+        "                             together\n"
+        "  --rack-mtbf=T              rack-size: crash each rack after T ticks up on average\n"
+        "                             (default: 0 = never)\n"
+        "  --degrade-mtbf=T           slow each server down after T ticks on average\n"
+        "                             (default: 0 = never)\n"
+        "  --degrade-speed=F          degrade-mtbf: share of its speed a slowed server keeps\n"
+        "                             (default: 0.25)\n"
+        "  --on-failure=requeue|lose  what happens to a crashed server's request once the\n"
+        "                             crash is noticed (default: requeue)\n"
+        "  --probe-interval=N         ticks between health checks (default: 10)\n"
+        "  --probe-timeout=N          ticks a server may take to answer one (default: 2)\n"
+        "  --unhealthy-after=N        failed checks in a row that take a server out of\n"
+        "                             rotation (default: 3)\n"
+        "  --healthy-after=N          passed checks in a row that put it back (default: 2)\n"
+        "  --replications=N           run N times with seeds seed, seed+1, ... and report\n"
+        "                             95% confidence intervals (default: 1)\n"
+        "  --jobs=N                   replications run at once (default: 0 = every core)\n"
+        "  --ci-target=F              stop once every interval is within F of its mean,\n"
+        "                             e.g. 0.05 for 5% (default: 0 = run all)\n"
+        "  --log=off|summary|event    how much to log (default: event)\n"
+        "  --log-format=text|binary   log representation (default: text)\n"
+        "  --log-file=PATH            write the log to PATH instead of stdout\n"
+        "  --results=PATH             write end-of-run results as JSON to PATH\n"
+        "  --config=PATH              read options from a config file\n";
+}
\ No newline at end of file
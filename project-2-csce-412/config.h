@@ -0,0 +1,104 @@
+/**
+ * @file config.h
+ * @brief Run configuration loaded from the command line and config files.
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <cstdint>
+#include <string>
+#include "load-balancer.h"
+#include "replication.h"
+
+/**
+ * @struct SimulationConfig
+ * @brief Everything needed to set up and run one simulation.
+ *
+ * Options are written as key=value pairs, either on the command line as
+ * --key=value (or --key value) or one per line in a config file.
+ */
+struct SimulationConfig {
+    size_t servers = 0;                         ///< Number of servers.
+    bool hasServers = false;                    ///< Whether servers was given.
+    std::vector<ServerClass> fleet;             ///< Mixed fleet; empty for uniform servers.
+    size_t runTime = 0;                         ///< Simulation length in ticks.
+    bool hasRunTime = false;                    ///< Whether runTime was given.
+    uint64_t seed = 0;                          ///< Random seed.
+    bool hasSeed = false;                       ///< Whether seed was given.
+    SimulationMode mode = SimulationMode::Tick; ///< How the simulation clock advances.
+    std::string kernel = "auto";                ///< Tick kernel name.
+    size_t threads = 1;                         ///< Threads advancing the fleet.
+    ArrivalModel arrivals;                      ///< Arrival process.
+    DurationModel durations;                    ///< Request duration distribution.
+    std::string traceFile;                      ///< Trace to replay instead; empty for none.
+    std::string recordFile;                     ///< Path to record the requests to; empty for none.
+    std::string blocklistFile;                  ///< CIDR ranges to drop arrivals from; empty for none.
+    std::string allowlistFile;                  ///< CIDR ranges exempt from the blocklist; empty for none.
+    SchedulerConfig scheduling;                 ///< How queued requests are scheduled.
+    AutoscalerConfig autoscaling;               ///< How the fleet is resized.
+    RateLimitConfig rateLimit;                  ///< How fast each source may send.
+    AdmissionConfig admission;                  ///< Latency budget arrivals are measured against.
+    FailureConfig failures;                     ///< Server faults to inject.
+    HealthCheckConfig health;                   ///< How failed servers are detected.
+    RoutingConfig routing;                      ///< How requests are assigned to servers.
+    ReplicationConfig replication;              ///< Independent runs to aggregate.
+    LogLevel logLevel = LogLevel::Event;        ///< How much to log.
+    LogFormat logFormat = LogFormat::Text;      ///< Log representation.
+    std::string logFile;                        ///< Log path; empty for stdout.
+    std::string resultsFile;                    ///< Path for the JSON results; empty for none.
+    bool showHelp = false;                      ///< Whether --help was given.
+};
+
+/**
+ * @brief Applies a single key=value option to a configuration.
+ * @param config Configuration to update.
+ * @param key Option name, without leading dashes.
+ * @param value Option value.
+ * @param error Description of the problem on failure.
+ * @return True if the option was valid.
+ */
+bool applyOption(SimulationConfig &config, const std::string &key, const std::string &value,
+                 std::string &error);
+
+/**
+ * @brief Loads key=value lines from a config file. Blank lines and # comments are ignored.
+ * @param path Config file path.
+ * @param config Configuration to update.
+ * @param error Description of the problem on failure.
+ * @return True if the file was read and every option was valid.
+ */
+bool loadConfigFile(const std::string &path, SimulationConfig &config, std::string &error);
+
+/**
+ * @brief Parses command-line arguments. --config=PATH loads a file at that point.
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments.
+ * @param config Configuration to update.
+ * @param error Description of the problem on failure.
+ * @return True if every argument was valid.
+ */
+bool parseArguments(int argc, char *argv[], SimulationConfig &config, std::string &error);
+
+/**
+ * @brief Checks that the options make sense together.
+ * @param config Configuration to check.
+ * @param error Description of the problem on failure.
+ * @return True if the configuration is usable.
+ */
+bool validateConfig(const SimulationConfig &config, std::string &error);
+
+/**
+ * @brief Writes the options that decide a run's traffic as config-file lines.
+ * @param config Configuration to describe.
+ * @return Lines that loadConfigFile() reads back.
+ */
+std::string formatConfig(const SimulationConfig &config);
+
+/**
+ * @brief Retrieves the usage text listing every option.
+ * @return Usage text.
+ */
+const char *usageText();
+
+#endif
\ No newline at end of file
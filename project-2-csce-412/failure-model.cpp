@@ -0,0 +1,311 @@
+/**
+ * @file failure-model.cpp
+ * @brief Implementation of the FailureModel class.
+ */
+
+#include "failure-model.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Checks whether any kind of fault is injected.
+ * @return True if some mean time between failures is set.
+ */
+bool FailureConfig::enabled() const {
+    return mtbf > 0.0 || rackMtbf > 0.0 || degradeMtbf > 0.0;
+}
+
+/**
+ * @brief Constructs a fault model.
+ * @param cfg Fault parameters.
+ * @param rng Source of fault and repair times.
+ */
+FailureModel::FailureModel(const FailureConfig &cfg, std::unique_ptr<RandomGenerator> rng)
+    : config(cfg), random(std::move(rng)), wait(0.0), hasWait(false) {}
+
+/**
+ * @brief Retrieves the fault parameters.
+ * @return Fault parameters.
+ */
+const FailureConfig& FailureModel::getConfig() const {
+    return config;
+}
+
+/**
+ * @brief Draws an exponentially distributed number of ticks, at least one.
+ * @param mean Mean in ticks.
+ * @return Ticks.
+ */
+size_t FailureModel::draw(double mean) {
+    double ticks = -mean * std::log(1.0 - uniformUnit(random->next()));
+    return std::max<size_t>(1, (size_t)std::ceil(ticks));
+}
+
+/**
+ * @brief Schedules the first fault of every server and rack.
+ * @param slots Pool entries of each server, in pool order.
+ * @param now Current tick.
+ */
+void FailureModel::start(const std::vector<size_t> &slots, size_t now) {
+    size_t servers = slots.size();
+    firstSlot.assign(1, 0);
+    owner.clear();
+    for (size_t i = 0; i < servers; i++) {
+        firstSlot.push_back(firstSlot.back() + slots[i]);
+        owner.insert(owner.end(), slots[i], (uint32_t)i);
+    }
+    outages.assign(servers, 0);
+    slowed.assign(servers, 0);
+    nextCrash.assign(servers, FailureEvent::NONE);
+    crashEvent.assign(servers, FailureEvent::NONE);
+    slowEvent.assign(servers, FailureEvent::NONE);
+
+    for (size_t i = 0; i < servers; i++) {
+        if (config.mtbf > 0.0) {
+            nextCrash[i] = now + draw(config.mtbf);
+            timers.insert(nextCrash[i], i << TIMER_BITS | CRASH);
+        }
+        if (config.degradeMtbf > 0.0) {
+            timers.insert(now + draw(config.degradeMtbf), i << TIMER_BITS | SLOW);
+        }
+    }
+    if (config.rackSize > 0 && config.rackMtbf > 0.0) {
+        size_t racks = (servers + config.rackSize - 1) / config.rackSize;
+        rackEvent.assign(racks, FailureEvent::NONE);
+        for (size_t r = 0; r < racks; r++) {
+            timers.insert(now + draw(config.rackMtbf), r << TIMER_BITS | RACK_CRASH);
+        }
+    }
+}
+
+/**
+ * @brief Retrieves the tick of the next fault or repair.
+ * @return Tick, or TimingWheel::NONE if nothing is pending.
+ */
+size_t FailureModel::nextTime() const {
+    return timers.nextTime();
+}
+
+/**
+ * @brief Records a new fault and opens it for latency tracking.
+ * @param now Current tick.
+ * @param kind Kind of fault.
+ * @param first First server affected.
+ * @param count Servers affected.
+ * @return Event index.
+ */
+size_t FailureModel::record(size_t now, FailureKind kind, size_t first, size_t count) {
+    FailureEvent event;
+    event.time = now;
+    event.kind = kind;
+    event.first = first;
+    event.servers = count;
+    event.baselineWait = wait;
+    event.peakWait = wait;
+    events.push_back(event);
+    open.push_back(events.size() - 1);
+    return events.size() - 1;
+}
+
+/**
+ * @brief Appends a change for every pool entry of a server.
+ * @param server Server index.
+ * @param what What changed.
+ * @param changes Changes are appended here.
+ */
+void FailureModel::change(size_t server, FailureChange::What what,
+                          std::vector<FailureChange> &changes) const {
+    for (size_t slot = firstSlot[server]; slot < firstSlot[server + 1]; slot++) {
+        changes.push_back({slot, what});
+    }
+}
+
+/**
+ * @brief Adds a crash covering a server.
+ * @param index Server index.
+ * @param event Event causing it.
+ * @param changes Down changes are appended if the server was running.
+ */
+void FailureModel::takeDown(size_t index, size_t event, std::vector<FailureChange> &changes) {
+    if (outages[index]++ == 0) {
+        crashEvent[index] = event;
+        change(index, FailureChange::Down, changes);
+    }
+}
+
+/**
+ * @brief Removes a crash covering a server.
+ * 
+ * Once the server runs again its next crash is drawn, unless one is still
+ * pending from before a rack outage covered it.
+ * 
+ * @param index Server index.
+ * @param now Current tick.
+ * @param changes Up changes are appended if no crash covers the server any more.
+ */
+void FailureModel::bringUp(size_t index, size_t now, std::vector<FailureChange> &changes) {
+    if (--outages[index] > 0) {
+        return;
+    }
+    change(index, FailureChange::Up, changes);
+    if (config.mtbf > 0.0 && nextCrash[index] == FailureEvent::NONE) {
+        nextCrash[index] = now + draw(config.mtbf);
+        timers.insert(nextCrash[index], index << TIMER_BITS | CRASH);
+    }
+}
+
+/**
+ * @brief Applies the faults and repairs due on a tick.
+ * 
+ * A server's own crash that comes due while a rack outage already has it down
+ * is dropped; the server draws a new one once it is back.
+ * 
+ * @param now Current tick, no later than nextTime().
+ * @param changes Changes to the servers are appended here, in the order they happen.
+ */
+void FailureModel::advance(size_t now, std::vector<FailureChange> &changes) {
+    fired.clear();
+    timers.advance(now, fired);
+    // The wheel hands out due timers in no particular order; sorting keeps runs reproducible
+    std::sort(fired.begin(), fired.end());
+
+    for (size_t id : fired) {
+        size_t target = id >> TIMER_BITS;
+        switch (id & ((1 << TIMER_BITS) - 1)) {
+        case CRASH:
+            nextCrash[target] = FailureEvent::NONE;
+            if (outages[target] == 0) {
+                size_t event = record(now, FailureKind::Crash, firstSlot[target],
+                                      firstSlot[target + 1] - firstSlot[target]);
+                takeDown(target, event, changes);
+                timers.insert(now + draw(config.mttr), target << TIMER_BITS | REPAIR);
+            }
+            break;
+        case REPAIR:
+            events[crashEvent[target]].repaired = now;
+            bringUp(target, now, changes);
+            break;
+        case RACK_CRASH: {
+            size_t first = target * config.rackSize;
+            size_t last = std::min(first + config.rackSize, outages.size());
+            rackEvent[target] = record(now, FailureKind::Rack, firstSlot[first],
+                                       firstSlot[last] - firstSlot[first]);
+            for (size_t i = first; i < last; i++) {
+                takeDown(i, rackEvent[target], changes);
+            }
+            timers.insert(now + draw(config.mttr), target << TIMER_BITS | RACK_REPAIR);
+            break;
+        }
+        case RACK_REPAIR: {
+            size_t first = target * config.rackSize;
+            size_t last = std::min(first + config.rackSize, outages.size());
+            events[rackEvent[target]].repaired = now;
+            for (size_t i = first; i < last; i++) {
+                bringUp(i, now, changes);
+            }
+            timers.insert(now + draw(config.rackMtbf), target << TIMER_BITS | RACK_CRASH);
+            break;
+        }
+        case SLOW:
+            slowed[target] = 1;
+            slowEvent[target] = record(now, FailureKind::Slowdown, firstSlot[target],
+                                       firstSlot[target + 1] - firstSlot[target]);
+            change(target, FailureChange::Slowed, changes);
+            timers.insert(now + draw(config.mttr), target << TIMER_BITS | RESTORE);
+            break;
+        case RESTORE:
+            slowed[target] = 0;
+            events[slowEvent[target]].repaired = now;
+            change(target, FailureChange::Restored, changes);
+            timers.insert(now + draw(config.degradeMtbf), target << TIMER_BITS | SLOW);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Checks whether a pool entry's server is down.
+ * @param index Pool entry.
+ * @return True while a crash covers it.
+ */
+bool FailureModel::isDown(size_t index) const {
+    return outages[owner[index]] > 0;
+}
+
+/**
+ * @brief Checks whether a pool entry's server is slowed down.
+ * @param index Pool entry.
+ * @return True while slowed.
+ */
+bool FailureModel::isSlowed(size_t index) const {
+    return slowed[owner[index]] != 0;
+}
+
+/**
+ * @brief Records that a health check marked a pool entry down.
+ * 
+ * The detection goes to the crash that took its server down, or to its
+ * slowdown if it is running.
+ * 
+ * @param index Pool entry.
+ * @param now Current tick.
+ */
+void FailureModel::noteDetected(size_t index, size_t now) {
+    size_t server = owner[index];
+    size_t event = outages[server] > 0 ? crashEvent[server] : slowEvent[server];
+    if (event != FailureEvent::NONE && events[event].detected == FailureEvent::NONE) {
+        events[event].detected = now;
+    }
+}
+
+/**
+ * @brief Records the fate of a request a crash cut short.
+ * @param index Pool entry it was running on.
+ * @param requeued True if it was queued again, false if lost.
+ */
+void FailureModel::noteDisplaced(size_t index, bool requeued) {
+    FailureEvent &event = events[crashEvent[owner[index]]];
+    if (requeued) {
+        event.requeued++;
+    } else {
+        event.lost++;
+    }
+}
+
+/**
+ * @brief Feeds the mean wait of the requests that started service on a tick.
+ * 
+ * The waits are smoothed over roughly the last 20 samples. Every fault still
+ * open raises its peak; a repaired one is closed once the average is back
+ * within 10% of its baseline, or within a tick of it for baselines under ten.
+ * 
+ * @param now Current tick.
+ * @param meanWait Mean wait of those requests.
+ */
+void FailureModel::observeWait(size_t now, double meanWait) {
+    // Weight of the newest sample in the moving average
+    const double ALPHA = 0.05;
+    wait = hasWait ? wait + ALPHA * (meanWait - wait) : meanWait;
+    hasWait = true;
+
+    size_t kept = 0;
+    for (size_t e : open) {
+        FailureEvent &event = events[e];
+        event.peakWait = std::max(event.peakWait, wait);
+        double threshold = std::max(event.baselineWait * 1.1, event.baselineWait + 1.0);
+        if (event.repaired != FailureEvent::NONE && wait <= threshold) {
+            event.recovered = now;
+        } else {
+            open[kept++] = e;
+        }
+    }
+    open.resize(kept);
+}
+
+/**
+ * @brief Retrieves every fault so far.
+ * @return Events, oldest first.
+ */
+const std::vector<FailureEvent>& FailureModel::getEvents() const {
+    return events;
+}
\ No newline at end of file
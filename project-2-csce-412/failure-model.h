@@ -0,0 +1,272 @@
+/**
+ * @file failure-model.h
+ * @brief Header file for the FailureModel class that injects server faults.
+ */
+
+#ifndef FAILUREMODEL_H
+#define FAILUREMODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "rng.h"
+#include "timing-wheel.h"
+
+/**
+ * @enum FailurePolicy
+ * @brief What happens to the request a server was running when it crashed.
+ */
+enum class FailurePolicy {
+    Requeue,    ///< Queued again once the crash is noticed, keeping its arrival time.
+    Lose        ///< Dropped.
+};
+
+/**
+ * @struct FailureConfig
+ * @brief Parameters of fault injection. Times are means of exponential distributions.
+ */
+struct FailureConfig {
+    double mtbf = 0.0;                              ///< Ticks a server runs between crashes; 0 = never.
+    double mttr = 100.0;                            ///< Ticks to repair a crash, rack or slowdown.
+    size_t rackSize = 0;                            ///< Servers (not slots) per rack; 0 = no racks.
+    double rackMtbf = 0.0;                          ///< Ticks between failures of a whole rack; 0 = never.
+    double degradeMtbf = 0.0;                       ///< Ticks a server runs between slowdowns; 0 = never.
+    double degradeSpeed = 0.25;                     ///< Share of its speed a slowed server keeps.
+    FailurePolicy inFlight = FailurePolicy::Requeue;    ///< Fate of requests cut short by a crash.
+
+    /**
+     * @brief Checks whether any kind of fault is injected.
+     * @return True if some mean time between failures is set.
+     */
+    bool enabled() const;
+};
+
+/**
+ * @enum FailureKind
+ * @brief Kind of fault.
+ */
+enum class FailureKind : uint8_t {
+    Crash,      ///< One server stops.
+    Rack,       ///< Every server of a rack stops.
+    Slowdown    ///< One server keeps running at a fraction of its speed.
+};
+
+/**
+ * @struct FailureEvent
+ * @brief One injected fault and how the fleet coped with it.
+ *
+ * Latency is tracked as a moving average of the wait of requests starting
+ * service. The fault has recovered once, after its repair, the average is
+ * back within 10% (or one tick) of where it stood when the fault hit.
+ */
+struct FailureEvent {
+    static constexpr size_t NONE = SIZE_MAX;    ///< Time of something that has not happened.
+
+    size_t time = 0;                        ///< Tick the fault hit.
+    FailureKind kind = FailureKind::Crash;  ///< Kind of fault.
+    size_t first = 0;                       ///< First pool entry affected.
+    size_t servers = 0;                     ///< Pool entries affected (consecutive from first).
+    size_t detected = NONE;                 ///< Tick a health check first marked one down.
+    size_t repaired = NONE;                 ///< Tick the fault was repaired.
+    size_t recovered = NONE;                ///< Tick waits were back to the baseline.
+    size_t requeued = 0;                    ///< In-flight requests queued again.
+    size_t lost = 0;                        ///< In-flight requests dropped.
+    double baselineWait = 0.0;              ///< Average wait when the fault hit.
+    double peakWait = 0.0;                  ///< Highest average wait until recovery.
+};
+
+/**
+ * @struct FailureChange
+ * @brief A change to one server's condition that the load balancer has to act on.
+ */
+struct FailureChange {
+    /**
+     * @enum What
+     * @brief What changed.
+     */
+    enum What : uint8_t {
+        Down,       ///< The server stopped; its request, if any, is cut short.
+        Up,         ///< The server runs again.
+        Slowed,     ///< The server's speed dropped.
+        Restored    ///< The server's speed is back to normal.
+    };
+
+    size_t server;  ///< Server index.
+    What what;      ///< What changed.
+};
+
+/**
+ * @class FailureModel
+ * @brief Decides when servers crash, whole racks go down and servers slow down.
+ *
+ * Each server and rack draws its time to the next fault and the time to repair
+ * it from exponential distributions; a new time to failure is drawn only once
+ * the previous fault is repaired, so MTBF counts running time. A server is down
+ * while any crash covering it, its own or its rack's, is unrepaired. Pending
+ * faults are kept in a timing wheel, so quiet servers cost nothing per tick.
+ *
+ * A server with several slots takes several consecutive pool entries; faults
+ * are drawn per server and hit all of its entries at once, and racks group
+ * servers. Changes and queries are in terms of pool entries.
+ *
+ * The model also keeps the record of every fault, filled in as the load
+ * balancer reports detections, displaced requests and waits.
+ */
+class FailureModel {
+public:
+    /// Random stream number used for fault times.
+    static const size_t STREAM = 5;
+
+private:
+    /**
+     * @enum Timer
+     * @brief Kind of pending fault-model timer, kept in the low bits of a wheel id.
+     */
+    enum Timer : size_t {
+        CRASH,          ///< A server crashes.
+        REPAIR,         ///< A server's own crash is repaired.
+        RACK_CRASH,     ///< A rack goes down.
+        RACK_REPAIR,    ///< A rack comes back.
+        SLOW,           ///< A server slows down.
+        RESTORE         ///< A server's speed returns.
+    };
+
+    /// Bits the timer kind takes in a wheel id; the server or rack index is above them.
+    static const size_t TIMER_BITS = 3;
+
+    FailureConfig config;                       ///< Fault parameters.
+    std::unique_ptr<RandomGenerator> random;    ///< Source of fault and repair times.
+    TimingWheel timers;                         ///< Pending faults and repairs.
+    std::vector<size_t> firstSlot;              ///< First pool entry of each server, then the total.
+    std::vector<uint32_t> owner;                ///< Server each pool entry belongs to.
+    std::vector<uint32_t> outages;              ///< Unrepaired crashes covering each server.
+    std::vector<uint8_t> slowed;                ///< Whether each server is slowed down.
+    std::vector<size_t> nextCrash;              ///< Tick of each server's pending crash, or NONE.
+    std::vector<size_t> crashEvent;             ///< Event that last took each server down.
+    std::vector<size_t> slowEvent;              ///< Event that last slowed each server.
+    std::vector<size_t> rackEvent;              ///< Event of each rack's current outage.
+    std::vector<FailureEvent> events;           ///< Every fault so far.
+    std::vector<size_t> open;                   ///< Events not yet recovered.
+    std::vector<size_t> fired;                  ///< Scratch: wheel ids due on a tick.
+    double wait;                                ///< Moving average of waits.
+    bool hasWait;                               ///< Whether any wait was observed.
+
+    /**
+     * @brief Draws an exponentially distributed number of ticks, at least one.
+     * @param mean Mean in ticks.
+     * @return Ticks.
+     */
+    size_t draw(double mean);
+
+    /**
+     * @brief Records a new fault and opens it for latency tracking.
+     * @param now Current tick.
+     * @param kind Kind of fault.
+     * @param first First server affected.
+     * @param count Servers affected.
+     * @return Event index.
+     */
+    size_t record(size_t now, FailureKind kind, size_t first, size_t count);
+
+    /**
+     * @brief Appends a change for every pool entry of a server.
+     * @param server Server index.
+     * @param what What changed.
+     * @param changes Changes are appended here.
+     */
+    void change(size_t server, FailureChange::What what, std::vector<FailureChange> &changes) const;
+
+    /**
+     * @brief Adds a crash covering a server.
+     * @param index Server index.
+     * @param event Event causing it.
+     * @param changes Down changes are appended if the server was running.
+     */
+    void takeDown(size_t index, size_t event, std::vector<FailureChange> &changes);
+
+    /**
+     * @brief Removes a crash covering a server.
+     * @param index Server index.
+     * @param now Current tick.
+     * @param changes Up changes are appended if no crash covers the server any more.
+     */
+    void bringUp(size_t index, size_t now, std::vector<FailureChange> &changes);
+
+public:
+    /**
+     * @brief Constructs a fault model.
+     * @param cfg Fault parameters.
+     * @param rng Source of fault and repair times.
+     */
+    FailureModel(const FailureConfig &cfg, std::unique_ptr<RandomGenerator> rng);
+
+    /**
+     * @brief Retrieves the fault parameters.
+     * @return Fault parameters.
+     */
+    const FailureConfig& getConfig() const;
+
+    /**
+     * @brief Schedules the first fault of every server and rack.
+     * @param slots Pool entries of each server, in pool order.
+     * @param now Current tick.
+     */
+    void start(const std::vector<size_t> &slots, size_t now);
+
+    /**
+     * @brief Retrieves the tick of the next fault or repair.
+     * @return Tick, or TimingWheel::NONE if nothing is pending.
+     */
+    size_t nextTime() const;
+
+    /**
+     * @brief Applies the faults and repairs due on a tick.
+     * @param now Current tick, no later than nextTime().
+     * @param changes Changes to the servers are appended here, in the order they happen.
+     */
+    void advance(size_t now, std::vector<FailureChange> &changes);
+
+    /**
+     * @brief Checks whether a pool entry's server is down.
+     * @param index Pool entry.
+     * @return True while a crash covers it.
+     */
+    bool isDown(size_t index) const;
+
+    /**
+     * @brief Checks whether a pool entry's server is slowed down.
+     * @param index Pool entry.
+     * @return True while slowed.
+     */
+    bool isSlowed(size_t index) const;
+
+    /**
+     * @brief Records that a health check marked a pool entry down.
+     * @param index Pool entry.
+     * @param now Current tick.
+     */
+    void noteDetected(size_t index, size_t now);
+
+    /**
+     * @brief Records the fate of a request a crash cut short.
+     * @param index Pool entry it was running on.
+     * @param requeued True if it was queued again, false if lost.
+     */
+    void noteDisplaced(size_t index, bool requeued);
+
+    /**
+     * @brief Feeds the mean wait of the requests that started service on a tick.
+     * @param now Current tick.
+     * @param meanWait Mean wait of those requests.
+     */
+    void observeWait(size_t now, double meanWait);
+
+    /**
+     * @brief Retrieves every fault so far.
+     * @return Events, oldest first.
+     */
+    const std::vector<FailureEvent>& getEvents() const;
+};
+
+#endif
\ No newline at end of file
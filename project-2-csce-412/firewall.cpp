@@ -0,0 +1,257 @@
+/**
+ * @file firewall.cpp
+ * @brief Implementation of the Firewall and FirewallReloader classes.
+ */
+
+#include "firewall.h"
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <pthread.h>
+
+/**
+ * @brief Parses "a.b.c.d/len", or a bare address meaning /32.
+ * @param text CIDR text.
+ * @param prefix Network address on success, with host bits cleared.
+ * @param length Prefix length on success.
+ * @return True if the text is a valid range.
+ */
+bool parseCidr(const std::string &text, uint32_t &prefix, uint8_t &length) {
+    const char *p = text.data();
+    const char *end = p + text.size();
+    uint32_t address = 0;
+    for (int octet = 0; octet < 4; octet++) {
+        unsigned part;
+        auto result = std::from_chars(p, end, part);
+        if (result.ec != std::errc() || result.ptr == p || part > 255) {
+            return false;
+        }
+        address = address << 8 | part;
+        p = result.ptr;
+        if (octet < 3) {
+            if (p == end || *p != '.') {
+                return false;
+            }
+            p++;
+        }
+    }
+
+    unsigned bits = 32;
+    if (p != end) {
+        if (*p != '/') {
+            return false;
+        }
+        auto result = std::from_chars(p + 1, end, bits);
+        if (result.ec != std::errc() || result.ptr != end || result.ptr == p + 1 || bits > 32) {
+            return false;
+        }
+    }
+    prefix = bits == 0 ? 0 : address & (~(uint32_t)0 << (32 - bits));
+    length = (uint8_t)bits;
+    return true;
+}
+
+/**
+ * @brief Formats a range as "a.b.c.d/len".
+ * @param prefix Network address.
+ * @param length Prefix length.
+ * @return CIDR text.
+ */
+std::string formatCidr(uint32_t prefix, uint8_t length) {
+    char text[Request::MAX_IP_LENGTH];
+    return std::string(text, Request::formatIP(prefix, text)) + "/" + std::to_string(length);
+}
+
+/**
+ * @brief Constructs a firewall with no rules, which lets everything through.
+ */
+Firewall::Firewall() : active(std::make_shared<RuleSet>()), dropped(0) {}
+
+/**
+ * @brief Reads a list of ranges, one per line; blank lines and # comments are ignored.
+ * @param path List path; empty for none.
+ * @param allow Whether the list is an allowlist.
+ * @param rules Rules are appended here.
+ * @param error Description of the problem on failure.
+ * @return True if the file was read and every line was valid.
+ */
+bool Firewall::readList(const std::string &path, bool allow, std::vector<FirewallRule> &rules,
+                        std::string &error) {
+    if (path.empty()) {
+        return true;
+    }
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string line;
+    for (size_t number = 1; std::getline(in, line); number++) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+        size_t end = line.find_first_of(" \t\r#", start);
+        size_t rest = end == std::string::npos ? end : line.find_first_not_of(" \t\r", end);
+        FirewallRule rule;
+        rule.allow = allow;
+        if (!parseCidr(line.substr(start, end - start), rule.prefix, rule.length) ||
+            (rest != std::string::npos && line[rest] != '#')) {
+            error = path + ":" + std::to_string(number) + ": invalid range '" + line + "'";
+            return false;
+        }
+        rules.push_back(rule);
+    }
+    return true;
+}
+
+/**
+ * @brief Loads a blocklist and an allowlist and makes them the active rule set.
+ *
+ * The new table is built before anything is swapped, so filter() keeps using
+ * the old one until the single atomic store. Allowlist ranges are added last,
+ * so they win over identical blocklist ranges.
+ *
+ * @param blocklist Path of the ranges to drop; empty for none.
+ * @param allowlist Path of the ranges to let through inside blocked ones; empty for none.
+ * @param error Description of the problem on failure.
+ * @return True if both lists were read.
+ */
+bool Firewall::load(const std::string &blocklist, const std::string &allowlist,
+                    std::string &error) {
+    std::shared_ptr<RuleSet> next = std::make_shared<RuleSet>();
+    if (!readList(blocklist, false, next->rules, error) ||
+        !readList(allowlist, true, next->rules, error)) {
+        return false;
+    }
+
+    std::vector<PrefixTrie::Prefix> prefixes;
+    prefixes.reserve(next->rules.size());
+    for (size_t i = 0; i < next->rules.size(); i++) {
+        prefixes.push_back({next->rules[i].prefix, next->rules[i].length, (uint32_t)i});
+    }
+    next->trie.build(prefixes);
+    next->hits.assign(next->rules.size(), 0);
+
+    {
+        std::lock_guard<std::mutex> guard(loadedLock);
+        loaded.push_back(next);
+    }
+    std::atomic_store(&active, next);
+    return true;
+}
+
+/**
+ * @brief Removes the requests the active rules drop, keeping the others in order.
+ * @param rs Requests; the kept ones are moved to the front.
+ * @param n Number of requests.
+ * @return Number of requests kept.
+ */
+size_t Firewall::filter(Request *rs, size_t n) {
+    std::shared_ptr<RuleSet> rules = std::atomic_load(&active);
+    if (rules->rules.empty()) {
+        return n;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t match = rules->trie.lookup(rs[i].getIpIn());
+        if (match != PrefixTrie::NONE) {
+            rules->hits[match]++;
+            if (!rules->rules[match].allow) {
+                dropped++;
+                continue;
+            }
+        }
+        rs[kept++] = rs[i];
+    }
+    return kept;
+}
+
+/**
+ * @brief Retrieves the number of requests dropped so far.
+ * @return Dropped requests.
+ */
+uint64_t Firewall::getDropped() const {
+    return dropped;
+}
+
+/**
+ * @brief Retrieves the number of rule sets loaded, counting the first.
+ * @return Loads.
+ */
+size_t Firewall::getLoads() const {
+    std::lock_guard<std::mutex> guard(loadedLock);
+    return loaded.size();
+}
+
+/**
+ * @brief Totals the hits of each rule over every rule set loaded, in first-loaded order.
+ * @return Hits per distinct rule.
+ */
+std::vector<FirewallCount> Firewall::getCounts() const {
+    std::lock_guard<std::mutex> guard(loadedLock);
+    std::vector<FirewallCount> counts;
+    std::map<uint64_t, size_t> index;
+    for (const std::shared_ptr<RuleSet> &set : loaded) {
+        for (size_t i = 0; i < set->rules.size(); i++) {
+            const FirewallRule &rule = set->rules[i];
+            uint64_t key = (uint64_t)rule.prefix << 8 | (uint64_t)rule.length << 1 | rule.allow;
+            auto found = index.emplace(key, counts.size());
+            if (found.second) {
+                counts.push_back({rule, 0});
+            }
+            counts[found.first->second].hits += set->hits[i];
+        }
+    }
+    return counts;
+}
+
+/**
+ * @brief Blocks SIGHUP in the calling thread. Construct before starting other threads.
+ */
+FirewallReloader::FirewallReloader() : stopping(false) {
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, &previous);
+}
+
+/**
+ * @brief Stops the waiting thread and restores the signal mask.
+ */
+FirewallReloader::~FirewallReloader() {
+    stop();
+    pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+}
+
+/**
+ * @brief Starts reloading a firewall on SIGHUP.
+ * @param firewall Firewall to reload; must outlive this object.
+ * @param blocklist Blocklist path.
+ * @param allowlist Allowlist path.
+ */
+void FirewallReloader::start(Firewall &firewall, const std::string &blocklist,
+                             const std::string &allowlist) {
+    waiter = std::thread([this, &firewall, blocklist, allowlist] {
+        int signal;
+        while (sigwait(&signals, &signal) == 0 && !stopping) {
+            std::string error;
+            if (firewall.load(blocklist, allowlist, error)) {
+                std::cerr << "Reloaded firewall rules\n";
+            } else {
+                std::cerr << "loadbalancer: " << error << "; keeping the current rules\n";
+            }
+        }
+    });
+}
+
+/**
+ * @brief Stops the waiting thread; the firewall is not touched afterwards.
+ */
+void FirewallReloader::stop() {
+    if (waiter.joinable()) {
+        stopping = true;
+        pthread_kill(waiter.native_handle(), SIGHUP);
+        waiter.join();
+    }
+}
\ No newline at end of file
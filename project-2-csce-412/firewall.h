@@ -0,0 +1,188 @@
+/**
+ * @file firewall.h
+ * @brief Header file for the Firewall class that drops requests from blocked address ranges.
+ */
+
+#ifndef FIREWALL_H
+#define FIREWALL_H
+
+#include <atomic>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "prefix-trie.h"
+#include "request.h"
+
+/**
+ * @struct FirewallRule
+ * @brief One CIDR range from a blocklist or an allowlist.
+ */
+struct FirewallRule {
+    uint32_t prefix;    ///< Network address, host bits cleared.
+    uint8_t length;     ///< Prefix length, 0 to 32.
+    bool allow;         ///< Whether it comes from the allowlist (let through) or the blocklist.
+};
+
+/**
+ * @struct FirewallCount
+ * @brief How many requests a rule matched.
+ */
+struct FirewallCount {
+    FirewallRule rule;  ///< Rule.
+    uint64_t hits;      ///< Requests it decided: dropped for blocks, let through for allows.
+};
+
+/**
+ * @brief Parses "a.b.c.d/len", or a bare address meaning /32.
+ * @param text CIDR text.
+ * @param prefix Network address on success, with host bits cleared.
+ * @param length Prefix length on success.
+ * @return True if the text is a valid range.
+ */
+bool parseCidr(const std::string &text, uint32_t &prefix, uint8_t &length);
+
+/**
+ * @brief Formats a range as "a.b.c.d/len".
+ * @param prefix Network address.
+ * @param length Prefix length.
+ * @return CIDR text.
+ */
+std::string formatCidr(uint32_t prefix, uint8_t length);
+
+/**
+ * @class Firewall
+ * @brief Screens arriving requests by source address against CIDR block- and allowlists.
+ *
+ * The most specific matching range decides: a request is dropped when it is a
+ * blocklist range, and let through when it is an allowlist range (which wins a
+ * tie) or nothing matches. Rules are compiled into a PrefixTrie. Loading a new
+ * rule set builds a fresh table and swaps it in atomically, so a reload from
+ * another thread never holds up filter(); each batch uses the table that was
+ * current when it started.
+ */
+class Firewall {
+private:
+    /**
+     * @struct RuleSet
+     * @brief A loaded set of rules and the table compiled from them.
+     */
+    struct RuleSet {
+        std::vector<FirewallRule> rules;    ///< Rules; trie values index this.
+        PrefixTrie trie;                    ///< Longest-prefix-match table over the rules.
+        std::vector<uint64_t> hits;         ///< Requests each rule decided.
+    };
+
+    std::shared_ptr<RuleSet> active;                ///< Rule set in use; swapped atomically.
+    std::vector<std::shared_ptr<RuleSet>> loaded;   ///< Every rule set used, for the counts.
+    mutable std::mutex loadedLock;                  ///< Guards loaded.
+    uint64_t dropped;                               ///< Requests dropped so far.
+
+    /**
+     * @brief Reads a list of ranges, one per line; blank lines and # comments are ignored.
+     * @param path List path; empty for none.
+     * @param allow Whether the list is an allowlist.
+     * @param rules Rules are appended here.
+     * @param error Description of the problem on failure.
+     * @return True if the file was read and every line was valid.
+     */
+    static bool readList(const std::string &path, bool allow, std::vector<FirewallRule> &rules,
+                         std::string &error);
+
+public:
+    /**
+     * @brief Constructs a firewall with no rules, which lets everything through.
+     */
+    Firewall();
+
+    /**
+     * @brief Loads a blocklist and an allowlist and makes them the active rule set.
+     *
+     * Safe to call while another thread runs filter(). On failure the active
+     * rules stay in place.
+     *
+     * @param blocklist Path of the ranges to drop; empty for none.
+     * @param allowlist Path of the ranges to let through inside blocked ones; empty for none.
+     * @param error Description of the problem on failure.
+     * @return True if both lists were read.
+     */
+    bool load(const std::string &blocklist, const std::string &allowlist, std::string &error);
+
+    /**
+     * @brief Removes the requests the active rules drop, keeping the others in order.
+     * @param rs Requests; the kept ones are moved to the front.
+     * @param n Number of requests.
+     * @return Number of requests kept.
+     */
+    size_t filter(Request *rs, size_t n);
+
+    /**
+     * @brief Retrieves the number of requests dropped so far.
+     * @return Dropped requests.
+     */
+    uint64_t getDropped() const;
+
+    /**
+     * @brief Retrieves the number of rule sets loaded, counting the first.
+     * @return Loads.
+     */
+    size_t getLoads() const;
+
+    /**
+     * @brief Totals the hits of each rule over every rule set loaded, in first-loaded order.
+     *
+     * Call from the thread that runs filter().
+     *
+     * @return Hits per distinct rule.
+     */
+    std::vector<FirewallCount> getCounts() const;
+};
+
+/**
+ * @class FirewallReloader
+ * @brief Reloads a firewall's lists whenever the process receives SIGHUP.
+ *
+ * Constructing it blocks SIGHUP in the calling thread, and so in the threads it
+ * starts afterwards; start() then launches a thread that waits for the signal
+ * and reloads, leaving the simulation threads undisturbed.
+ */
+class FirewallReloader {
+private:
+    sigset_t signals;               ///< Just SIGHUP.
+    sigset_t previous;              ///< Signal mask before construction.
+    std::thread waiter;             ///< Thread waiting for SIGHUP.
+    std::atomic<bool> stopping;     ///< Set to make the waiter exit.
+
+public:
+    /**
+     * @brief Blocks SIGHUP in the calling thread. Construct before starting other threads.
+     */
+    FirewallReloader();
+
+    /**
+     * @brief Stops the waiting thread and restores the signal mask.
+     */
+    ~FirewallReloader();
+
+    FirewallReloader(const FirewallReloader&) = delete;
+    FirewallReloader& operator=(const FirewallReloader&) = delete;
+
+    /**
+     * @brief Starts reloading a firewall on SIGHUP.
+     * @param firewall Firewall to reload; must outlive this object.
+     * @param blocklist Blocklist path.
+     * @param allowlist Allowlist path.
+     */
+    void start(Firewall &firewall, const std::string &blocklist, const std::string &allowlist);
+
+    /**
+     * @brief Stops the waiting thread; the firewall is not touched afterwards.
+     */
+    void stop();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+/**
+ * @file health-checker.cpp
+ * @brief Implementation of the HealthChecker class.
+ */
+
+#include "health-checker.h"
+#include <cstdint>
+
+/**
+ * @brief Constructs a health checker.
+ * @param cfg Probe parameters.
+ */
+HealthChecker::HealthChecker(const HealthCheckConfig &cfg) : config(cfg) {}
+
+/**
+ * @brief Retrieves the probe parameters.
+ * @return Probe parameters.
+ */
+const HealthCheckConfig& HealthChecker::getConfig() const {
+    return config;
+}
+
+/**
+ * @brief Sets the number of servers, all marked up.
+ * @param servers Number of servers.
+ */
+void HealthChecker::resize(size_t servers) {
+    down.assign(servers, 0);
+    streak.assign(servers, 0);
+    suspect.assign(servers, 0);
+    watched.clear();
+}
+
+/**
+ * @brief Starts probing a server whose condition changed.
+ * @param index Server index.
+ */
+void HealthChecker::watch(size_t index) {
+    if (!suspect[index]) {
+        suspect[index] = 1;
+        watched.push_back(index);
+    }
+}
+
+/**
+ * @brief Checks whether servers are probed on a tick.
+ * @param now Current simulation time.
+ * @return True if some server is watched and now is a multiple of the interval.
+ */
+bool HealthChecker::isProbeTick(size_t now) const {
+    return !watched.empty() && now % config.interval == 0;
+}
+
+/**
+ * @brief Retrieves the first probe tick after a given tick.
+ * @param now Current simulation time.
+ * @return Next probe tick, or SIZE_MAX if no server is watched.
+ */
+size_t HealthChecker::nextProbe(size_t now) const {
+    if (watched.empty()) {
+        return SIZE_MAX;
+    }
+    return (now / config.interval + 1) * config.interval;
+}
+
+/**
+ * @brief Probes the watched servers and updates their marks.
+ * 
+ * A probe passes if the server answers within the timeout. A server stops
+ * being watched once it is marked up and passes a probe.
+ * 
+ * @param responseTime Ticks a server takes to answer a probe, or SIZE_MAX if it cannot.
+ * @param markedDown Servers marked down by this round are appended here.
+ * @param markedUp Servers marked up by this round are appended here.
+ */
+void HealthChecker::probe(const std::function<size_t(size_t)> &responseTime,
+                          std::vector<size_t> &markedDown, std::vector<size_t> &markedUp) {
+    size_t kept = 0;
+    for (size_t index : watched) {
+        bool passed = responseTime(index) <= config.timeout;
+        if (passed == !down[index]) {
+            streak[index] = 0;
+        } else if (++streak[index] >= (down[index] ? config.healthyThreshold : config.unhealthyThreshold)) {
+            down[index] = !down[index];
+            streak[index] = 0;
+            (down[index] ? markedDown : markedUp).push_back(index);
+        }
+
+        if (passed && !down[index]) {
+            suspect[index] = 0;
+        } else {
+            watched[kept++] = index;
+        }
+    }
+    watched.resize(kept);
+}
+
+/**
+ * @brief Checks whether a server is marked down.
+ * @param index Server index.
+ * @return True if it gets no traffic.
+ */
+bool HealthChecker::isMarkedDown(size_t index) const {
+    return down[index] != 0;
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+/**
+ * @file health-checker.h
+ * @brief Header file for the HealthChecker class that decides which servers get traffic.
+ */
+
+#ifndef HEALTHCHECKER_H
+#define HEALTHCHECKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @struct HealthCheckConfig
+ * @brief Parameters of active health checking.
+ */
+struct HealthCheckConfig {
+    size_t interval = 10;           ///< Ticks between probes.
+    size_t timeout = 2;             ///< Ticks a server may take to answer a probe.
+    size_t unhealthyThreshold = 3;  ///< Failed probes in a row that mark a server down.
+    size_t healthyThreshold = 2;    ///< Passed probes in a row that mark it up again.
+};
+
+/**
+ * @class HealthChecker
+ * @brief Marks servers down and up from the results of periodic probes.
+ *
+ * Every interval ticks each server is probed; a server that misses
+ * unhealthyThreshold probes in a row stops getting traffic, and one that then
+ * passes healthyThreshold in a row gets it again. Between a fault and its
+ * detection the load balancer keeps sending work to the server, which is the
+ * cost a shorter interval or lower threshold buys down.
+ *
+ * A server that is marked up and passed its last probe cannot change state on
+ * the next one, so only servers that have been reported as suspect are
+ * actually probed; the outcome is the same as probing everyone.
+ */
+class HealthChecker {
+private:
+    HealthCheckConfig config;       ///< Probe parameters.
+    std::vector<uint8_t> down;      ///< Whether each server is marked down.
+    std::vector<uint32_t> streak;   ///< Probes in a row that disagree with each server's mark.
+    std::vector<uint8_t> suspect;   ///< Whether each server is in watched.
+    std::vector<size_t> watched;    ///< Servers being probed.
+
+public:
+    /**
+     * @brief Constructs a health checker.
+     * @param cfg Probe parameters.
+     */
+    explicit HealthChecker(const HealthCheckConfig &cfg = HealthCheckConfig());
+
+    /**
+     * @brief Retrieves the probe parameters.
+     * @return Probe parameters.
+     */
+    const HealthCheckConfig& getConfig() const;
+
+    /**
+     * @brief Sets the number of servers, all marked up.
+     * @param servers Number of servers.
+     */
+    void resize(size_t servers);
+
+    /**
+     * @brief Starts probing a server whose condition changed.
+     * @param index Server index.
+     */
+    void watch(size_t index);
+
+    /**
+     * @brief Checks whether servers are probed on a tick.
+     * @param now Current simulation time.
+     * @return True if some server is watched and now is a multiple of the interval.
+     */
+    bool isProbeTick(size_t now) const;
+
+    /**
+     * @brief Retrieves the first probe tick after a given tick.
+     * @param now Current simulation time.
+     * @return Next probe tick, or SIZE_MAX if no server is watched.
+     */
+    size_t nextProbe(size_t now) const;
+
+    /**
+     * @brief Probes the watched servers and updates their marks.
+     * @param responseTime Ticks a server takes to answer a probe, or SIZE_MAX if it cannot.
+     * @param markedDown Servers marked down by this round are appended here.
+     * @param markedUp Servers marked up by this round are appended here.
+     */
+    void probe(const std::function<size_t(size_t)> &responseTime,
+               std::vector<size_t> &markedDown, std::vector<size_t> &markedUp);
+
+    /**
+     * @brief Checks whether a server is marked down.
+     * @param index Server index.
+     * @return True if it gets no traffic.
+     */
+    bool isMarkedDown(size_t index) const;
+};
+
+#endif
\ No newline at end of file
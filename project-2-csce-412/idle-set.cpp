@@ -0,0 +1,146 @@
+/**
+ * @file idle-set.cpp
+ * @brief Implementation of the IdleSet class.
+ */
+
+#include "idle-set.h"
+#include <algorithm>
+
+/**
+ * @brief Constructs a set where every server is idle.
+ * @param servers Number of servers.
+ */
+IdleSet::IdleSet(size_t servers)
+    : words((servers + 63) / 64, 0), summary((words.size() + 63) / 64, 0),
+      counts(summary.size(), 0) {
+    for (size_t i = 0; i < servers; i++) {
+        insert(i);
+    }
+}
+
+/**
+ * @brief Changes the number of servers the set can hold.
+ * 
+ * Added servers start out busy; removed servers are dropped from the set.
+ * 
+ * @param servers New number of servers.
+ */
+void IdleSet::resize(size_t servers) {
+    for (size_t i = next(servers); i != NONE; i = next(i + 1)) {
+        erase(i);
+    }
+    words.resize((servers + 63) / 64, 0);
+    summary.resize((words.size() + 63) / 64, 0);
+    counts.resize(summary.size(), 0);
+}
+
+/**
+ * @brief Marks a server idle.
+ * @param index Server index.
+ */
+void IdleSet::insert(size_t index) {
+    uint64_t &word = words[index / 64];
+    uint64_t bit = (uint64_t)1 << (index % 64);
+    if ((word & bit) == 0) {
+        word |= bit;
+        summary[index / BLOCK] |= (uint64_t)1 << (index / 64 % 64);
+        counts[index / BLOCK]++;
+    }
+}
+
+/**
+ * @brief Marks a server busy.
+ * @param index Server index.
+ */
+void IdleSet::erase(size_t index) {
+    uint64_t &word = words[index / 64];
+    uint64_t bit = (uint64_t)1 << (index % 64);
+    if (word & bit) {
+        word &= ~bit;
+        if (word == 0) {
+            summary[index / BLOCK] &= ~((uint64_t)1 << (index / 64 % 64));
+        }
+        counts[index / BLOCK]--;
+    }
+}
+
+/**
+ * @brief Checks whether a server is idle.
+ * @param index Server index.
+ * @return True if the server is in the set.
+ */
+bool IdleSet::contains(size_t index) const {
+    return (words[index / 64] >> (index % 64)) & 1;
+}
+
+/**
+ * @brief Finds the lowest idle server at or after an index.
+ * @param from First index to consider.
+ * @return Server index, or NONE.
+ */
+size_t IdleSet::next(size_t from) const {
+    size_t w = from / 64;
+    if (w >= words.size()) {
+        return NONE;
+    }
+
+    // Rest of the starting word
+    uint64_t bits = words[w] & (~(uint64_t)0 << (from % 64));
+    if (bits != 0) {
+        return w * 64 + __builtin_ctzll(bits);
+    }
+
+    // Next non-empty word, found through the summary level
+    size_t s = (w + 1) / 64;
+    if (s >= summary.size()) {
+        return NONE;
+    }
+    uint64_t sbits = summary[s] & (~(uint64_t)0 << ((w + 1) % 64));
+    while (sbits == 0) {
+        if (++s >= summary.size()) {
+            return NONE;
+        }
+        sbits = summary[s];
+    }
+    w = s * 64 + __builtin_ctzll(sbits);
+    return w * 64 + __builtin_ctzll(words[w]);
+}
+
+/**
+ * @brief Retrieves the number of idle servers.
+ * @return Number of idle servers.
+ */
+size_t IdleSet::size() const {
+    return count(0, counts.size() * BLOCK);
+}
+
+/**
+ * @brief Counts the idle servers in a range.
+ * @param begin First index; a multiple of BLOCK.
+ * @param end One past the last index; a multiple of BLOCK or at least the set's capacity.
+ * @return Number of idle servers in [begin, end).
+ */
+size_t IdleSet::count(size_t begin, size_t end) const {
+    if (begin >= end) {
+        return 0;
+    }
+    size_t total = 0;
+    size_t last = std::min((end + BLOCK - 1) / BLOCK, counts.size());
+    for (size_t b = begin / BLOCK; b < last; b++) {
+        total += counts[b];
+    }
+    return total;
+}
+
+/**
+ * @brief Checks whether no server is idle.
+ * @return True if the set is empty.
+ */
+bool IdleSet::empty() const {
+    for (uint64_t bits : summary) {
+        if (bits != 0) {
+            return false;
+        }
+    }
+    return true;
+}
\ No newline at end of file
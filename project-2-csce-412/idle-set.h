@@ -0,0 +1,106 @@
+/**
+ * @file idle-set.h
+ * @brief Header file for the IdleSet class.
+ */
+
+#ifndef IDLESET_H
+#define IDLESET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class IdleSet
+ * @brief Set of idle server indices stored as a two-level bitmap.
+ *
+ * The lower level has one bit per server; the upper level has one bit per
+ * non-empty lower word. Insert and erase are O(1), and next() skips runs of
+ * busy servers 4096 at a time, so handing out work costs time proportional to
+ * the number of servers taking it rather than to the size of the fleet.
+ * Servers come out in index order, which keeps dispatch deterministic.
+ *
+ * Membership is counted per block of 4096 servers (one summary word), so
+ * threads updating disjoint, block-aligned ranges of the set never write the
+ * same memory. size() adds up the blocks.
+ */
+class IdleSet {
+private:
+    std::vector<uint64_t> words;    ///< One bit per server.
+    std::vector<uint64_t> summary;  ///< One bit per non-zero entry of words.
+    std::vector<uint32_t> counts;   ///< Number of servers in the set, per summary word.
+
+public:
+    /**
+     * @brief Returned by next() when no later server is idle.
+     */
+    static const size_t NONE = SIZE_MAX;
+
+    /**
+     * @brief Servers per summary word, the unit that can be updated concurrently.
+     */
+    static const size_t BLOCK = 4096;
+
+    /**
+     * @brief Constructs a set where every server is idle.
+     * @param servers Number of servers.
+     */
+    explicit IdleSet(size_t servers);
+
+    /**
+     * @brief Changes the number of servers the set can hold.
+     *
+     * Added servers start out busy; removed servers are dropped from the set.
+     *
+     * @param servers New number of servers.
+     */
+    void resize(size_t servers);
+
+    /**
+     * @brief Marks a server idle.
+     * @param index Server index.
+     */
+    void insert(size_t index);
+
+    /**
+     * @brief Marks a server busy.
+     * @param index Server index.
+     */
+    void erase(size_t index);
+
+    /**
+     * @brief Checks whether a server is idle.
+     * @param index Server index.
+     * @return True if the server is in the set.
+     */
+    bool contains(size_t index) const;
+
+    /**
+     * @brief Finds the lowest idle server at or after an index.
+     * @param from First index to consider.
+     * @return Server index, or NONE.
+     */
+    size_t next(size_t from) const;
+
+    /**
+     * @brief Retrieves the number of idle servers.
+     * @return Number of idle servers.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Counts the idle servers in a range.
+     * @param begin First index; a multiple of BLOCK.
+     * @param end One past the last index; a multiple of BLOCK or at least the set's capacity.
+     * @return Number of idle servers in [begin, end).
+     */
+    size_t count(size_t begin, size_t end) const;
+
+    /**
+     * @brief Checks whether no server is idle.
+     * @return True if the set is empty.
+     */
+    bool empty() const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,142 @@
+/**
+ * @file latency-histogram.cpp
+ * @brief Implementation of the LatencyHistogram class.
+ */
+
+#include "latency-histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const unsigned SUB_BUCKET_BITS = 4;                     ///< log2 of sub-buckets per power of two.
+const uint64_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;      ///< Sub-buckets per power of two.
+const uint64_t LINEAR_LIMIT = 2 * SUB_BUCKETS;          ///< Values below this get a bucket each.
+const size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS; ///< Buckets covering 64 bits.
+
+} // namespace
+
+/**
+ * @brief Constructs an empty histogram.
+ */
+LatencyHistogram::LatencyHistogram() : counts(BUCKETS), total(0), largest(0), sum(0.0) {}
+
+/**
+ * @brief Maps a value to its bucket.
+ * 
+ * The top SUB_BUCKET_BITS + 1 bits of the value select the sub-bucket and the
+ * position of the highest set bit selects the power of two.
+ * 
+ * @param value Sample value.
+ * @return Bucket index.
+ */
+size_t LatencyHistogram::bucketOf(uint64_t value) {
+    if (value < LINEAR_LIMIT) {
+        return value;
+    }
+    unsigned shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+}
+
+/**
+ * @brief Retrieves the largest value that falls into a bucket.
+ * @param bucket Bucket index.
+ * @return Upper bound of the bucket.
+ */
+uint64_t LatencyHistogram::bucketLimit(size_t bucket) {
+    if (bucket < LINEAR_LIMIT) {
+        return bucket;
+    }
+    unsigned shift = bucket / SUB_BUCKETS - 1;
+    uint64_t low = (SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+    return low + ((uint64_t)1 << shift) - 1;
+}
+
+/**
+ * @brief Records a sample.
+ * @param value Sample value.
+ */
+void LatencyHistogram::record(uint64_t value) {
+    counts[bucketOf(value)]++;
+    total++;
+    largest = std::max(largest, value);
+    sum += (double)value;
+}
+
+/**
+ * @brief Adds every sample of another histogram to this one.
+ * @param other Histogram to merge in.
+ */
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+    for (size_t i = 0; i < BUCKETS; i++) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    largest = std::max(largest, other.largest);
+    sum += other.sum;
+}
+
+/**
+ * @brief Retrieves the number of samples.
+ * @return Sample count.
+ */
+size_t LatencyHistogram::count() const {
+    return total;
+}
+
+/**
+ * @brief Retrieves the mean of the samples.
+ * @return Mean, or 0 if there are none.
+ */
+double LatencyHistogram::mean() const {
+    return total == 0 ? 0.0 : sum / (double)total;
+}
+
+/**
+ * @brief Retrieves the largest sample.
+ * @return Largest sample, or 0 if there are none.
+ */
+uint64_t LatencyHistogram::max() const {
+    return largest;
+}
+
+/**
+ * @brief Retrieves a percentile of the samples.
+ * 
+ * Walks the buckets until the requested share of samples is covered and
+ * reports that bucket's upper bound, capped at the largest sample.
+ * 
+ * @param percent Percentile between 0 and 100.
+ * @return Upper bound of the bucket holding the percentile, or 0 if there are no samples.
+ */
+uint64_t LatencyHistogram::percentile(double percent) const {
+    if (total == 0) {
+        return 0;
+    }
+    size_t rank = (size_t)std::ceil(percent / 100.0 * (double)total);
+    rank = std::min(std::max(rank, (size_t)1), total);
+    size_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(bucketLimit(i), largest);
+        }
+    }
+    return largest;
+}
+
+/**
+ * @brief Summarizes the samples.
+ * @return Count, mean and tail percentiles.
+ */
+LatencySummary LatencyHistogram::summarize() const {
+    LatencySummary s;
+    s.count = total;
+    s.mean = mean();
+    s.p50 = percentile(50.0);
+    s.p90 = percentile(90.0);
+    s.p99 = percentile(99.0);
+    s.p999 = percentile(99.9);
+    s.max = largest;
+    return s;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+/**
+ * @file latency-histogram.h
+ * @brief Header file for the LatencyHistogram class.
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct LatencySummary
+ * @brief Count, mean and tail percentiles of a set of latencies, in ticks.
+ */
+struct LatencySummary {
+    size_t count = 0;   ///< Number of samples.
+    double mean = 0.0;  ///< Mean latency.
+    uint64_t p50 = 0;   ///< Median latency.
+    uint64_t p90 = 0;   ///< 90th percentile latency.
+    uint64_t p99 = 0;   ///< 99th percentile latency.
+    uint64_t p999 = 0;  ///< 99.9th percentile latency.
+    uint64_t max = 0;   ///< Largest latency.
+};
+
+/**
+ * @class LatencyHistogram
+ * @brief Log-linear histogram of latencies with bounded relative error.
+ *
+ * Values below 32 get a bucket each; above that, every power of two is split
+ * into 16 equal sub-buckets, so any recorded value is reported within about 6%
+ * of its true value. Recording is a count increment, and the whole range of
+ * 64-bit values fits in under a thousand buckets.
+ */
+class LatencyHistogram {
+private:
+    std::vector<uint64_t> counts;   ///< Samples per bucket.
+    size_t total;                   ///< Number of samples.
+    uint64_t largest;               ///< Largest sample.
+    double sum;                     ///< Sum of all samples.
+
+    /**
+     * @brief Maps a value to its bucket.
+     * @param value Sample value.
+     * @return Bucket index.
+     */
+    static size_t bucketOf(uint64_t value);
+
+    /**
+     * @brief Retrieves the largest value that falls into a bucket.
+     * @param bucket Bucket index.
+     * @return Upper bound of the bucket.
+     */
+    static uint64_t bucketLimit(size_t bucket);
+
+public:
+    /**
+     * @brief Constructs an empty histogram.
+     */
+    LatencyHistogram();
+
+    /**
+     * @brief Records a sample.
+     * @param value Sample value.
+     */
+    void record(uint64_t value);
+
+    /**
+     * @brief Adds every sample of another histogram to this one.
+     * @param other Histogram to merge in.
+     */
+    void merge(const LatencyHistogram &other);
+
+    /**
+     * @brief Retrieves the number of samples.
+     * @return Sample count.
+     */
+    size_t count() const;
+
+    /**
+     * @brief Retrieves the mean of the samples.
+     * @return Mean, or 0 if there are none.
+     */
+    double mean() const;
+
+    /**
+     * @brief Retrieves the largest sample.
+     * @return Largest sample, or 0 if there are none.
+     */
+    uint64_t max() const;
+
+    /**
+     * @brief Retrieves a percentile of the samples.
+     * @param percent Percentile between 0 and 100.
+     * @return Upper bound of the bucket holding the percentile, or 0 if there are no samples.
+     */
+    uint64_t percentile(double percent) const;
+
+    /**
+     * @brief Summarizes the samples.
+     * @return Count, mean and tail percentiles.
+     */
+    LatencySummary summarize() const;
+};
+
+#endif
\ No newline at end of file
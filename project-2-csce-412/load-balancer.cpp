@@ -7,153 +7,1635 @@
  */
 
 #include "load-balancer.h"
-#include <iostream>
-#include <cstdlib>   // for rand() value generation
-#include <ctime>     // for time() value
+#include <cstdint>   // for SIZE_MAX
+#include <algorithm> // for min() and max()
+#include <cmath>     // for ceil()
+#include "affinity-policy.h"
 using namespace std;
 
+namespace {
+
+const size_t AFFINITY_PROBES = 65536;   ///< Client keys sampled to measure remapping.
+const size_t OFFLINE_LOAD = (size_t)1 << 40;    ///< Load reported for servers marked down.
+const size_t ROUTE_RETRIES = 3;         ///< Picks tried before routing around a server marked down.
+
+} // namespace
+
+/**
+ * @brief Constructs a LoadBalancer with a specified number of servers and runtime.
+ * 
+ * Builds the server pool, seeds the default workload, and fills the initial request queue.
+ * 
+ * @param numServers The number of servers in the system.
+ * @param timeToRun The total simulation runtime (in ticks).
+ * @param seed Seed for the default workload's random streams.
+ * @param simMode How the simulation clock advances.
+ */
+LoadBalancer::LoadBalancer(size_t numServers, size_t timeToRun, uint64_t seed, SimulationMode simMode)
+    : LoadBalancer(numServers, timeToRun, Workload(RandomStreams::fromSeed(seed)), simMode) {}
+
+/**
+ * @brief Constructs a LoadBalancer whose traffic comes from the given workload.
+ * 
+ * @param numServers The number of servers in the system.
+ * @param timeToRun The total simulation runtime (in ticks).
+ * @param traffic Generator for the initial queue and later arrivals.
+ * @param simMode How the simulation clock advances.
+ */
+LoadBalancer::LoadBalancer(size_t numServers, size_t timeToRun, Workload traffic,
+                           SimulationMode simMode)
+    : LoadBalancer(numServers, timeToRun,
+                   unique_ptr<TrafficSource>(new Workload(move(traffic))), simMode) {}
+
+/**
+ * @brief Constructs a LoadBalancer whose traffic comes from any source, such as a trace.
+ * 
+ * @param numServers The number of servers in the system.
+ * @param timeToRun The total simulation runtime (in ticks).
+ * @param source Source of the initial queue and later arrivals.
+ * @param simMode How the simulation clock advances.
+ */
+LoadBalancer::LoadBalancer(size_t numServers, size_t timeToRun, unique_ptr<TrafficSource> source,
+                           SimulationMode simMode)
+    : servers(numServers), idle(numServers), traffic(move(source)), stepWaitSum(0),
+      stepStarts(0), ready(0), localQueued(0), runTime(timeToRun), currentTime(0),
+      completedRequests(0), serving(numServers),
+      retiring(0), serverTicks(0), mode(simMode), shardSpan(IdleSet::BLOCK), shards(1) {
+    layoutShards();
+    setLogSink(unique_ptr<LogSink>(new TextLogSink(LogLevel::Event)));
+
+    // Fill initial requests
+    initializeQueue(numServers);
+}
+
+/**
+ * @brief Replaces the log sink (by default, per-event text on stdout).
+ * @param sink New log sink.
+ */
+void LoadBalancer::setLogSink(unique_ptr<LogSink> sink) {
+    log = move(sink);
+    logEvents = log->getLevel() >= LogLevel::Event;
+    logSummary = log->getLevel() >= LogLevel::Summary;
+    connectShardLogs();
+}
+
+/**
+ * @brief Points each shard at the sink its events should go to.
+ * 
+ * A single shard writes straight to the log; several shards buffer their events
+ * so finishStep() can write them out in shard order.
+ */
+void LoadBalancer::connectShardLogs() {
+    for (Shard &shard : shards) {
+        shard.log = shards.size() > 1 ? &shard.buffer : log.get();
+    }
+}
+
+/**
+ * @brief Selects the kernel used to advance servers in the tick loop.
+ * @param kernel Tick kernel.
+ */
+void LoadBalancer::setTickKernel(TickKernel kernel) {
+    servers.setTickKernel(kernel);
+}
+
+/**
+ * @brief Changes how queued requests are scheduled (by default, FIFO).
+ * @param cfg Scheduling parameters.
+ */
+void LoadBalancer::setScheduler(const SchedulerConfig &cfg) {
+    for (Shard &shard : shards) {
+        shard.queue.configure(cfg);
+    }
+}
+
+/**
+ * @brief Splits the fleet into shards advanced by separate threads (by default, one).
+ * 
+ * Shards are contiguous ranges of servers aligned to IdleSet::BLOCK, so no two
+ * threads ever write the same word of the idle sets or the finished bitmask.
+ * Fleets smaller than a block per thread leave the later shards empty. Queued
+ * requests are spread over the new shards as if they had just arrived.
+ * 
+ * @param threads Number of threads. Call before run().
+ */
+void LoadBalancer::setThreads(size_t threads) {
+    threads = max(threads, (size_t)1);
+    vector<Request> queued;
+    for (Shard &shard : shards) {
+        vector<Request> slice = shard.queue.drain();
+        queued.insert(queued.end(), slice.begin(), slice.end());
+    }
+    SchedulerConfig cfg = shards[0].queue.getConfig();
+
+    shards.clear();
+    shards.resize(threads);
+    for (Shard &shard : shards) {
+        shard.queue.configure(cfg);
+    }
+    size_t perThread = (serving + threads - 1) / threads;
+    shardSpan = max((perThread + IdleSet::BLOCK - 1) / IdleSet::BLOCK, (size_t)1) * IdleSet::BLOCK;
+    layoutShards();
+    connectShardLogs();
+    workers.reset(threads > 1 ? new WorkerPool(threads) : nullptr);
+    enqueue(queued.data(), queued.size());
+}
+
+/**
+ * @brief Recomputes each shard's server range after the pool changes size.
+ */
+void LoadBalancer::layoutShards() {
+    size_t n = servers.size();
+    for (size_t k = 0; k < shards.size(); k++) {
+        shards[k].begin = min(k * shardSpan, n);
+        shards[k].end = k + 1 == shards.size() ? n : min((k + 1) * shardSpan, n);
+    }
+}
+
+/**
+ * @brief Counts the servers of a shard that take new work.
+ * @param shard Shard.
+ * @return Servers in service in the shard.
+ */
+size_t LoadBalancer::servingIn(const Shard &shard) const {
+    return serving > shard.begin ? min(serving, shard.end) - shard.begin : 0;
+}
+
+/**
+ * @brief Counts the servers of a shard that can take new work right now.
+ * @param shard Shard.
+ * @return Servers in service in the shard that are neither down nor marked down.
+ */
+size_t LoadBalancer::availableIn(const Shard &shard) const {
+    size_t available = servingIn(shard);
+    if (!offline.empty()) {
+        for (size_t i = shard.begin; i < min(serving, shard.end); i++) {
+            available -= offline[i];
+        }
+    }
+    return available;
+}
+
+/**
+ * @brief Shared-queue mode: moves requests off shards with no servers available.
+ * 
+ * Shrinking the fleet can take every server of a shard out of service, and
+ * failures can take them all down; its queue would then never drain, so it is
+ * spread over the other shards.
+ */
+void LoadBalancer::rebalanceShards() {
+    vector<Request> moved;
+    for (Shard &shard : shards) {
+        if (availableIn(shard) == 0 && !shard.queue.empty()) {
+            vector<Request> slice = shard.queue.drain();
+            moved.insert(moved.end(), slice.begin(), slice.end());
+        }
+    }
+    if (!moved.empty()) {
+        enqueue(moved.data(), moved.size());
+    }
+}
+
+/**
+ * @brief Turns on autoscaling of the fleet (off by default).
+ * @param cfg Autoscaling parameters. A maxServers of 0 means ten times the current fleet.
+ */
+void LoadBalancer::setAutoscaler(AutoscalerConfig cfg) {
+    if (cfg.maxServers == 0) {
+        cfg.maxServers = max(serving, (size_t)1) * 10;
+    }
+    autoscaler = Autoscaler(cfg);
+}
+
+/**
+ * @brief Turns on per-source rate limiting of arrivals (off by default).
+ * 
+ * Requests already in the shared queue are screened straight away, as if they
+ * had all arrived at the current tick.
+ * 
+ * @param cfg Rate limit parameters. Call before setRoutingPolicy() and run().
+ */
+void LoadBalancer::setRateLimit(const RateLimitConfig &cfg) {
+    limiter = RateLimiter(cfg);
+    if (!limiter.isEnabled()) {
+        return;
+    }
+    for (Shard &shard : shards) {
+        vector<Request> queued = shard.queue.drain();
+        size_t kept = limiter.filter(queued.data(), queued.size(), currentTime);
+        shard.queue.reserve(kept);
+        for (size_t i = 0; i < kept; i++) {
+            shard.queue.push(queued[i]);
+        }
+    }
+}
+
+/**
+ * @brief Measures arrivals against a latency budget and sheds those that would exceed it
+ *        (by default, everything is admitted).
+ * 
+ * Requests already in the shared queue are screened straight away, as if they
+ * had all arrived at the current tick into an empty queue.
+ * 
+ * @param cfg Admission parameters. Call before setRoutingPolicy() and run().
+ */
+void LoadBalancer::setAdmission(const AdmissionConfig &cfg) {
+    admission = AdmissionControl(cfg);
+    if (!admission.isEnabled()) {
+        return;
+    }
+    size_t admitted = 0;
+    for (Shard &shard : shards) {
+        vector<Request> queued = shard.queue.drain();
+        size_t kept = admission.filter(queued.data(), queued.size(), admitted, serving);
+        shard.queue.reserve(kept);
+        for (size_t i = 0; i < kept; i++) {
+            shard.queue.push(queued[i]);
+        }
+        admitted += kept;
+    }
+}
+
+/**
+ * @brief Screens arriving requests with a firewall (by default, everything is let in).
+ * 
+ * Requests already in the shared queue are screened straight away, as if they
+ * had passed through it on arrival.
+ * 
+ * @param fw Firewall, or nullptr for none. Call before setRoutingPolicy() and run().
+ */
+void LoadBalancer::setFirewall(unique_ptr<Firewall> fw) {
+    firewall = move(fw);
+    if (!firewall) {
+        return;
+    }
+    for (Shard &shard : shards) {
+        vector<Request> queued = shard.queue.drain();
+        size_t kept = firewall->filter(queued.data(), queued.size());
+        shard.queue.reserve(kept);
+        for (size_t i = 0; i < kept; i++) {
+            shard.queue.push(queued[i]);
+        }
+    }
+}
+
+/**
+ * @brief Builds the fleet from server classes of different speeds and slot counts
+ *        (by default, every server has speed 1 and one slot).
+ * 
+ * The classes take consecutive ranges of the pool, one entry per slot, in the
+ * order given. Not for use with the autoscaler, which adds uniform servers.
+ * 
+ * @param classes Server classes; their slots must add up to the number of servers.
+ *        Call before setRoutingPolicy() and run().
+ */
+void LoadBalancer::setFleet(const vector<ServerClass> &classes) {
+    fleet = classes;
+    slotClass.assign(servers.size(), 0);
+    size_t index = 0;
+    for (size_t c = 0; c < fleet.size(); c++) {
+        for (size_t i = 0; i < fleet[c].count * fleet[c].slots && index < servers.size(); i++) {
+            slotClass[index] = (uint32_t)c;
+            servers.setSpeed(index, fleet[c].speed);
+            index++;
+        }
+    }
+}
+
+/**
+ * @brief Injects server crashes, rack outages and slowdowns, and health checks the
+ *        servers (by default, servers never fail).
+ * 
+ * Faults hit whole servers, all slots of a multi-slot server at once. Not for use
+ * with the autoscaler, which changes the fleet the faults are drawn for.
+ * 
+ * @param cfg Fault parameters; nothing is injected unless some MTBF is set.
+ * @param checks Health check parameters.
+ * @param seed Seed for the fault times. Call after setFleet() and before run().
+ */
+void LoadBalancer::setFailures(const FailureConfig &cfg, const HealthCheckConfig &checks,
+                               uint64_t seed) {
+    failures.reset();
+    offline.clear();
+    if (!cfg.enabled()) {
+        return;
+    }
+    failures.reset(new FailureModel(cfg, RandomStreams::extraStream(seed, FailureModel::STREAM)));
+    // Pool entries of each server: its slots for a fleet, else one
+    vector<size_t> slots;
+    for (const ServerClass &c : fleet) {
+        slots.insert(slots.end(), c.count, c.slots);
+    }
+    if (fleet.empty()) {
+        slots.assign(servers.size(), 1);
+    }
+    failures->start(slots, currentTime);
+    health = HealthChecker(checks);
+    health.resize(servers.size());
+    offline.assign(servers.size(), 0);
+    stranded.assign(servers.size(), Request());
+    hasStranded.assign(servers.size(), 0);
+}
+
+/**
+ * @brief Gives each server its own queue and routes requests to them.
+ * 
+ * Requests already in the shared queue are routed in arrival order. Requests need
+ * a server to go to, so with no servers the shared queue is kept.
+ * 
+ * @param policy Routing policy, or nullptr to keep the shared queue. Call before run().
+ */
+void LoadBalancer::setRoutingPolicy(unique_ptr<RoutingPolicy> policy) {
+    router = move(policy);
+    if (serving == 0) {
+        router.reset();     // nowhere to route to
+    }
+    if (!router) {
+        return;
+    }
+    sizeRoutingState();
+    router->resize(serving);
+    if (!fleet.empty()) {
+        for (size_t i = 0; i < serving; i++) {
+            router->setSpeed(i, servers.getSpeed(i));
+        }
+    }
+    for (size_t i = 0; i < serving; i++) {
+        reportLoad(i);
+    }
+    if (router->isAffine()) {
+        probeAffinity(0);
+    }
+    for (Shard &shard : shards) {
+        for (const Request &r : shard.queue.drain()) {
+            route(r);
+        }
+    }
+}
+
+/**
+ * @brief Makes the per-server routing state cover the whole pool.
+ */
+void LoadBalancer::sizeRoutingState() {
+    localQueues.resize(servers.size());
+    outstanding.resize(servers.size(), 0);
+    outstandingWork.resize(servers.size(), 0);
+    routedCount.resize(servers.size(), 0);
+    ready.resize(servers.size());
+}
+
+/**
+ * @brief Records where the probe keys land, and how many moved since the last call.
+ * 
+ * The probes are fixed pseudo-random source addresses, so the share that moves
+ * estimates the share of all clients that lose their server. With n servers
+ * before and m after, consistent hashing should move about |n - m| / max(n, m).
+ * 
+ * @param from Servers in service before the change, or 0 for the first call.
+ */
+void LoadBalancer::probeAffinity(size_t from) {
+    size_t moved = 0;
+    probeOwners.resize(AFFINITY_PROBES);
+    for (size_t i = 0; i < AFFINITY_PROBES; i++) {
+        Request probe((uint32_t)mixHash(i), 0, 1, JobType::Standard);
+        uint32_t owner = (uint32_t)router->pick(probe);
+        moved += owner != probeOwners[i];
+        probeOwners[i] = owner;
+    }
+    if (from > 0) {
+        remaps.push_back({currentTime, from, serving, moved, AFFINITY_PROBES});
+    }
+}
+
+/**
+ * @brief Initializes the request queue with a predefined number of requests.
+ * 
+ * The traffic source decides how many: (numServers * 20) random requests for a
+ * generated workload, or the records stamped at tick 0 for a replayed trace.
+ * 
+ * @param numServers The number of servers in the system.
+ */
+void LoadBalancer::initializeQueue(size_t numServers) {
+    size_t initialRequests = traffic->initialRequests(numServers);
+    shards[0].queue.reserve(initialRequests);
+
+    Request batch[TrafficSource::BATCH];
+    for (size_t done = 0; done < initialRequests; done += TrafficSource::BATCH) {
+        size_t n = min(TrafficSource::BATCH, initialRequests - done);
+        traffic->generate(batch, n);
+        if (firewall) {
+            n = firewall->filter(batch, n);
+        }
+        n = limiter.filter(batch, n, currentTime);
+        n = admission.filter(batch, n, getQueueSize(), serving);
+        for (size_t i = 0; i < n; i++) {
+            batch[i].setArrivalTime(currentTime);
+        }
+        enqueue(batch, n);
+    }
+}
+
+/**
+ * @brief Generates a burst of new requests and queues them.
+ */
+void LoadBalancer::generateArrivals() {
+    Request batch[TrafficSource::BATCH];
+    size_t howMany = traffic->burstSize();
+    for (size_t done = 0; done < howMany; done += TrafficSource::BATCH) {
+        size_t n = min(TrafficSource::BATCH, howMany - done);
+        traffic->generate(batch, n);
+        if (firewall) {
+            n = firewall->filter(batch, n);
+        }
+        n = limiter.filter(batch, n, currentTime);
+        n = admission.filter(batch, n, getQueueSize(), serving);
+        for (size_t i = 0; i < n; i++) {
+            batch[i].setArrivalTime(currentTime);
+            if (logEvents) {
+                log->requestArrived(batch[i]);
+            }
+        }
+        enqueue(batch, n);
+    }
+}
+
+/**
+ * @brief Queues new requests centrally or routes them to server queues.
+ * 
+ * With several shards, each request joins the queue of the shard with the least
+ * backlog per server in service (queued requests minus idle servers), ties
+ * going to the lower shard. That needs no random draws, so results stay the
+ * same for a given seed and thread count.
+ * 
+ * @param rs Requests, with arrival times set.
+ * @param n Number of requests.
+ */
+void LoadBalancer::enqueue(const Request *rs, size_t n) {
+    if (router) {
+        for (size_t i = 0; i < n; i++) {
+            route(rs[i]);
+        }
+        return;
+    }
+    if (shards.size() == 1) {
+        shards[0].queue.push(rs, n);
+        return;
+    }
+
+    vector<long long> backlog(shards.size());
+    vector<long long> capacity(shards.size());
+    for (size_t k = 0; k < shards.size(); k++) {
+        capacity[k] = (long long)availableIn(shards[k]);
+        backlog[k] = (long long)shards[k].queue.size() -
+                     (long long)idle.count(shards[k].begin, shards[k].end);
+    }
+    for (size_t i = 0; i < n; i++) {
+        size_t best = 0;
+        bool found = false;
+        for (size_t k = 0; k < shards.size(); k++) {
+            if (capacity[k] > 0 &&
+                (!found || backlog[k] * capacity[best] < backlog[best] * capacity[k])) {
+                best = k;
+                found = true;
+            }
+        }
+        shards[best].queue.push(rs[i]);
+        backlog[best]++;
+    }
+}
+
+/**
+ * @brief Sends a request to the local queue of the server the routing policy picks.
+ * 
+ * An idle server that receives work becomes ready and starts it on the next dispatch.
+ * Servers marked down report a huge load, which load-aware policies steer clear
+ * of; if the policy still picks one, it gets a few more tries and then the next
+ * server up in index order takes the request. A server that is down but not yet
+ * detected still gets traffic, which piles up in its queue until the health
+ * checks catch it.
+ * 
+ * @param r Request to route.
+ */
+void LoadBalancer::route(const Request &r) {
+    size_t index = router->pick(r);
+    for (size_t tries = 0; tries < ROUTE_RETRIES && isMarkedDown(index); tries++) {
+        index = router->pick(r);
+    }
+    if (isMarkedDown(index)) {
+        // With every server marked down, the request stays where the policy put it
+        size_t picked = index;
+        for (size_t k = 1; k < serving; k++) {
+            if (!isMarkedDown((picked + k) % serving)) {
+                index = (picked + k) % serving;
+                break;
+            }
+        }
+    }
+    localQueues[index].push(r);
+    localQueued++;
+    routedCount[index]++;
+    adjustLoad(index, r, true);
+    if (!servers.isBusy(index) && !isOffline(index)) {
+        ready.insert(index);
+    }
+}
+
+/**
+ * @brief Adds or removes a request from a server's outstanding load.
+ * @param index Server index.
+ * @param r Request being added or removed.
+ * @param add True to add, false to remove.
+ */
+void LoadBalancer::adjustLoad(size_t index, const Request &r, bool add) {
+    if (add) {
+        outstanding[index]++;
+        outstandingWork[index] += r.getDuration();
+    } else {
+        outstanding[index]--;
+        outstandingWork[index] -= r.getDuration();
+    }
+    reportLoad(index);
+}
+
+/**
+ * @brief Tells the routing policy a server's outstanding load.
+ * 
+ * A server marked down reports OFFLINE_LOAD instead, so load-aware policies
+ * route around it without knowing about health checks.
+ * 
+ * @param index Server index.
+ */
+void LoadBalancer::reportLoad(size_t index) {
+    if (isMarkedDown(index)) {
+        router->update(index, OFFLINE_LOAD, OFFLINE_LOAD);
+    } else {
+        router->update(index, outstanding[index], outstandingWork[index]);
+    }
+}
+
+/**
+ * @brief Checks whether a server can take new work.
+ * @param index Server index.
+ * @return True if it is down or marked down by the health checks.
+ */
+bool LoadBalancer::isOffline(size_t index) const {
+    return !offline.empty() && offline[index];
+}
+
+/**
+ * @brief Checks whether the health checks have taken a server out of rotation.
+ * @param index Server index.
+ * @return True if it should get no traffic.
+ */
+bool LoadBalancer::isMarkedDown(size_t index) const {
+    return failures && health.isMarkedDown(index);
+}
+
+/**
+ * @brief Takes the next request a server should run, from its local queue or its shard's.
+ * @param shard Shard the server belongs to.
+ * @param index Server index.
+ * @param next Request to run.
+ * @return True if there was one.
+ */
+bool LoadBalancer::takeWork(Shard &shard, size_t index, Request &next) {
+    if (!router) {
+        if (shard.queue.empty()) {
+            return false;
+        }
+        next = shard.queue.pop(currentTime);
+        return true;
+    }
+    RequestQueue &queue = localQueues[index];
+    if (queue.empty()) {
+        return false;
+    }
+    next = queue.front();
+    queue.pop();
+    shard.dequeued++;
+    return true;
+}
+
+/**
+ * @brief Checks whether an idle server could start a request right now.
+ * @return True if dispatch has work to hand out beyond finished servers.
+ */
+bool LoadBalancer::workWaiting() const {
+    if (router) {
+        return !ready.empty();
+    }
+    for (const Shard &shard : shards) {
+        if (!shard.queue.empty() && idle.next(shard.begin) < shard.end) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Finds the next server of a shard, at or after an index, that can start a waiting request.
+ * @param shard Shard to search.
+ * @param from First index to consider.
+ * @return Server index, or IdleSet::NONE.
+ */
+size_t LoadBalancer::nextReady(const Shard &shard, size_t from) const {
+    size_t index;
+    if (router) {
+        index = ready.next(from);
+    } else {
+        index = shard.queue.empty() ? IdleSet::NONE : idle.next(from);
+    }
+    return index < shard.end ? index : IdleSet::NONE;
+}
+
+/**
+ * @brief Hands a request to a server and records when it started.
+ * @param shard Shard the server belongs to.
+ * @param index Server index.
+ * @param r Request to start.
+ */
+void LoadBalancer::startRequest(Shard &shard, size_t index, const Request &r) {
+    servers.setRequest(index, r);
+    servers.setStartTime(index, currentTime);
+    shard.metrics.requestStarted(r, currentTime);
+    shard.waitSum += currentTime - r.getArrivalTime();
+    shard.started++;
+    if (!fleet.empty()) {
+        shard.classMetrics[slotClass[index]].requestStarted(r, currentTime);
+    }
+}
+
+/**
+ * @brief Finishes and/or assigns work to a single server for the current tick.
+ * 
+ * A server whose request just finished is cleared and immediately handed the next
+ * queued request; an idle server picks up the next queued request if there is one.
+ * The routing policy only hears about the lighter load in finishStep(), as it is
+ * shared by every shard; nothing is routed in between.
+ * 
+ * @param shard Shard the server belongs to.
+ * @param index Index of the server to process.
+ */
+void LoadBalancer::processServer(Shard &shard, size_t index) {
+    Server srv(servers, index);
+    Request next;
+    if (srv.hasRequestFinished()) {
+        const Request &done = srv.getCurrentRequest();
+        if (logEvents) {
+            shard.log->requestFinished(index, done);
+        }
+        if (router) {
+            outstanding[index]--;
+            outstandingWork[index] -= done.getDuration();
+            shard.changed.push_back(index);
+        }
+        shard.metrics.requestFinished(done, servers.getStartTime(index), currentTime);
+        if (!fleet.empty()) {
+            shard.classMetrics[slotClass[index]].requestFinished(done, servers.getStartTime(index),
+                                                                 currentTime);
+        }
+        srv.clearCurrentRequest();
+        shard.completed++;
+
+        // Servers past serving are draining and take no new work, nor do servers marked down
+        if (index < serving && !isOffline(index) && takeWork(shard, index, next)) {
+            startRequest(shard, index, next);
+            if (logEvents) {
+                shard.log->requestStarted(index, next, false);
+            }
+        }
+    } else if (!srv.isBusy() && takeWork(shard, index, next)) {
+        startRequest(shard, index, next);
+        if (logEvents) {
+            shard.log->requestStarted(index, next, true);
+        }
+    }
+}
+
+/**
+ * @brief Runs the main simulation loop.
+ * 
+ * Dispatches to the tick-by-tick or event-driven engine. Both produce identical
+ * output for the same random seed.
+ */
+void LoadBalancer::run() {
+    classMetrics.assign(fleet.size(), Metrics());
+    for (Shard &shard : shards) {
+        shard.classMetrics.assign(fleet.size(), Metrics());
+        if (admission.isEnabled()) {
+            shard.metrics.setDeadline((size_t)admission.getConfig().budget);
+            for (Metrics &m : shard.classMetrics) {
+                m.setDeadline((size_t)admission.getConfig().budget);
+            }
+        }
+    }
+    if (mode == SimulationMode::Event) {
+        runEvents();
+    } else {
+        runTicks();
+    }
+    for (Shard &shard : shards) {
+        metrics.merge(shard.metrics);
+        shard.metrics = Metrics();
+        for (size_t c = 0; c < fleet.size(); c++) {
+            classMetrics[c].merge(shard.classMetrics[c]);
+        }
+        shard.classMetrics.clear();
+    }
+}
+
+/**
+ * @brief Hands out work to a shard's servers that finished on this tick (shard.due)
+ *        and to its idle servers.
+ * 
+ * Finished servers and idle servers are merged in index order, which is the order
+ * a full sweep over the shard would visit them in. Idle servers are only visited
+ * while the queue has work, so the cost is proportional to completions plus
+ * assignments. Servers left without work join the idle set.
+ * 
+ * @param shard Shard to dispatch.
+ */
+void LoadBalancer::dispatch(Shard &shard) {
+    const vector<size_t> &finished = shard.due;
+    size_t d = 0;
+    size_t nextIdle = nextReady(shard, shard.begin);
+    while (d < finished.size() || nextIdle != IdleSet::NONE) {
+        bool queued = router || !shard.queue.empty();
+        size_t index;
+        if (nextIdle != IdleSet::NONE && queued &&
+            (d == finished.size() || nextIdle < finished[d])) {
+            index = nextIdle;
+            nextIdle = nextReady(shard, index + 1);
+        } else if (d < finished.size()) {
+            index = finished[d++];
+        } else {
+            break;
+        }
+
+        processServer(shard, index);
+        if (servers.isBusy(index)) {
+            idle.erase(index);
+            if (router) {
+                ready.erase(index);
+            }
+            if (mode == SimulationMode::Event) {
+                shard.completions.insert(currentTime + servers.getRemaining(index), index);
+            }
+        } else if (index >= serving) {
+            shard.retired++;
+        } else if (!isOffline(index)) {
+            idle.insert(index);
+        }
+    }
+}
+
+/**
+ * @brief Tick engine: advances a shard's servers by one tick and dispatches it.
+ * @param shard Shard to advance.
+ */
+void LoadBalancer::tickShard(Shard &shard) {
+    shard.due.clear();
+    if (servers.tick(shard.begin, shard.end) > 0) {
+        const vector<uint64_t> &finished = servers.getFinished();
+        for (size_t w = shard.begin / 64; w < (shard.end + 63) / 64; w++) {
+            for (uint64_t bits = finished[w]; bits != 0; bits &= bits - 1) {
+                shard.due.push_back(w * 64 + __builtin_ctzll(bits));
+            }
+        }
+    }
+    dispatch(shard);
+}
+
+/**
+ * @brief Event engine: completes a shard's requests due on this tick and dispatches it.
+ * @param shard Shard to advance.
+ */
+void LoadBalancer::completeShard(Shard &shard) {
+    shard.due.clear();
+    shard.completions.advance(currentTime, shard.due);
+    if (failures) {
+        // A crash aborts a request but leaves its completion in the wheel; skip those,
+        // and duplicates from a server that restarted work finishing on the same tick
+        size_t kept = 0;
+        for (size_t index : shard.due) {
+            if (servers.isBusy(index) &&
+                servers.getStartTime(index) + servers.getRemaining(index) == currentTime) {
+                shard.due[kept++] = index;
+            }
+        }
+        shard.due.resize(kept);
+    }
+    for (size_t index : shard.due) {
+        servers.advance(index, servers.getRemaining(index));
+    }
+    sort(shard.due.begin(), shard.due.end());
+    if (failures) {
+        shard.due.erase(unique(shard.due.begin(), shard.due.end()), shard.due.end());
+    }
+
+    // Visit finished and idle servers in index order, as runTicks() would
+    dispatch(shard);
+}
+
+/**
+ * @brief Runs a step on every shard, in parallel when there are several.
+ * @param step Member function to run.
+ */
+void LoadBalancer::forEachShard(void (LoadBalancer::*step)(Shard &)) {
+    if (!workers) {
+        (this->*step)(shards[0]);
+        return;
+    }
+    workers->run([this, step](size_t k) { (this->*step)(shards[k]); });
+}
+
 /**
- * @brief Constructs a LoadBalancer with a specified number of servers and runtime.
+ * @brief Folds what the shards did on this tick back into the load balancer.
+ * 
+ * Shards are visited in order, so logged events come out sorted by server just
+ * as a single thread would write them, and the routing policy sees the same
+ * updates whatever the thread count.
+ */
+void LoadBalancer::finishStep() {
+    for (Shard &shard : shards) {
+        completedRequests += shard.completed;
+        localQueued -= shard.dequeued;
+        retiring -= shard.retired;
+        stepWaitSum += shard.waitSum;
+        stepStarts += shard.started;
+        shard.completed = 0;
+        shard.dequeued = 0;
+        shard.retired = 0;
+        shard.waitSum = 0;
+        shard.started = 0;
+        for (size_t index : shard.changed) {
+            reportLoad(index);
+        }
+        shard.changed.clear();
+        if (logEvents && shard.log != log.get()) {
+            shard.buffer.replay(*log);
+        }
+    }
+    if (servers.size() > serving) {
+        retireDrained();
+    }
+}
+
+/**
+ * @brief Retrieves the number of servers either in service or still draining.
+ * @return Fleet size.
+ */
+size_t LoadBalancer::fleetSize() const {
+    return serving + retiring;
+}
+
+/**
+ * @brief Asks the autoscaler for a fleet size and applies it.
+ */
+void LoadBalancer::scaleFleet() {
+    size_t target = autoscaler.evaluate(currentTime, serving, getQueueSize(), idle.size());
+    if (target != serving) {
+        if (logEvents) {
+            log->scaled(currentTime, serving, target, getQueueSize());
+        }
+        resizeFleet(target);
+    }
+}
+
+/**
+ * @brief Grows or shrinks the set of servers taking new work.
  * 
- * Initializes servers, seeds the random number generator, and fills the initial request queue.
+ * Servers always leave and rejoin service from the end of the index range. A
+ * server taken out of service while busy keeps its request and retires once it
+ * finishes; one brought back before then simply keeps going. New servers are
+ * added to the pool only once every draining server has been brought back.
+ * When routing, the local queues of servers leaving service are routed again;
+ * otherwise, so are the queues of shards left with no server in service.
  * 
- * @param numServers The number of servers in the system.
- * @param timeToRun The total simulation runtime (in ticks).
+ * @param target Servers that should take new work.
  */
-LoadBalancer::LoadBalancer(size_t numServers, size_t timeToRun) : runTime(timeToRun), currentTime(0) {
-    // Building servers
-    for (size_t i = 0; i < numServers; i++) {
-        servers.emplace_back("Server" + to_string(i));
+void LoadBalancer::resizeFleet(size_t target) {
+    size_t previous = serving;
+    vector<Request> displaced;
+    if (target > serving) {
+        size_t reused = min(target, servers.size());
+        for (size_t i = serving; i < reused; i++) {
+            if (servers.isBusy(i)) {
+                retiring--;
+            } else {
+                idle.insert(i);
+            }
+        }
+        if (target > servers.size()) {
+            size_t added = servers.size();
+            servers.resize(target);
+            idle.resize(target);
+            for (size_t i = added; i < target; i++) {
+                idle.insert(i);
+            }
+            layoutShards();
+        }
+        serving = target;
+    } else {
+        for (size_t i = target; i < serving; i++) {
+            if (servers.isBusy(i)) {
+                retiring++;
+            } else {
+                idle.erase(i);
+            }
+        }
+        serving = target;
     }
 
-    // Seed randomness for better variability
-    srand((unsigned)time(nullptr));
+    if (router) {
+        // Servers leaving service hand their backlog back to be routed again
+        sizeRoutingState();
+        for (size_t i = target; i < previous; i++) {
+            RequestQueue &queue = localQueues[i];
+            while (!queue.empty()) {
+                displaced.push_back(queue.front());
+                queue.pop();
+                localQueued--;
+                adjustLoad(i, displaced.back(), false);
+            }
+            ready.erase(i);
+        }
+        router->resize(serving);
+        for (size_t i = previous; i < serving; i++) {
+            reportLoad(i);
+        }
+        if (router->isAffine()) {
+            probeAffinity(previous);
+        }
+        for (const Request &r : displaced) {
+            route(r);
+        }
+    }
+    retireDrained();
+    if (!router) {
+        rebalanceShards();
+    }
+}
 
-    // Fill initial requests
-    initializeQueue(numServers);
+/**
+ * @brief Removes drained servers from the end of the pool.
+ * 
+ * Only the tail of the pool can be released, so a drained server below one that
+ * is still busy stays allocated (but out of service) until the busy one finishes.
+ */
+void LoadBalancer::retireDrained() {
+    size_t n = servers.size();
+    while (n > serving && !servers.isBusy(n - 1)) {
+        n--;
+    }
+    if (n < servers.size()) {
+        servers.resize(n);
+        idle.resize(n);
+        layoutShards();
+        if (router) {
+            sizeRoutingState();
+        }
+    }
 }
 
 /**
- * @brief Initializes the request queue with a predefined number of requests.
+ * @brief Applies the faults due on this tick and runs the health checks.
+ * 
+ * Also feeds the mean wait of the requests started this step to the fault
+ * model, which uses it to measure each failure's latency spike and recovery.
+ * Both engines call this on every tick where something can change, so the
+ * outcome does not depend on the engine.
+ */
+void LoadBalancer::applyFailures() {
+    if (stepStarts > 0) {
+        failures->observeWait(currentTime, (double)stepWaitSum / (double)stepStarts);
+    }
+    stepWaitSum = 0;
+    stepStarts = 0;
+
+    bool changed = false;
+    if (failures->nextTime() == currentTime) {
+        failureChanges.clear();
+        failures->advance(currentTime, failureChanges);
+        changed = !failureChanges.empty();
+        for (const FailureChange &change : failureChanges) {
+            size_t index = change.server;
+            double speed = fleet.empty() ? 1.0 : fleet[slotClass[index]].speed;
+            switch (change.what) {
+            case FailureChange::Down:
+                crashServer(index);
+                break;
+            case FailureChange::Up:
+                repairServer(index);
+                break;
+            case FailureChange::Slowed:
+                servers.setSpeed(index, speed * failures->getConfig().degradeSpeed);
+                health.watch(index);
+                break;
+            case FailureChange::Restored:
+                servers.setSpeed(index, speed);
+                break;
+            }
+        }
+    }
+
+    if (health.isProbeTick(currentTime)) {
+        markedDown.clear();
+        markedUp.clear();
+        health.probe([this](size_t index) {
+            // A probe is a unit of work at the server's class speed, so only a
+            // slowed server answers late, however slow its class is
+            double nominal = fleet.empty() ? 1.0 : fleet[slotClass[index]].speed;
+            return failures->isDown(index)
+                       ? SIZE_MAX
+                       : (size_t)ceil(nominal / servers.getSpeed(index));
+        }, markedDown, markedUp);
+        changed = changed || !markedDown.empty() || !markedUp.empty();
+        for (size_t index : markedDown) {
+            ejectServer(index);
+        }
+        for (size_t index : markedUp) {
+            restoreServer(index);
+        }
+    }
+
+    if (changed && !router && shards.size() > 1) {
+        rebalanceShards();
+    }
+}
+
+/**
+ * @brief Stops a crashed server, setting its request aside.
  * 
- * Generates (numServers * 20) requests with random IP addresses, durations, and job types.
+ * The request stays with the server until a health check notices the crash or
+ * the server is repaired, whichever comes first; only then can the load
+ * balancer know it will never finish.
  * 
- * @param numServers The number of servers in the system.
+ * @param index Server index.
  */
-void LoadBalancer::initializeQueue(size_t numServers) {
-    size_t initialRequests = numServers * 20;
-    for (size_t i = 0; i < initialRequests; i++) {
-        Request req(randomIP(), randomIP(), randomDuration(), randomJobType());
-        requestQueue.push(req);
+void LoadBalancer::crashServer(size_t index) {
+    offline[index] = 1;
+    idle.erase(index);
+    if (router) {
+        ready.erase(index);
+    }
+    if (servers.isBusy(index)) {
+        stranded[index] = servers.getRequest(index);
+        hasStranded[index] = 1;
+        servers.abortRequest(index);
+    }
+    health.watch(index);
+}
+
+/**
+ * @brief Lets a repaired server work again, unless it is still marked down.
+ * @param index Server index.
+ */
+void LoadBalancer::repairServer(size_t index) {
+    if (hasStranded[index]) {
+        resolveStranded(index);
+    }
+    offline[index] = health.isMarkedDown(index);
+    if (!offline[index]) {
+        makeAvailable(index);
     }
 }
 
 /**
- * @brief Generates a random IP address.
+ * @brief Takes a server the health checks marked down out of rotation.
+ * 
+ * A busy server that is only slow finishes its request first. When routing,
+ * its local queue is routed again to the servers still up.
  * 
- * @return A string representing a random IP address in the format "X.X.X.X".
+ * @param index Server index.
+ */
+void LoadBalancer::ejectServer(size_t index) {
+    failures->noteDetected(index, currentTime);
+    offline[index] = 1;
+    idle.erase(index);
+    if (hasStranded[index]) {
+        resolveStranded(index);
+    }
+    if (!router) {
+        return;
+    }
+    ready.erase(index);
+    reportLoad(index);
+    vector<Request> displaced;
+    RequestQueue &queue = localQueues[index];
+    while (!queue.empty()) {
+        displaced.push_back(queue.front());
+        queue.pop();
+        localQueued--;
+        adjustLoad(index, displaced.back(), false);
+    }
+    for (const Request &r : displaced) {
+        route(r);
+    }
+}
+
+/**
+ * @brief Puts a server the health checks marked up back into rotation.
+ * @param index Server index.
  */
-string LoadBalancer::randomIP() const {
-    return to_string(1 + rand() % 255) + "." +
-           to_string(1 + rand() % 255) + "." +
-           to_string(1 + rand() % 255) + "." +
-           to_string(1 + rand() % 255);
+void LoadBalancer::restoreServer(size_t index) {
+    offline[index] = failures->isDown(index);
+    if (router) {
+        reportLoad(index);
+    }
+    if (!offline[index]) {
+        makeAvailable(index);
+    }
 }
 
 /**
- * @brief Generates a random job type.
+ * @brief Returns a server that can work again to the idle and ready sets.
  * 
- * @return A character representing the job type ('S' for Standard or 'P' for Priority).
+ * A slowed server marked up while still busy rejoins them when it finishes.
+ * 
+ * @param index Server index.
  */
-char LoadBalancer::randomJobType() const {
-    return (rand() % 2 == 0) ? 'S' : 'P';
+void LoadBalancer::makeAvailable(size_t index) {
+    if (servers.isBusy(index) || index >= serving) {
+        return;
+    }
+    idle.insert(index);
+    if (router && !localQueues[index].empty()) {
+        ready.insert(index);
+    }
 }
 
 /**
- * @brief Generates a random duration for a request.
+ * @brief Queues again or drops the request a crash cut short, by the failure policy.
+ * 
+ * A requeued request keeps its arrival time, so the time lost to the crash
+ * shows up in its wait; the wait statistics count it once per start.
  * 
- * @return A size_t representing the duration (between 3 and 16 ticks).
+ * @param index Server it was running on.
  */
-size_t LoadBalancer::randomDuration() const {
-    return 3 + (rand() % 14);
+void LoadBalancer::resolveStranded(size_t index) {
+    Request r = stranded[index];
+    hasStranded[index] = 0;
+    if (router) {
+        adjustLoad(index, r, false);
+    }
+    bool requeue = failures->getConfig().inFlight == FailurePolicy::Requeue;
+    failures->noteDisplaced(index, requeue);
+    if (requeue) {
+        enqueue(&r, 1);
+    }
 }
 
 /**
- * @brief Runs the main simulation loop.
+ * @brief Runs the simulation one tick at a time.
  * 
  * Processes requests by updating servers, handling completed requests, and assigning new ones.
  * The simulation ends when either the runtime limit is reached or all requests are processed.
  */
-void LoadBalancer::run() {
+void LoadBalancer::runTicks() {
+    size_t nextArrival = traffic->nextArrivalTime(1, max(runTime, (size_t)1));
+
     while (true) {
         currentTime++;
-        cout << "[Time= " << currentTime << "]\n";
+        serverTicks += fleetSize();
+        if (logEvents) {
+            log->tick(currentTime);
+        }
 
-        // Let each server handle its current request for 1 tick
-        for (auto &srv : servers) {
-            srv.handleRequest();
+        // Let each server handle its current request for 1 tick, then check for
+        // finished requests and assign new ones if available
+        forEachShard(&LoadBalancer::tickShard);
+        finishStep();
+
+        // Add random extra requests to the queue
+        if (currentTime == nextArrival) {
+            generateArrivals();
+            nextArrival = traffic->nextArrivalTime(currentTime + 1, runTime);
         }
 
-        // Check for finished requests and assign new ones if available
-        for (auto &srv : servers) {
-            if (srv.hasRequestFinished()) {
-                cout << srv.getName() << " finished: " 
-                     << srv.getCurrentRequest() << "\n";
-                srv.clearCurrentRequest();
+        // Grow or shrink the fleet
+        if (autoscaler.isEvaluationTick(currentTime)) {
+            scaleFleet();
+        }
 
-                if (!requestQueue.empty()) {
-                    Request next = requestQueue.front();
-                    requestQueue.pop();
-                    srv.setRequest(next);
-                    cout << srv.getName() << " started: " << next << "\n";
-                }
-            } else if (!srv.isBusy() && !requestQueue.empty()) {
-                Request next = requestQueue.front();
-                requestQueue.pop();
-                srv.setRequest(next);
-                cout << srv.getName() << " started: " << next << " \n";
+        // Crash, repair and health check servers
+        if (failures) {
+            applyFailures();
+        }
+
+        // Stop if runtime limit is reached
+        if (currentTime >= runTime) {
+            if (logSummary) {
+                log->stopped(runTime);
             }
+            break;
         }
 
-        // Add random extra requests to the queue
-        if (rand() % 20 == 0) {
-            int howMany = 1 + (rand() % 3);
-            for (int i = 0; i < howMany; i++) {
-                Request r(randomIP(), randomIP(), randomDuration(), randomJobType());
-                requestQueue.push(r);
-                cout << "new request arrives: " << r << "\n";
+        // Debugging: Count active and idle servers
+        if (logEvents) {
+            log->status(fleetSize(), fleetSize() - idle.size(), idle.size());
+        }
+    }
+}
+
+/**
+ * @brief Runs the simulation by jumping between completion and arrival events.
+ * 
+ * Completions live in a timing wheel keyed on finish time, so a tick only touches
+ * servers that finish on it or can take queued work. Ticks on which nothing
+ * happens still print their header and status lines, which keeps the output
+ * identical to runTicks() for the same seed.
+ */
+void LoadBalancer::runEvents() {
+    size_t stopTime = max(runTime, (size_t)1);
+    size_t nextArrival = traffic->nextArrivalTime(1, stopTime);
+
+    while (true) {
+        // Jump to the next tick on which something can change
+        size_t next = stopTime;
+        for (const Shard &shard : shards) {
+            next = min(next, shard.completions.nextTime());
+        }
+        next = min(next, nextArrival);
+        next = min(next, autoscaler.nextEvaluation(currentTime));
+        if (failures) {
+            next = min(next, failures->nextTime());
+            next = min(next, health.nextProbe(currentTime));
+        }
+        if (workWaiting()) {
+            next = min(next, currentTime + 1);
+        }
+
+        // Quiet ticks: nothing changes, so only the log lines are emitted
+        if (logEvents) {
+            size_t activeServers = fleetSize() - idle.size();
+            for (size_t t = currentTime + 1; t < next; t++) {
+                log->tick(t);
+                log->status(fleetSize(), activeServers, idle.size());
             }
         }
+        serverTicks += (next - currentTime) * fleetSize();
+        currentTime = next;
+        if (logEvents) {
+            log->tick(currentTime);
+        }
+
+        // Complete the requests finishing on this tick and hand out work
+        forEachShard(&LoadBalancer::completeShard);
+        finishStep();
+
+        // Add random extra requests to the queue
+        if (currentTime == nextArrival) {
+            generateArrivals();
+            nextArrival = traffic->nextArrivalTime(currentTime + 1, stopTime);
+        }
+
+        // Grow or shrink the fleet
+        if (autoscaler.isEvaluationTick(currentTime)) {
+            scaleFleet();
+        }
+
+        // Crash, repair and health check servers
+        if (failures) {
+            applyFailures();
+        }
 
         // Stop if runtime limit is reached
         if (currentTime >= runTime) {
-            cout << "Reached max runtime (" << runTime << "). Stopping. \n";
+            if (logSummary) {
+                log->stopped(runTime);
+            }
             break;
         }
 
-        // Debugging: Count active and idle servers
-        size_t activeServers = 0;
-        size_t idleServers = 0;
+        if (logEvents) {
+            log->status(fleetSize(), fleetSize() - idle.size(), idle.size());
+        }
+    }
+}
 
-        for (const auto &srv : servers) {
-            if (srv.isBusy()) {
-                activeServers++;
-            } else {
-                idleServers++;
-            }
+/**
+ * @brief Retrieves the current simulation time.
+ * @return Current simulation time.
+ */
+size_t LoadBalancer::getCurrentTime() const {
+    return currentTime;
+}
+
+/**
+ * @brief Retrieves the number of requests servers have finished.
+ * @return Completed request count.
+ */
+size_t LoadBalancer::getCompletedRequests() const {
+    return completedRequests;
+}
+
+/**
+ * @brief Retrieves the number of requests waiting in the queue.
+ * @return Queue length.
+ */
+size_t LoadBalancer::getQueueSize() const {
+    if (router) {
+        return localQueued;
+    }
+    size_t queued = 0;
+    for (const Shard &shard : shards) {
+        queued += shard.queue.size();
+    }
+    return queued;
+}
+
+/**
+ * @brief Retrieves the number of servers taking new work.
+ * @return Servers in service.
+ */
+size_t LoadBalancer::getServerCount() const {
+    return serving;
+}
+
+/**
+ * @brief Retrieves the number of server-ticks used so far, a measure of fleet cost.
+ * @return Sum of the fleet size over every tick.
+ */
+size_t LoadBalancer::getServerTicks() const {
+    return serverTicks;
+}
+
+/**
+ * @brief Retrieves the share of server-ticks spent processing requests.
+ * 
+ * Busy time is the service time of every finished request plus the time the
+ * requests still running have had so far.
+ * 
+ * @return Utilization between 0 and 1, once run() has returned.
+ */
+double LoadBalancer::getUtilization() const {
+    if (serverTicks == 0) {
+        return 0.0;
+    }
+    double busy = 0.0;
+    for (size_t c = 0; c < Scheduler::CLASSES; c++) {
+        const LatencyHistogram &service = metrics.get(Metrics::SERVICE, c);
+        busy += service.mean() * (double)service.count();
+    }
+    for (size_t i = 0; i < servers.size(); i++) {
+        if (servers.isBusy(i)) {
+            busy += (double)(currentTime - servers.getStartTime(i));
+        }
+    }
+    return busy / (double)serverTicks;
+}
+
+/**
+ * @brief Retrieves the autoscaler, e.g. for its scaling events.
+ * @return Autoscaler.
+ */
+const Autoscaler& LoadBalancer::getAutoscaler() const {
+    return autoscaler;
+}
+
+/**
+ * @brief Retrieves how unevenly requests were routed across the servers in service.
+ * @return Largest per-server count divided by the mean, or 0 without routing.
+ */
+double LoadBalancer::getLoadImbalance() const {
+    if (!router || serving == 0) {
+        return 0.0;
+    }
+    size_t total = 0;
+    size_t most = 0;
+    for (size_t i = 0; i < serving; i++) {
+        total += routedCount[i];
+        most = max(most, routedCount[i]);
+    }
+    return total == 0 ? 0.0 : (double)most * (double)serving / (double)total;
+}
+
+/**
+ * @brief Retrieves how many client keys moved on each fleet resize, for affinity routing.
+ * @return Remap events, oldest first.
+ */
+const vector<RemapEvent>& LoadBalancer::getRemaps() const {
+    return remaps;
+}
+
+/**
+ * @brief Retrieves the name of the routing policy.
+ * @return Policy name, or "central" for the shared queue.
+ */
+const char *LoadBalancer::getRoutingName() const {
+    return router ? router->name() : "central";
+}
+
+/**
+ * @brief Retrieves the number of threads advancing the fleet.
+ * @return Thread count.
+ */
+size_t LoadBalancer::getThreads() const {
+    return shards.size();
+}
+
+/**
+ * @brief Retrieves the server classes of a mixed fleet.
+ * @return Server classes; empty for a uniform fleet.
+ */
+const vector<ServerClass>& LoadBalancer::getFleet() const {
+    return fleet;
+}
+
+/**
+ * @brief Retrieves the latencies of the requests a server class finished.
+ * @param cls Index into getFleet(). Call after run().
+ * @return Metrics of the class.
+ */
+const Metrics& LoadBalancer::getClassMetrics(size_t cls) const {
+    return classMetrics[cls];
+}
+
+/**
+ * @brief Computes the fraction of a server class's slot-ticks spent serving requests.
+ * 
+ * Counted like getUtilization(): service time of finished requests plus the
+ * time requests still running have had so far.
+ * 
+ * @param cls Index into getFleet().
+ * @return Utilization between 0 and 1.
+ */
+double LoadBalancer::getClassUtilization(size_t cls) const {
+    size_t slots = fleet[cls].count * fleet[cls].slots;
+    if (slots == 0 || currentTime == 0) {
+        return 0.0;
+    }
+    double busy = 0.0;
+    if (cls < classMetrics.size()) {
+        for (size_t c = 0; c < Scheduler::CLASSES; c++) {
+            const LatencyHistogram &service = classMetrics[cls].get(Metrics::SERVICE, c);
+            busy += service.mean() * (double)service.count();
+        }
+    }
+    for (size_t i = 0; i < servers.size() && i < slotClass.size(); i++) {
+        if (slotClass[i] == cls && servers.isBusy(i)) {
+            busy += (double)(currentTime - servers.getStartTime(i));
+        }
+    }
+    return busy / ((double)slots * (double)currentTime);
+}
+
+/**
+ * @brief Retrieves the fault model, e.g. for its record of failures.
+ * @return Fault model, or nullptr if no faults are injected.
+ */
+const FailureModel *LoadBalancer::getFailures() const {
+    return failures.get();
+}
+
+/**
+ * @brief Retrieves admission control, e.g. for its offered and rejected counts.
+ * @return Admission control.
+ */
+const AdmissionControl& LoadBalancer::getAdmission() const {
+    return admission;
+}
+
+/**
+ * @brief Retrieves the rate limiter, e.g. for its admitted and throttled counts.
+ * @return Rate limiter.
+ */
+const RateLimiter& LoadBalancer::getRateLimiter() const {
+    return limiter;
+}
+
+/**
+ * @brief Retrieves the firewall screening arriving requests.
+ * @return Firewall, or nullptr if there is none.
+ */
+Firewall *LoadBalancer::getFirewall() {
+    return firewall.get();
+}
+
+/**
+ * @brief Retrieves the firewall screening arriving requests.
+ * @return Firewall, or nullptr if there is none.
+ */
+const Firewall *LoadBalancer::getFirewall() const {
+    return firewall.get();
+}
+
+/**
+ * @brief Retrieves the source of arriving requests.
+ * @return Traffic source.
+ */
+const TrafficSource& LoadBalancer::getTraffic() const {
+    return *traffic;
+}
+
+/**
+ * @brief Retrieves the latency and throughput metrics collected so far.
+ * @return Metrics.
+ */
+const Metrics& LoadBalancer::getMetrics() const {
+    return metrics;
+}
+
+/**
+ * @brief Logs the injected faults: totals, times to detect and recover, and
+ *        the first few one by one.
+ */
+void LoadBalancer::logFailures() const {
+    // Faults logged one by one; the rest only count towards the totals
+    const size_t LISTED = 20;
+    const vector<FailureEvent> &events = failures->getEvents();
+    size_t kinds[3] = {0, 0, 0};
+    size_t requeued = 0;
+    size_t lost = 0;
+    size_t detected = 0;
+    size_t recovered = 0;
+    double detectTicks = 0.0;
+    double recoverTicks = 0.0;
+    for (const FailureEvent &e : events) {
+        kinds[(size_t)e.kind]++;
+        requeued += e.requeued;
+        lost += e.lost;
+        if (e.detected != FailureEvent::NONE) {
+            detected++;
+            detectTicks += (double)(e.detected - e.time);
+        }
+        if (e.recovered != FailureEvent::NONE) {
+            recovered++;
+            recoverTicks += (double)(e.recovered - e.time);
         }
-        printf("Servers Running: %lu\n", servers.size());
-        printf("Active servers: %lu\n", activeServers);
-        printf("Idle servers: %lu\n", idleServers);
+    }
+    log->failureSummary(kinds[(size_t)FailureKind::Crash], kinds[(size_t)FailureKind::Rack],
+                        kinds[(size_t)FailureKind::Slowdown], requeued, lost);
+    if (detected > 0) {
+        log->failureDelay(false, detectTicks / (double)detected, detected);
+    }
+    if (recovered > 0) {
+        log->failureDelay(true, recoverTicks / (double)recovered, recovered);
+    }
+    for (size_t i = 0; i < events.size() && i < LISTED; i++) {
+        log->failure(events[i]);
+    }
+    if (events.size() > LISTED) {
+        log->failuresOmitted(events.size() - LISTED);
     }
 }
 
 /**
  * @brief Prints the final results of the simulation.
  * 
- * Outputs the total simulation time and the number of remaining requests in the queue.
+ * Outputs the total simulation time, the number of remaining requests in the queue
+ * and the wait, service and sojourn percentiles of each job class, followed by
+ * the report of each enabled feature.
  */
 void LoadBalancer::printResults() const {
-    cout << "Simulation finished at time = " << currentTime << "\n";
-    cout << "Remaining requests in queue: " << requestQueue.size() << "\n";
+    if (logSummary) {
+        log->summary(currentTime, getQueueSize());
+        for (size_t k = 0; k < Metrics::KINDS; k++) {
+            Metrics::Kind kind = (Metrics::Kind)k;
+            for (size_t c = 0; c < Scheduler::CLASSES; c++) {
+                string label = string(Metrics::kindName(kind)) + " time (" + (char)Scheduler::classType(c) + ")";
+                log->latency(label, metrics.get(kind, c).summarize());
+            }
+        }
+        if (!fleet.empty()) {
+            log->serverClasses();
+            for (size_t k = 0; k < fleet.size(); k++) {
+                LatencyHistogram sojourn;
+                for (size_t c = 0; c < Scheduler::CLASSES; c++) {
+                    sojourn.merge(classMetrics[k].get(Metrics::SOJOURN, c));
+                }
+                log->serverClass(fleet[k].name, fleet[k].count, fleet[k].speed, fleet[k].slots,
+                                 getClassUtilization(k), sojourn.summarize());
+            }
+        }
+        if (firewall) {
+            log->firewallDropped(firewall->getDropped(), firewall->getLoads());
+            for (const FirewallCount &count : firewall->getCounts()) {
+                log->firewallRule(formatCidr(count.rule.prefix, count.rule.length),
+                                  count.rule.allow, count.hits);
+            }
+        }
+        if (limiter.isEnabled()) {
+            log->rateLimited(limiter.getAdmitted(), limiter.getThrottled(), limiter.getTracked(),
+                             limiter.getEvictions(), limiter.memoryUsage());
+        }
+        if (admission.isEnabled()) {
+            double ticks = (double)max(currentTime, (size_t)1);
+            uint64_t offered = 0;
+            uint64_t onTime = 0;
+            log->admission(admission.getConfig().budget, admission.getConfig().shed);
+            for (size_t c = 0; c < Scheduler::CLASSES; c++) {
+                log->admissionClass((char)Scheduler::classType(c), admission.getOffered(c),
+                                    admission.getRejected(c), metrics.getOnTime(c));
+                offered += admission.getOffered(c);
+                onTime += metrics.getOnTime(c);
+            }
+            log->goodput(offered / ticks, onTime / ticks);
+        }
+        if (failures) {
+            logFailures();
+        }
+    }
+    log->flush();
 }
@@ -7,9 +7,34 @@
 #define LOADBALANCER_H
 
 #include <vector>
-#include <queue>
+#include <functional>
 #include <string>
+#include <memory>
 #include "server.h"
+#include "scheduler.h"
+#include "metrics.h"
+#include "autoscaler.h"
+#include "routing-policy.h"
+#include "idle-set.h"
+#include "timing-wheel.h"
+#include "log-sink.h"
+#include "workload.h"
+#include "worker-pool.h"
+#include "firewall.h"
+#include "rate-limiter.h"
+#include "admission-control.h"
+#include "server-class.h"
+#include "failure-model.h"
+#include "health-checker.h"
+
+/**
+ * @enum SimulationMode
+ * @brief Selects how the simulation clock advances.
+ */
+enum class SimulationMode {
+    Tick,   ///< Advance one tick at a time and visit every server each tick.
+    Event   ///< Jump straight to the next completion or arrival.
+};
 
 /**
  * @class LoadBalancer
@@ -17,36 +42,432 @@
  */
 class LoadBalancer {
 private:
-    std::vector<Server> servers;        ///< List of servers managed by the load balancer.
-    std::queue<Request> requestQueue;   ///< Queue of requests waiting to be processed.
+    ServerPool servers;                 ///< Servers managed by the load balancer.
+    IdleSet idle;                       ///< Servers with no request to work on.
+    std::unique_ptr<TrafficSource> traffic; ///< Source of arriving requests.
+    std::unique_ptr<Firewall> firewall;     ///< Screens arrivals; null to let everything in.
+    RateLimiter limiter;                    ///< Throttles arrivals per source IP.
+    AdmissionControl admission;             ///< Sheds arrivals that would wait past the budget.
+    std::vector<ServerClass> fleet;         ///< Mixed fleet: server classes; empty for a uniform one.
+    std::vector<uint32_t> slotClass;        ///< Mixed fleet: class of each server in the pool.
+    std::vector<Metrics> classMetrics;      ///< Mixed fleet: latencies per class, after run().
+    std::unique_ptr<FailureModel> failures; ///< Injects server faults; null for none.
+    HealthChecker health;                   ///< Faults: decides which servers get traffic.
+    std::vector<uint8_t> offline;           ///< Faults: whether each server is down or marked down.
+    std::vector<Request> stranded;          ///< Faults: request each crashed server was running.
+    std::vector<uint8_t> hasStranded;       ///< Faults: whether that request awaits requeueing.
+    std::vector<FailureChange> failureChanges;  ///< Faults: scratch for FailureModel::advance().
+    std::vector<size_t> markedDown;         ///< Faults: scratch for HealthChecker::probe().
+    std::vector<size_t> markedUp;           ///< Faults: scratch for HealthChecker::probe().
+    uint64_t stepWaitSum;                   ///< Total wait of the requests started this step.
+    size_t stepStarts;                      ///< Requests started this step.
+    Autoscaler autoscaler;              ///< Decides when the fleet grows or shrinks.
+    std::unique_ptr<RoutingPolicy> router;      ///< Assigns arrivals to servers; null for the shared queue.
+    std::vector<RequestQueue> localQueues;      ///< Per-server backlogs when routing.
+    std::vector<size_t> outstanding;            ///< Requests queued on or running on each server.
+    std::vector<size_t> outstandingWork;        ///< Sum of the durations of those requests.
+    std::vector<size_t> routedCount;    ///< Requests routed to each server so far.
+    std::vector<uint32_t> probeOwners;  ///< Affinity: server of each probe key at the last resize.
+    std::vector<RemapEvent> remaps;     ///< Affinity: keys moved by each resize.
+    IdleSet ready;                      ///< Idle servers whose local queue has work.
+    size_t localQueued;                 ///< Requests waiting in local queues.
     size_t runTime;                     ///< Total runtime of the simulation.
     size_t currentTime;                 ///< Current simulation time.
+    size_t completedRequests;           ///< Requests servers have finished so far.
+    size_t serving;                     ///< Servers [0, serving) take new work.
+    size_t retiring;                    ///< Servers past serving still finishing a request.
+    size_t serverTicks;                 ///< Sum of the fleet size over every tick so far.
+    Metrics metrics;                    ///< Latencies and throughput of finished requests, after run().
+    SimulationMode mode;                ///< How the simulation clock advances.
+    std::unique_ptr<LogSink> log;       ///< Destination for simulation output.
+    bool logEvents;                     ///< Whether per-event output is enabled.
+    bool logSummary;                    ///< Whether end-of-run output is enabled.
+
+    /**
+     * @struct Shard
+     * @brief A contiguous range of servers advanced by one worker thread.
+     *
+     * Everything a shard writes while the workers run is either indexed by its
+     * own servers or lives here; the counters and logged events are folded into
+     * the load balancer by finishStep() once every shard is done.
+     */
+    struct Shard {
+        size_t begin = 0;           ///< First server of the shard.
+        size_t end = 0;             ///< One past the last server.
+        Scheduler queue;            ///< Shared-queue mode: requests waiting for this shard's servers.
+        Metrics metrics;            ///< Latencies of the requests the shard's servers finished.
+        LogSink *log = nullptr;     ///< Where events go: the load balancer's sink, or buffer.
+        DeferredLogSink buffer;     ///< Events of this step, when several threads run.
+        std::vector<size_t> due;    ///< Servers finishing on the current tick.
+        std::vector<size_t> changed;    ///< Routing: servers whose load dropped this step.
+        size_t completed = 0;       ///< Requests finished this step.
+        size_t dequeued = 0;        ///< Routing: requests taken from local queues this step.
+        size_t retired = 0;         ///< Draining servers that went idle this step.
+        uint64_t waitSum = 0;       ///< Total wait of the requests started this step.
+        size_t started = 0;         ///< Requests started this step.
+
+        std::vector<Metrics> classMetrics;  ///< Mixed fleet: latencies per server class.
+
+        TimingWheel completions;    ///< Event engine: pending completions, keyed by server.
+    };
+
+    size_t shardSpan;                       ///< Servers per shard; the last shard also takes the rest.
+    std::vector<Shard> shards;              ///< Partition of the fleet, one shard per thread.
+    std::unique_ptr<WorkerPool> workers;    ///< Threads advancing the shards; null with one shard.
+
+    /**
+     * @brief Generates a burst of new requests and queues them.
+     */
+    void generateArrivals();
+
+    /**
+     * @brief Queues new requests centrally or routes them to server queues.
+     * @param rs Requests, with arrival times set.
+     * @param n Number of requests.
+     */
+    void enqueue(const Request *rs, size_t n);
+
+    /**
+     * @brief Counts the servers of a shard that take new work.
+     * @param shard Shard.
+     * @return Servers in service in the shard.
+     */
+    size_t servingIn(const Shard &shard) const;
+
+    /**
+     * @brief Recomputes each shard's server range after the pool changes size.
+     */
+    void layoutShards();
+
+    /**
+     * @brief Points each shard at the sink its events should go to.
+     */
+    void connectShardLogs();
+
+    /**
+     * @brief Counts the servers of a shard that can take new work right now.
+     * @param shard Shard.
+     * @return Servers in service in the shard that are neither down nor marked down.
+     */
+    size_t availableIn(const Shard &shard) const;
 
     /**
-     * @brief Generates a random IP address.
-     * @return Randomly generated IP address.
+     * @brief Shared-queue mode: moves requests off shards with no servers available.
      */
-    std::string randomIP() const;
+    void rebalanceShards();
 
     /**
-     * @brief Generates a random job type ('S' or 'P').
-     * @return Randomly generated job type.
+     * @brief Sends a request to the local queue of the server the routing policy picks.
+     * @param r Request to route.
      */
-    char randomJobType() const;
+    void route(const Request &r);
 
     /**
-     * @brief Generates a random request duration.
-     * @return Randomly generated request duration.
+     * @brief Adds or removes a request from a server's outstanding load.
+     * @param index Server index.
+     * @param r Request being added or removed.
+     * @param add True to add, false to remove.
      */
-    size_t randomDuration() const;
+    void adjustLoad(size_t index, const Request &r, bool add);
+
+    /**
+     * @brief Tells the routing policy a server's outstanding load.
+     * @param index Server index.
+     */
+    void reportLoad(size_t index);
+
+    /**
+     * @brief Checks whether a server can take new work.
+     * @param index Server index.
+     * @return True if it is down or marked down by the health checks.
+     */
+    bool isOffline(size_t index) const;
+
+    /**
+     * @brief Checks whether the health checks have taken a server out of rotation.
+     * @param index Server index.
+     * @return True if it should get no traffic.
+     */
+    bool isMarkedDown(size_t index) const;
+
+    /**
+     * @brief Takes the next request a server should run, from its local queue or its shard's.
+     * @param shard Shard the server belongs to.
+     * @param index Server index.
+     * @param next Request to run.
+     * @return True if there was one.
+     */
+    bool takeWork(Shard &shard, size_t index, Request &next);
+
+    /**
+     * @brief Hands a request to a server and records when it started.
+     * @param shard Shard the server belongs to.
+     * @param index Server index.
+     * @param r Request to start.
+     */
+    void startRequest(Shard &shard, size_t index, const Request &r);
+
+    /**
+     * @brief Checks whether an idle server could start a request right now.
+     * @return True if dispatch has work to hand out beyond finished servers.
+     */
+    bool workWaiting() const;
+
+    /**
+     * @brief Finds the next server of a shard, at or after an index, that can start a waiting request.
+     * @param shard Shard to search.
+     * @param from First index to consider.
+     * @return Server index, or IdleSet::NONE.
+     */
+    size_t nextReady(const Shard &shard, size_t from) const;
+
+    /**
+     * @brief Makes the per-server routing state cover the whole pool.
+     */
+    void sizeRoutingState();
+
+    /**
+     * @brief Records where the probe keys land, and how many moved since the last call.
+     * @param from Servers in service before the change, or 0 for the first call.
+     */
+    void probeAffinity(size_t from);
+
+    /**
+     * @brief Finishes and/or assigns work to a single server for the current tick.
+     * @param shard Shard the server belongs to.
+     * @param index Index of the server to process.
+     */
+    void processServer(Shard &shard, size_t index);
+
+    /**
+     * @brief Hands out work to a shard's servers that finished on this tick (shard.due)
+     *        and to its idle servers.
+     * @param shard Shard to dispatch.
+     */
+    void dispatch(Shard &shard);
+
+    /**
+     * @brief Tick engine: advances a shard's servers by one tick and dispatches it.
+     * @param shard Shard to advance.
+     */
+    void tickShard(Shard &shard);
+
+    /**
+     * @brief Event engine: completes a shard's requests due on this tick and dispatches it.
+     * @param shard Shard to advance.
+     */
+    void completeShard(Shard &shard);
+
+    /**
+     * @brief Runs a step on every shard, in parallel when there are several.
+     * @param step Member function to run.
+     */
+    void forEachShard(void (LoadBalancer::*step)(Shard &));
+
+    /**
+     * @brief Folds what the shards did on this tick back into the load balancer.
+     */
+    void finishStep();
+
+    /**
+     * @brief Retrieves the number of servers either in service or still draining.
+     * @return Fleet size.
+     */
+    size_t fleetSize() const;
+
+    /**
+     * @brief Asks the autoscaler for a fleet size and applies it.
+     */
+    void scaleFleet();
+
+    /**
+     * @brief Grows or shrinks the set of servers taking new work.
+     *
+     * Servers taken out of service finish their current request before retiring.
+     *
+     * @param target Servers that should take new work.
+     */
+    void resizeFleet(size_t target);
+
+    /**
+     * @brief Removes drained servers from the end of the pool.
+     */
+    void retireDrained();
+
+    /**
+     * @brief Applies the faults due on this tick and runs the health checks.
+     */
+    void applyFailures();
+
+    /**
+     * @brief Stops a crashed server, setting its request aside.
+     * @param index Server index.
+     */
+    void crashServer(size_t index);
+
+    /**
+     * @brief Lets a repaired server work again, unless it is still marked down.
+     * @param index Server index.
+     */
+    void repairServer(size_t index);
+
+    /**
+     * @brief Takes a server the health checks marked down out of rotation.
+     * @param index Server index.
+     */
+    void ejectServer(size_t index);
+
+    /**
+     * @brief Puts a server the health checks marked up back into rotation.
+     * @param index Server index.
+     */
+    void restoreServer(size_t index);
+
+    /**
+     * @brief Returns a server that can work again to the idle and ready sets.
+     * @param index Server index.
+     */
+    void makeAvailable(size_t index);
+
+    /**
+     * @brief Queues again or drops the request a crash cut short, by the failure policy.
+     * @param index Server it was running on.
+     */
+    void resolveStranded(size_t index);
+
+    /**
+     * @brief Logs the injected faults: totals, times to detect and recover, and
+     *        the first few one by one.
+     */
+    void logFailures() const;
+
+    /**
+     * @brief Runs the simulation one tick at a time.
+     */
+    void runTicks();
+
+    /**
+     * @brief Runs the simulation by jumping between completion and arrival events.
+     */
+    void runEvents();
 
 public:
     /**
      * @brief Constructor for LoadBalancer.
      * @param numServers Number of servers to create.
      * @param timeToRun Total simulation time.
+     * @param seed Seed for the default workload's random streams.
+     * @param simMode How the simulation clock advances.
+     */
+    LoadBalancer(size_t numServers, size_t timeToRun, uint64_t seed,
+                 SimulationMode simMode = SimulationMode::Tick);
+
+    /**
+     * @brief Constructor for LoadBalancer with a caller-supplied workload.
+     * @param numServers Number of servers to create.
+     * @param timeToRun Total simulation time.
+     * @param traffic Generator for the initial queue and later arrivals.
+     * @param simMode How the simulation clock advances.
+     */
+    LoadBalancer(size_t numServers, size_t timeToRun, Workload traffic,
+                 SimulationMode simMode = SimulationMode::Tick);
+
+    /**
+     * @brief Constructor for LoadBalancer with any traffic source, such as a replayed trace.
+     * @param numServers Number of servers to create.
+     * @param timeToRun Total simulation time.
+     * @param source Source of the initial queue and later arrivals.
+     * @param simMode How the simulation clock advances.
      */
-    LoadBalancer(size_t numServers, size_t timeToRun);
+    LoadBalancer(size_t numServers, size_t timeToRun, std::unique_ptr<TrafficSource> source,
+                 SimulationMode simMode = SimulationMode::Tick);
+
+    /**
+     * @brief Replaces the log sink (by default, per-event text on stdout).
+     * @param sink New log sink.
+     */
+    void setLogSink(std::unique_ptr<LogSink> sink);
+
+    /**
+     * @brief Selects the kernel used to advance servers in the tick loop.
+     * @param kernel Tick kernel.
+     */
+    void setTickKernel(TickKernel kernel);
+
+    /**
+     * @brief Changes how queued requests are scheduled (by default, FIFO).
+     * @param cfg Scheduling parameters.
+     */
+    void setScheduler(const SchedulerConfig &cfg);
+
+    /**
+     * @brief Turns on autoscaling of the fleet (off by default).
+     * @param cfg Autoscaling parameters. A maxServers of 0 means ten times the current fleet.
+     */
+    void setAutoscaler(AutoscalerConfig cfg);
+
+    /**
+     * @brief Splits the fleet into shards advanced by separate threads (by default, one).
+     *
+     * With a shared queue, each shard gets its own slice of the queue, so results
+     * depend on the thread count; they never depend on thread timing.
+     *
+     * @param threads Number of threads. Call before run().
+     */
+    void setThreads(size_t threads);
+
+    /**
+     * @brief Screens arriving requests with a firewall (by default, everything is let in).
+     *        Queued requests are screened straight away.
+     * @param fw Firewall, or nullptr for none. Call before setRoutingPolicy() and run().
+     */
+    void setFirewall(std::unique_ptr<Firewall> fw);
+
+    /**
+     * @brief Turns on per-source rate limiting of arrivals (off by default).
+     *        Queued requests are screened straight away.
+     * @param cfg Rate limit parameters. Call before setRoutingPolicy() and run().
+     */
+    void setRateLimit(const RateLimitConfig &cfg);
+
+    /**
+     * @brief Measures arrivals against a latency budget and sheds those that would exceed it
+     *        (by default, everything is admitted). Queued requests are screened straight away.
+     * @param cfg Admission parameters. Call before setRoutingPolicy() and run().
+     */
+    void setAdmission(const AdmissionConfig &cfg);
+
+    /**
+     * @brief Builds the fleet from server classes of different speeds and slot counts
+     *        (by default, every server has speed 1 and one slot).
+     *
+     * The classes take consecutive ranges of the pool, one entry per slot, in
+     * the order given. Not for use with the autoscaler, which adds uniform servers.
+     *
+     * @param classes Server classes; their slots must add up to the number of servers.
+     *        Call before setRoutingPolicy() and run().
+     */
+    void setFleet(const std::vector<ServerClass> &classes);
+
+    /**
+     * @brief Injects server crashes, rack outages and slowdowns, and health checks the
+     *        servers (by default, servers never fail).
+     *
+     * Faults hit whole servers, all slots of a multi-slot server at once. Not for use
+     * with the autoscaler, which changes the fleet the faults are drawn for.
+     *
+     * @param cfg Fault parameters; nothing is injected unless some MTBF is set.
+     * @param checks Health check parameters.
+     * @param seed Seed for the fault times. Call after setFleet() and before run().
+     */
+    void setFailures(const FailureConfig &cfg, const HealthCheckConfig &checks, uint64_t seed);
+
+    /**
+     * @brief Gives each server its own queue and routes requests to them (by default,
+     *        servers share one queue). Queued requests are routed straight away.
+     * @param policy Routing policy, or nullptr to keep the shared queue. Call before run().
+     */
+    void setRoutingPolicy(std::unique_ptr<RoutingPolicy> policy);
 
     /**
      * @brief Initializes the request queue with a predefined number of requests.
@@ -59,6 +480,134 @@ public:
      */
     void run();
 
+    /**
+     * @brief Retrieves the current simulation time.
+     * @return Current simulation time.
+     */
+    size_t getCurrentTime() const;
+
+    /**
+     * @brief Retrieves the number of requests servers have finished.
+     * @return Completed request count.
+     */
+    size_t getCompletedRequests() const;
+
+    /**
+     * @brief Retrieves the number of requests waiting in the queue.
+     * @return Queue length.
+     */
+    size_t getQueueSize() const;
+
+    /**
+     * @brief Retrieves the number of servers taking new work.
+     * @return Servers in service.
+     */
+    size_t getServerCount() const;
+
+    /**
+     * @brief Retrieves the number of server-ticks used so far, a measure of fleet cost.
+     * @return Sum of the fleet size over every tick.
+     */
+    size_t getServerTicks() const;
+
+    /**
+     * @brief Retrieves the share of server-ticks spent processing requests.
+     * @return Utilization between 0 and 1, once run() has returned.
+     */
+    double getUtilization() const;
+
+    /**
+     * @brief Retrieves the autoscaler, e.g. for its scaling events.
+     * @return Autoscaler.
+     */
+    const Autoscaler& getAutoscaler() const;
+
+    /**
+     * @brief Retrieves how unevenly requests were routed across the servers in service.
+     * @return Largest per-server count divided by the mean, or 0 without routing.
+     */
+    double getLoadImbalance() const;
+
+    /**
+     * @brief Retrieves how many client keys moved on each fleet resize, for affinity routing.
+     * @return Remap events, oldest first.
+     */
+    const std::vector<RemapEvent>& getRemaps() const;
+
+    /**
+     * @brief Retrieves the name of the routing policy.
+     * @return Policy name, or "central" for the shared queue.
+     */
+    const char *getRoutingName() const;
+
+    /**
+     * @brief Retrieves the number of threads advancing the fleet.
+     * @return Thread count.
+     */
+    size_t getThreads() const;
+
+    /**
+     * @brief Retrieves the source of arriving requests.
+     * @return Traffic source.
+     */
+    const TrafficSource& getTraffic() const;
+
+    /**
+     * @brief Retrieves the server classes of a mixed fleet.
+     * @return Server classes; empty for a uniform fleet.
+     */
+    const std::vector<ServerClass>& getFleet() const;
+
+    /**
+     * @brief Retrieves the latencies of the requests a server class finished.
+     * @param cls Index into getFleet(). Call after run().
+     * @return Metrics of the class.
+     */
+    const Metrics& getClassMetrics(size_t cls) const;
+
+    /**
+     * @brief Computes the fraction of a server class's slot-ticks spent serving requests.
+     * @param cls Index into getFleet().
+     * @return Utilization between 0 and 1.
+     */
+    double getClassUtilization(size_t cls) const;
+
+    /**
+     * @brief Retrieves the fault model, e.g. for its record of failures.
+     * @return Fault model, or nullptr if no faults are injected.
+     */
+    const FailureModel *getFailures() const;
+
+    /**
+     * @brief Retrieves admission control, e.g. for its offered and rejected counts.
+     * @return Admission control.
+     */
+    const AdmissionControl& getAdmission() const;
+
+    /**
+     * @brief Retrieves the rate limiter, e.g. for its admitted and throttled counts.
+     * @return Rate limiter.
+     */
+    const RateLimiter& getRateLimiter() const;
+
+    /**
+     * @brief Retrieves the firewall screening arriving requests.
+     * @return Firewall, or nullptr if there is none.
+     */
+    Firewall *getFirewall();
+
+    /**
+     * @brief Retrieves the firewall screening arriving requests.
+     * @return Firewall, or nullptr if there is none.
+     */
+    const Firewall *getFirewall() const;
+
+    /**
+     * @brief Retrieves the latency and throughput metrics collected so far.
+     * @return Metrics.
+     */
+    const Metrics& getMetrics() const;
+
     /**
      * @brief Prints the results of the simulation.
      */
@@ -0,0 +1,96 @@
+/**
+ * @file log-decode.cpp
+ * @brief Converts a binary simulation log or trace back into text.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "log-sink.h"
+#include "trace-reader.h"
+
+/**
+ * @brief Prints a trace as text trace lines, preceded by its config header as comments.
+ *
+ * The output replays the same requests when passed back with --trace.
+ *
+ * @param path Trace file path.
+ * @return Exit status.
+ */
+static int decodeTrace(const char *path) {
+    TraceReader trace;
+    std::string error;
+    if (!trace.open(path, error)) {
+        fprintf(stderr, "log-decode: %s\n", error.c_str());
+        return 1;
+    }
+
+    const std::string &header = trace.getHeader();
+    for (size_t start = 0; start < header.size();) {
+        size_t end = header.find('\n', start);
+        end = end == std::string::npos ? header.size() : end;
+        printf("# %.*s\n", (int)(end - start), header.data() + start);
+        start = end + 1;
+    }
+
+    Request batch[TrafficSource::BATCH];
+    char in[Request::MAX_IP_LENGTH + 1], out[Request::MAX_IP_LENGTH + 1];
+    for (size_t time = trace.nextArrivalTime(0, SIZE_MAX - 1); time != SIZE_MAX;
+         time = trace.nextArrivalTime(time, SIZE_MAX - 1)) {
+        size_t howMany = trace.burstSize();
+        for (size_t done = 0; done < howMany; done += TrafficSource::BATCH) {
+            size_t n = std::min(TrafficSource::BATCH, howMany - done);
+            trace.generate(batch, n);
+            for (size_t i = 0; i < n; i++) {
+                in[Request::formatIP(batch[i].getIpIn(), in)] = '\0';
+                out[Request::formatIP(batch[i].getIpOut(), out)] = '\0';
+                printf("%zu %s %s %zu %c\n", time, in, out, batch[i].getDuration(),
+                       (char)batch[i].getJobType());
+            }
+        }
+    }
+    if (trace.getSkipped() > 0) {
+        fprintf(stderr, "log-decode: skipped %zu malformed records\n", trace.getSkipped());
+    }
+    return 0;
+}
+
+/**
+ * @brief Decodes the binary log or trace named on the command line (or a log on stdin) to stdout.
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments.
+ * @return Exit status.
+ */
+int main(int argc, char *argv[]) {
+    FILE *in = stdin;
+    if (argc > 1) {
+        in = fopen(argv[1], "rb");
+        if (in == nullptr) {
+            perror(argv[1]);
+            return 1;
+        }
+        char magic[4];
+        if (fread(magic, 1, sizeof(magic), in) == sizeof(magic) &&
+            memcmp(magic, "LBTR", sizeof(magic)) == 0) {
+            fclose(in);
+            return decodeTrace(argv[1]);
+        }
+        rewind(in);
+    }
+
+    bool ok;
+    {
+        TextLogSink text(LogLevel::Event);
+        ok = replayBinaryLog(in, text);
+    }
+    if (in != stdin) {
+        fclose(in);
+    }
+    if (!ok) {
+        fprintf(stderr, "log-decode: malformed binary log\n");
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,1483 @@
+/**
+ * @file log-sink.cpp
+ * @brief Implementation of the LogSink classes.
+ * 
+ * Sinks collect output in a large private buffer and hand it to the stream in
+ * big fwrite() calls, instead of going through iostreams once per line.
+ */
+
+#include "log-sink.h"
+#include <charconv>
+#include <cstring>
+#include <cstdio>
+using namespace std;
+
+namespace {
+
+const size_t BUFFER_SIZE = 1 << 20;         ///< Bytes buffered before each write.
+const char BINARY_MAGIC[4] = {'L', 'B', 'L', 'G'};
+const unsigned char BINARY_VERSION = 5;
+const unsigned char OLDEST_BINARY_VERSION = 2; ///< Oldest version replayBinaryLog() reads.
+
+/**
+ * @enum RecordTag
+ * @brief Leading byte of each binary log record.
+ */
+enum RecordTag : unsigned char {
+    TAG_TICK = 1,
+    TAG_STATUS,
+    TAG_FINISHED,
+    TAG_STARTED,
+    TAG_STARTED_IDLE,
+    TAG_ARRIVED,
+    TAG_STOPPED,
+    TAG_SUMMARY,
+    TAG_LATENCY,
+    TAG_SCALED,
+    TAG_FIREWALL_DROPPED,   ///< Since version 5.
+    TAG_FIREWALL_RULE,
+    TAG_RATE_LIMITED,
+    TAG_ADMISSION,
+    TAG_ADMISSION_CLASS,
+    TAG_GOODPUT,
+    TAG_SERVER_CLASSES,
+    TAG_SERVER_CLASS,
+    TAG_FAILURE_SUMMARY,
+    TAG_FAILURE_DELAY,
+    TAG_FAILURE,
+    TAG_FAILURES_OMITTED
+};
+
+/**
+ * @brief Reads an unsigned LEB128 varint.
+ * @param in Input stream.
+ * @param value Decoded number.
+ * @return True on success, false at end of stream or on overflow.
+ */
+bool readVarint(FILE *in, size_t &value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        int c = fgetc(in);
+        if (c == EOF) {
+            return false;
+        }
+        value |= (size_t)(c & 0x7f) << shift;
+        if ((c & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Reads a little-endian 32-bit value.
+ * @param in Input stream.
+ * @param value Decoded number.
+ * @return True on success.
+ */
+bool readUint32(FILE *in, uint32_t &value) {
+    unsigned char bytes[4];
+    if (fread(bytes, 1, sizeof(bytes), in) != sizeof(bytes)) {
+        return false;
+    }
+    value = (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 |
+            (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+    return true;
+}
+
+/**
+ * @brief Reads a request record body.
+ * @param in Input stream.
+ * @param r Decoded request.
+ * @return True on success.
+ */
+bool readRequest(FILE *in, Request &r) {
+    uint32_t ipIn, ipOut;
+    size_t duration;
+    if (!readUint32(in, ipIn) || !readUint32(in, ipOut) || !readVarint(in, duration) ||
+        duration > UINT16_MAX) {
+        return false;
+    }
+    int type = fgetc(in);
+    if (type == EOF) {
+        return false;
+    }
+    r = Request(ipIn, ipOut, (uint16_t)duration, (JobType)type);
+    return true;
+}
+
+/**
+ * @brief Reads a length-prefixed string.
+ * @param in Input stream.
+ * @param text Decoded string.
+ * @return True on success.
+ */
+bool readString(FILE *in, string &text) {
+    size_t len;
+    if (!readVarint(in, len) || len > BUFFER_SIZE) {
+        return false;
+    }
+    text.resize(len);
+    return fread(&text[0], 1, len, in) == len;
+}
+
+/**
+ * @brief Reads a real number stored as its IEEE bit pattern.
+ * @param in Input stream.
+ * @param value Decoded number.
+ * @return True on success.
+ */
+bool readDouble(FILE *in, double &value) {
+    size_t bits;
+    if (!readVarint(in, bits)) {
+        return false;
+    }
+    uint64_t wide = bits;
+    memcpy(&value, &wide, sizeof(value));
+    return true;
+}
+
+/**
+ * @brief Reads a latency distribution: count, mean and percentiles.
+ * @param in Input stream.
+ * @param s Decoded distribution.
+ * @return True on success.
+ */
+bool readSummary(FILE *in, LatencySummary &s) {
+    if (!readVarint(in, s.count) || !readDouble(in, s.mean)) {
+        return false;
+    }
+    size_t values[5];
+    for (size_t &v : values) {
+        if (!readVarint(in, v)) {
+            return false;
+        }
+    }
+    s.p50 = values[0];
+    s.p90 = values[1];
+    s.p99 = values[2];
+    s.p999 = values[3];
+    s.max = values[4];
+    return true;
+}
+
+/**
+ * @brief Reads a fault record body.
+ * @param in Input stream.
+ * @param e Decoded fault.
+ * @return True on success.
+ */
+bool readFailure(FILE *in, FailureEvent &e) {
+    int kind = fgetc(in);
+    if (kind < 0 || kind > (int)FailureKind::Slowdown) {
+        return false;
+    }
+    e.kind = (FailureKind)kind;
+    return readVarint(in, e.time) && readVarint(in, e.first) && readVarint(in, e.servers) &&
+           readVarint(in, e.detected) && readVarint(in, e.repaired) &&
+           readVarint(in, e.recovered) && readVarint(in, e.requeued) && readVarint(in, e.lost) &&
+           readDouble(in, e.baselineWait) && readDouble(in, e.peakWait);
+}
+
+/**
+ * @brief Reads a latency record body.
+ * @param in Input stream.
+ * @param label Decoded label.
+ * @param s Decoded summary.
+ * @return True on success.
+ */
+bool readLatency(FILE *in, string &label, LatencySummary &s) {
+    return readString(in, label) && readSummary(in, s);
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a sink at the given log level.
+ * @param lvl Log level.
+ */
+LogSink::LogSink(LogLevel lvl) : level(lvl) {}
+
+/**
+ * @brief Virtual destructor.
+ */
+LogSink::~LogSink() {}
+
+/**
+ * @brief Retrieves the log level of the sink.
+ * @return Log level.
+ */
+LogLevel LogSink::getLevel() const {
+    return level;
+}
+
+/**
+ * @brief Constructs a buffered sink writing to a file, or stdout if path is empty.
+ * @param lvl Log level.
+ * @param path Output path; empty for stdout.
+ * @param binary Whether to open the file in binary mode.
+ */
+BufferedLogSink::BufferedLogSink(LogLevel lvl, const string &path, bool binary)
+    : LogSink(lvl), out(stdout), ownsFile(false), buffer(BUFFER_SIZE), used(0) {
+    if (!path.empty()) {
+        out = fopen(path.c_str(), binary ? "wb" : "w");
+        if (out == nullptr) {
+            perror(path.c_str());
+            out = stdout;
+        } else {
+            ownsFile = true;
+        }
+    }
+}
+
+/**
+ * @brief Flushes and closes the output.
+ */
+BufferedLogSink::~BufferedLogSink() {
+    flush();
+    if (ownsFile) {
+        fclose(out);
+    }
+}
+
+/**
+ * @brief Writes the buffer to the output stream.
+ */
+void BufferedLogSink::flush() {
+    if (used > 0) {
+        fwrite(buffer.data(), 1, used, out);
+        used = 0;
+    }
+    fflush(out);
+}
+
+/**
+ * @brief Makes sure at least len bytes can be appended without flushing.
+ * @param len Number of bytes needed.
+ * @return Pointer to the free space in the buffer.
+ */
+char *BufferedLogSink::reserve(size_t len) {
+    if (used + len > buffer.size()) {
+        fwrite(buffer.data(), 1, used, out);
+        used = 0;
+        if (len > buffer.size()) {
+            buffer.resize(len);
+        }
+    }
+    return buffer.data() + used;
+}
+
+/**
+ * @brief Marks bytes written through reserve() as used.
+ * @param len Number of bytes written.
+ */
+void BufferedLogSink::commit(size_t len) {
+    used += len;
+}
+
+/**
+ * @brief Appends raw bytes to the buffer, flushing when it fills.
+ * @param data Bytes to append.
+ * @param len Number of bytes.
+ */
+void BufferedLogSink::append(const char *data, size_t len) {
+    memcpy(reserve(len), data, len);
+    commit(len);
+}
+
+/**
+ * @brief Appends a single byte to the buffer.
+ * @param c Byte to append.
+ */
+void BufferedLogSink::append(char c) {
+    *reserve(1) = c;
+    commit(1);
+}
+
+/**
+ * @brief Constructs a text sink writing to a file, or stdout if path is empty.
+ * @param lvl Log level.
+ * @param path Output path; empty for stdout.
+ */
+TextLogSink::TextLogSink(LogLevel lvl, const string &path)
+    : BufferedLogSink(lvl, path, false) {}
+
+/**
+ * @brief Appends a decimal number.
+ * @param value Number to append.
+ */
+void TextLogSink::appendNumber(size_t value) {
+    char *p = reserve(20);
+    commit(to_chars(p, p + 20, value).ptr - p);
+}
+
+/**
+ * @brief Appends a string literal.
+ * @param text Text to append.
+ */
+void TextLogSink::appendText(const char *text) {
+    append(text, strlen(text));
+}
+
+/**
+ * @brief Appends a real number in the default format of an ostream.
+ * @param value Number to append.
+ */
+void TextLogSink::appendDouble(double value) {
+    char *p = reserve(32);
+    commit(snprintf(p, 32, "%g", value));
+}
+
+/**
+ * @brief Appends a request in the same format as operator<<.
+ * @param r Request to append.
+ */
+void TextLogSink::appendRequest(const Request &r) {
+    appendText("Request(");
+    commit(Request::formatIP(r.getIpIn(), reserve(Request::MAX_IP_LENGTH)));
+    appendText("->");
+    commit(Request::formatIP(r.getIpOut(), reserve(Request::MAX_IP_LENGTH)));
+    appendText(", time=");
+    appendNumber(r.getDuration());
+    appendText(", type=");
+    append((char)r.getJobType());
+    append(')');
+}
+
+/**
+ * @brief Writes the tick header line.
+ * @param time Current simulation time.
+ */
+void TextLogSink::tick(size_t time) {
+    appendText("[Time= ");
+    appendNumber(time);
+    appendText("]\n");
+}
+
+/**
+ * @brief Writes the three server utilization lines.
+ * @param servers Total number of servers.
+ * @param active Number of busy servers.
+ * @param idle Number of idle servers.
+ */
+void TextLogSink::status(size_t servers, size_t active, size_t idle) {
+    appendText("Servers Running: ");
+    appendNumber(servers);
+    appendText("\nActive servers: ");
+    appendNumber(active);
+    appendText("\nIdle servers: ");
+    appendNumber(idle);
+    append('\n');
+}
+
+/**
+ * @brief Writes a request-finished line.
+ * @param server Index of the server.
+ * @param r Finished request.
+ */
+void TextLogSink::requestFinished(size_t server, const Request &r) {
+    appendText("Server");
+    appendNumber(server);
+    appendText(" finished: ");
+    appendRequest(r);
+    append('\n');
+}
+
+/**
+ * @brief Writes a request-started line.
+ * @param server Index of the server.
+ * @param r Started request.
+ * @param wasIdle True if the server was idle rather than just finishing a request.
+ */
+void TextLogSink::requestStarted(size_t server, const Request &r, bool wasIdle) {
+    appendText("Server");
+    appendNumber(server);
+    appendText(" started: ");
+    appendRequest(r);
+    appendText(wasIdle ? " \n" : "\n");
+}
+
+/**
+ * @brief Writes a new-request line.
+ * @param r New request.
+ */
+void TextLogSink::requestArrived(const Request &r) {
+    appendText("new request arrives: ");
+    appendRequest(r);
+    append('\n');
+}
+
+/**
+ * @brief Writes an autoscaling line.
+ * @param time Current simulation time.
+ * @param from Servers in service before.
+ * @param to Servers in service after.
+ * @param queued Requests waiting.
+ */
+void TextLogSink::scaled(size_t time, size_t from, size_t to, size_t queued) {
+    appendText("Autoscaler at time ");
+    appendNumber(time);
+    appendText(": ");
+    appendNumber(from);
+    appendText(" -> ");
+    appendNumber(to);
+    appendText(" servers (queued requests: ");
+    appendNumber(queued);
+    appendText(")\n");
+}
+
+/**
+ * @brief Writes the runtime-limit line.
+ * @param runTime Runtime limit.
+ */
+void TextLogSink::stopped(size_t runTime) {
+    appendText("Reached max runtime (");
+    appendNumber(runTime);
+    appendText("). Stopping. \n");
+}
+
+/**
+ * @brief Writes the end-of-run results.
+ * @param time Final simulation time.
+ * @param remaining Number of requests left in the queue.
+ */
+void TextLogSink::summary(size_t time, size_t remaining) {
+    appendText("Simulation finished at time = ");
+    appendNumber(time);
+    appendText("\nRemaining requests in queue: ");
+    appendNumber(remaining);
+    append('\n');
+}
+
+/**
+ * @brief Writes a latency distribution line.
+ * @param label What was measured.
+ * @param s Count, mean and percentiles, in ticks.
+ */
+void TextLogSink::latency(const string &label, const LatencySummary &s) {
+    append(label.data(), label.size());
+    appendText(": count=");
+    appendNumber(s.count);
+    char *p = reserve(32);
+    commit(snprintf(p, 32, ", mean=%.2f", s.mean));
+    appendText(", p50=");
+    appendNumber(s.p50);
+    appendText(", p90=");
+    appendNumber(s.p90);
+    appendText(", p99=");
+    appendNumber(s.p99);
+    appendText(", p99.9=");
+    appendNumber(s.p999);
+    appendText(", max=");
+    appendNumber(s.max);
+    append('\n');
+}
+
+/**
+ * @brief Writes the firewall's drop count line.
+ * @param dropped Requests dropped.
+ * @param loads Rule sets loaded, counting reloads.
+ */
+void TextLogSink::firewallDropped(size_t dropped, size_t loads) {
+    appendText("Firewall dropped ");
+    appendNumber(dropped);
+    appendText(" requests (");
+    appendNumber(loads);
+    appendText(loads == 1 ? " rule set loaded)\n" : " rule sets loaded)\n");
+}
+
+/**
+ * @brief Writes one firewall rule's hit count line.
+ * @param range Rule's range as "a.b.c.d/len".
+ * @param allow True for an allowlist rule, false for a blocklist one.
+ * @param hits Requests it decided.
+ */
+void TextLogSink::firewallRule(const string &range, bool allow, size_t hits) {
+    appendText(allow ? "  allow " : "  deny  ");
+    append(range.data(), range.size());
+    appendText(": ");
+    appendNumber(hits);
+    append('\n');
+}
+
+/**
+ * @brief Writes the rate limiter's counts line.
+ * @param admitted Requests let through.
+ * @param throttled Requests dropped for want of tokens.
+ * @param tracked Sources with a bucket at the end.
+ * @param evicted Buckets evicted to bound the table.
+ * @param tableBytes Bytes the bucket table takes.
+ */
+void TextLogSink::rateLimited(size_t admitted, size_t throttled, size_t tracked,
+                              size_t evicted, size_t tableBytes) {
+    appendText("Rate limit: admitted ");
+    appendNumber(admitted);
+    appendText(", throttled ");
+    appendNumber(throttled);
+    appendText(" (");
+    appendNumber(tracked);
+    appendText(" sources tracked, ");
+    appendNumber(evicted);
+    appendText(" evicted, ");
+    appendNumber(tableBytes / 1024);
+    appendText(" KiB table)\n");
+}
+
+/**
+ * @brief Writes the admission control heading line.
+ * @param budget Longest acceptable wait in ticks.
+ * @param shedding Whether arrivals were rejected, or only goodput measured.
+ */
+void TextLogSink::admission(double budget, bool shedding) {
+    appendText("Admission (budget ");
+    appendDouble(budget);
+    appendText(shedding ? " ticks):\n" : " ticks, not shedding):\n");
+}
+
+/**
+ * @brief Writes one job class's admission counts line.
+ * @param type Job class letter.
+ * @param offered Arrivals offered.
+ * @param rejected Arrivals shed.
+ * @param onTime Requests completed within the budget.
+ */
+void TextLogSink::admissionClass(char type, size_t offered, size_t rejected, size_t onTime) {
+    appendText("  ");
+    append(type);
+    appendText(": offered ");
+    appendNumber(offered);
+    appendText(", rejected ");
+    appendNumber(rejected);
+    appendText(", completed within budget ");
+    appendNumber(onTime);
+    append('\n');
+}
+
+/**
+ * @brief Writes the offered load and goodput line.
+ * @param offeredLoad Arrivals per tick.
+ * @param goodput Requests completed within the budget per tick.
+ */
+void TextLogSink::goodput(double offeredLoad, double goodput) {
+    appendText("  Offered load ");
+    appendDouble(offeredLoad);
+    appendText(" requests/tick, goodput ");
+    appendDouble(goodput);
+    appendText(" requests/tick\n");
+}
+
+/**
+ * @brief Writes the heading of the server class lines.
+ */
+void TextLogSink::serverClasses() {
+    appendText("Server classes:\n");
+}
+
+/**
+ * @brief Writes one server class's line.
+ * @param name Class name.
+ * @param count Servers in the class.
+ * @param speed Work each does per tick.
+ * @param slots Requests each runs at once.
+ * @param utilization Share of slot-ticks spent serving.
+ * @param sojourn Sojourn times of the requests it completed.
+ */
+void TextLogSink::serverClass(const string &name, size_t count, double speed, size_t slots,
+                              double utilization, const LatencySummary &sojourn) {
+    appendText("  ");
+    append(name.data(), name.size());
+    appendText(" (");
+    appendNumber(count);
+    appendText(" x speed ");
+    appendDouble(speed);
+    appendText(", ");
+    appendNumber(slots);
+    appendText(slots == 1 ? " slot): utilization " : " slots): utilization ");
+    appendDouble(utilization);
+    appendText(", completed ");
+    appendNumber(sojourn.count);
+    appendText(", sojourn mean ");
+    appendDouble(sojourn.mean);
+    appendText(" p50 ");
+    appendNumber(sojourn.p50);
+    appendText(" p99 ");
+    appendNumber(sojourn.p99);
+    append('\n');
+}
+
+/**
+ * @brief Writes the fault totals line.
+ * @param crashes Single-server crashes.
+ * @param racks Rack outages.
+ * @param slowdowns Slowdowns.
+ * @param requeued In-flight requests queued again.
+ * @param lost In-flight requests dropped.
+ */
+void TextLogSink::failureSummary(size_t crashes, size_t racks, size_t slowdowns,
+                                 size_t requeued, size_t lost) {
+    appendText("Failures: ");
+    appendNumber(crashes + racks + slowdowns);
+    appendText(" (");
+    appendNumber(crashes);
+    appendText(" crashes, ");
+    appendNumber(racks);
+    appendText(" racks, ");
+    appendNumber(slowdowns);
+    appendText(" slowdowns); in-flight requests requeued ");
+    appendNumber(requeued);
+    appendText(", lost ");
+    appendNumber(lost);
+    append('\n');
+}
+
+/**
+ * @brief Writes a mean time to detect or recover line.
+ * @param recovery True for the time to recover, false for the time to detect.
+ * @param meanTicks Mean ticks from the fault.
+ * @param count Faults detected or recovered from.
+ */
+void TextLogSink::failureDelay(bool recovery, double meanTicks, size_t count) {
+    appendText(recovery ? "  Mean time to recover " : "  Mean time to detect ");
+    appendDouble(meanTicks);
+    appendText(" ticks (");
+    appendNumber(count);
+    appendText(recovery ? " recovered)\n" : " detected)\n");
+}
+
+/**
+ * @brief Writes one fault's line.
+ * @param e Fault, as kept by the fault model.
+ */
+void TextLogSink::failure(const FailureEvent &e) {
+    static const char *KIND_NAMES[] = {"crash", "rack", "slowdown"};
+    appendText("  t=");
+    appendNumber(e.time);
+    append(' ');
+    appendText(KIND_NAMES[(size_t)e.kind]);
+    appendText(e.servers == 1 ? " of server " : " of servers ");
+    appendNumber(e.first);
+    if (e.servers != 1) {
+        append('-');
+        appendNumber(e.first + e.servers - 1);
+    }
+    const char *names[] = {": detected ", ", repaired ", ", recovered "};
+    size_t times[] = {e.detected, e.repaired, e.recovered};
+    for (size_t i = 0; i < 3; i++) {
+        appendText(names[i]);
+        if (times[i] == FailureEvent::NONE) {
+            appendText("never");
+        } else {
+            append('+');
+            appendNumber(times[i] - e.time);
+        }
+    }
+    appendText("; wait ");
+    appendDouble(e.baselineWait);
+    appendText(" -> peak ");
+    appendDouble(e.peakWait);
+    if (e.kind != FailureKind::Slowdown) {
+        appendText(", requeued ");
+        appendNumber(e.requeued);
+        appendText(", lost ");
+        appendNumber(e.lost);
+    }
+    append('\n');
+}
+
+/**
+ * @brief Writes the line counting the faults left out.
+ * @param count Faults not reported one by one.
+ */
+void TextLogSink::failuresOmitted(size_t count) {
+    appendText("  ... ");
+    appendNumber(count);
+    appendText(" more in the JSON results\n");
+}
+
+/**
+ * @brief Constructs a binary sink writing to a file, or stdout if path is empty.
+ * 
+ * Writes the magic number and format version first.
+ * 
+ * @param lvl Log level.
+ * @param path Output path; empty for stdout.
+ */
+BinaryLogSink::BinaryLogSink(LogLevel lvl, const string &path)
+    : BufferedLogSink(lvl, path, true) {
+    append(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    append((char)BINARY_VERSION);
+}
+
+/**
+ * @brief Appends an unsigned LEB128 varint.
+ * @param value Number to append.
+ */
+void BinaryLogSink::appendVarint(size_t value) {
+    char *p = reserve(10);
+    size_t len = 0;
+    while (value >= 0x80) {
+        p[len++] = (char)(value | 0x80);
+        value >>= 7;
+    }
+    p[len++] = (char)value;
+    commit(len);
+}
+
+/**
+ * @brief Appends a little-endian 32-bit value.
+ * @param value Number to append.
+ */
+void BinaryLogSink::appendUint32(uint32_t value) {
+    char *p = reserve(4);
+    p[0] = (char)value;
+    p[1] = (char)(value >> 8);
+    p[2] = (char)(value >> 16);
+    p[3] = (char)(value >> 24);
+    commit(4);
+}
+
+/**
+ * @brief Appends a request record body.
+ * @param r Request to append.
+ */
+void BinaryLogSink::appendRequest(const Request &r) {
+    appendUint32(r.getIpIn());
+    appendUint32(r.getIpOut());
+    appendVarint(r.getDuration());
+    append((char)r.getJobType());
+}
+
+/**
+ * @brief Writes a tick record.
+ * @param time Current simulation time.
+ */
+void BinaryLogSink::tick(size_t time) {
+    append((char)TAG_TICK);
+    appendVarint(time);
+}
+
+/**
+ * @brief Writes a status record.
+ * @param servers Total number of servers.
+ * @param active Number of busy servers.
+ * @param idle Number of idle servers.
+ */
+void BinaryLogSink::status(size_t servers, size_t active, size_t idle) {
+    append((char)TAG_STATUS);
+    appendVarint(servers);
+    appendVarint(active);
+    appendVarint(idle);
+}
+
+/**
+ * @brief Writes a request-finished record.
+ * @param server Index of the server.
+ * @param r Finished request.
+ */
+void BinaryLogSink::requestFinished(size_t server, const Request &r) {
+    append((char)TAG_FINISHED);
+    appendVarint(server);
+    appendRequest(r);
+}
+
+/**
+ * @brief Writes a request-started record.
+ * @param server Index of the server.
+ * @param r Started request.
+ * @param wasIdle True if the server was idle rather than just finishing a request.
+ */
+void BinaryLogSink::requestStarted(size_t server, const Request &r, bool wasIdle) {
+    append((char)(wasIdle ? TAG_STARTED_IDLE : TAG_STARTED));
+    appendVarint(server);
+    appendRequest(r);
+}
+
+/**
+ * @brief Writes a new-request record.
+ * @param r New request.
+ */
+void BinaryLogSink::requestArrived(const Request &r) {
+    append((char)TAG_ARRIVED);
+    appendRequest(r);
+}
+
+/**
+ * @brief Writes an autoscaling record.
+ * @param time Current simulation time.
+ * @param from Servers in service before.
+ * @param to Servers in service after.
+ * @param queued Requests waiting.
+ */
+void BinaryLogSink::scaled(size_t time, size_t from, size_t to, size_t queued) {
+    append((char)TAG_SCALED);
+    appendVarint(time);
+    appendVarint(from);
+    appendVarint(to);
+    appendVarint(queued);
+}
+
+/**
+ * @brief Writes a runtime-limit record.
+ * @param runTime Runtime limit.
+ */
+void BinaryLogSink::stopped(size_t runTime) {
+    append((char)TAG_STOPPED);
+    appendVarint(runTime);
+}
+
+/**
+ * @brief Writes an end-of-run record.
+ * @param time Final simulation time.
+ * @param remaining Number of requests left in the queue.
+ */
+void BinaryLogSink::summary(size_t time, size_t remaining) {
+    append((char)TAG_SUMMARY);
+    appendVarint(time);
+    appendVarint(remaining);
+}
+
+/**
+ * @brief Writes a latency record. The mean is stored as its IEEE-754 bit pattern.
+ * @param label What was measured.
+ * @param s Count, mean and percentiles, in ticks.
+ */
+void BinaryLogSink::latency(const string &label, const LatencySummary &s) {
+    append((char)TAG_LATENCY);
+    appendString(label);
+    appendSummary(s);
+}
+
+/**
+ * @brief Appends a length-prefixed string.
+ * @param text String to append.
+ */
+void BinaryLogSink::appendString(const string &text) {
+    appendVarint(text.size());
+    append(text.data(), text.size());
+}
+
+/**
+ * @brief Appends a real number as its IEEE bit pattern.
+ * @param value Number to append.
+ */
+void BinaryLogSink::appendDouble(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    appendVarint(bits);
+}
+
+/**
+ * @brief Appends a latency distribution: count, mean and percentiles.
+ * @param s Distribution to append.
+ */
+void BinaryLogSink::appendSummary(const LatencySummary &s) {
+    appendVarint(s.count);
+    appendDouble(s.mean);
+    appendVarint(s.p50);
+    appendVarint(s.p90);
+    appendVarint(s.p99);
+    appendVarint(s.p999);
+    appendVarint(s.max);
+}
+
+/**
+ * @brief Writes a firewall drop count record.
+ * @param dropped Requests dropped.
+ * @param loads Rule sets loaded, counting reloads.
+ */
+void BinaryLogSink::firewallDropped(size_t dropped, size_t loads) {
+    append((char)TAG_FIREWALL_DROPPED);
+    appendVarint(dropped);
+    appendVarint(loads);
+}
+
+/**
+ * @brief Writes a firewall rule hit count record.
+ * @param range Rule's range as "a.b.c.d/len".
+ * @param allow True for an allowlist rule, false for a blocklist one.
+ * @param hits Requests it decided.
+ */
+void BinaryLogSink::firewallRule(const string &range, bool allow, size_t hits) {
+    append((char)TAG_FIREWALL_RULE);
+    appendString(range);
+    append((char)allow);
+    appendVarint(hits);
+}
+
+/**
+ * @brief Writes a rate limiter counts record.
+ * @param admitted Requests let through.
+ * @param throttled Requests dropped for want of tokens.
+ * @param tracked Sources with a bucket at the end.
+ * @param evicted Buckets evicted to bound the table.
+ * @param tableBytes Bytes the bucket table takes.
+ */
+void BinaryLogSink::rateLimited(size_t admitted, size_t throttled, size_t tracked,
+                                size_t evicted, size_t tableBytes) {
+    append((char)TAG_RATE_LIMITED);
+    appendVarint(admitted);
+    appendVarint(throttled);
+    appendVarint(tracked);
+    appendVarint(evicted);
+    appendVarint(tableBytes);
+}
+
+/**
+ * @brief Writes an admission control heading record.
+ * @param budget Longest acceptable wait in ticks.
+ * @param shedding Whether arrivals were rejected, or only goodput measured.
+ */
+void BinaryLogSink::admission(double budget, bool shedding) {
+    append((char)TAG_ADMISSION);
+    appendDouble(budget);
+    append((char)shedding);
+}
+
+/**
+ * @brief Writes a job class's admission counts record.
+ * @param type Job class letter.
+ * @param offered Arrivals offered.
+ * @param rejected Arrivals shed.
+ * @param onTime Requests completed within the budget.
+ */
+void BinaryLogSink::admissionClass(char type, size_t offered, size_t rejected, size_t onTime) {
+    append((char)TAG_ADMISSION_CLASS);
+    append(type);
+    appendVarint(offered);
+    appendVarint(rejected);
+    appendVarint(onTime);
+}
+
+/**
+ * @brief Writes an offered load and goodput record.
+ * @param offeredLoad Arrivals per tick.
+ * @param goodput Requests completed within the budget per tick.
+ */
+void BinaryLogSink::goodput(double offeredLoad, double goodput) {
+    append((char)TAG_GOODPUT);
+    appendDouble(offeredLoad);
+    appendDouble(goodput);
+}
+
+/**
+ * @brief Writes a server class heading record.
+ */
+void BinaryLogSink::serverClasses() {
+    append((char)TAG_SERVER_CLASSES);
+}
+
+/**
+ * @brief Writes a server class record.
+ * @param name Class name.
+ * @param count Servers in the class.
+ * @param speed Work each does per tick.
+ * @param slots Requests each runs at once.
+ * @param utilization Share of slot-ticks spent serving.
+ * @param sojourn Sojourn times of the requests it completed.
+ */
+void BinaryLogSink::serverClass(const string &name, size_t count, double speed, size_t slots,
+                                double utilization, const LatencySummary &sojourn) {
+    append((char)TAG_SERVER_CLASS);
+    appendString(name);
+    appendVarint(count);
+    appendDouble(speed);
+    appendVarint(slots);
+    appendDouble(utilization);
+    appendSummary(sojourn);
+}
+
+/**
+ * @brief Writes a fault totals record.
+ * @param crashes Single-server crashes.
+ * @param racks Rack outages.
+ * @param slowdowns Slowdowns.
+ * @param requeued In-flight requests queued again.
+ * @param lost In-flight requests dropped.
+ */
+void BinaryLogSink::failureSummary(size_t crashes, size_t racks, size_t slowdowns,
+                                   size_t requeued, size_t lost) {
+    append((char)TAG_FAILURE_SUMMARY);
+    appendVarint(crashes);
+    appendVarint(racks);
+    appendVarint(slowdowns);
+    appendVarint(requeued);
+    appendVarint(lost);
+}
+
+/**
+ * @brief Writes a mean time to detect or recover record.
+ * @param recovery True for the time to recover, false for the time to detect.
+ * @param meanTicks Mean ticks from the fault.
+ * @param count Faults detected or recovered from.
+ */
+void BinaryLogSink::failureDelay(bool recovery, double meanTicks, size_t count) {
+    append((char)TAG_FAILURE_DELAY);
+    append((char)recovery);
+    appendDouble(meanTicks);
+    appendVarint(count);
+}
+
+/**
+ * @brief Writes a fault record.
+ * @param e Fault, as kept by the fault model.
+ */
+void BinaryLogSink::failure(const FailureEvent &e) {
+    append((char)TAG_FAILURE);
+    append((char)e.kind);
+    appendVarint(e.time);
+    appendVarint(e.first);
+    appendVarint(e.servers);
+    appendVarint(e.detected);
+    appendVarint(e.repaired);
+    appendVarint(e.recovered);
+    appendVarint(e.requeued);
+    appendVarint(e.lost);
+    appendDouble(e.baselineWait);
+    appendDouble(e.peakWait);
+}
+
+/**
+ * @brief Writes a count of faults left out.
+ * @param count Faults not reported one by one.
+ */
+void BinaryLogSink::failuresOmitted(size_t count) {
+    append((char)TAG_FAILURES_OMITTED);
+    appendVarint(count);
+}
+
+/**
+ * @brief Constructs an empty sink.
+ * @param lvl Log level.
+ */
+DeferredLogSink::DeferredLogSink(LogLevel lvl) : LogSink(lvl) {}
+
+/**
+ * @brief Replays the recorded events into another sink and forgets them.
+ * @param sink Sink receiving the events.
+ */
+void DeferredLogSink::replay(LogSink &sink) {
+    for (const Record &rec : records) {
+        switch (rec.kind) {
+        case TICK:
+            sink.tick(rec.a);
+            break;
+        case STATUS:
+            sink.status(rec.a, rec.b, rec.c);
+            break;
+        case FINISHED:
+            sink.requestFinished(rec.a, rec.r);
+            break;
+        case STARTED:
+            sink.requestStarted(rec.a, rec.r, rec.flag);
+            break;
+        case ARRIVED:
+            sink.requestArrived(rec.r);
+            break;
+        case SCALED:
+            sink.scaled(rec.a, rec.b, rec.c, rec.d);
+            break;
+        case STOPPED:
+            sink.stopped(rec.a);
+            break;
+        case SUMMARY:
+            sink.summary(rec.a, rec.b);
+            break;
+        case LATENCY:
+            sink.latency(latencies[rec.a].first, latencies[rec.a].second);
+            break;
+        case RESULT:
+            results[rec.a](sink);
+            break;
+        }
+    }
+    records.clear();
+    latencies.clear();
+    results.clear();
+}
+
+/**
+ * @brief Records the start of a tick.
+ * @param time Current simulation time.
+ */
+void DeferredLogSink::tick(size_t time) {
+    records.push_back({TICK, false, time, 0, 0, 0, Request()});
+}
+
+/**
+ * @brief Records the server utilization at the end of a tick.
+ * @param servers Total number of servers.
+ * @param active Number of busy servers.
+ * @param idle Number of idle servers.
+ */
+void DeferredLogSink::status(size_t servers, size_t active, size_t idle) {
+    records.push_back({STATUS, false, servers, active, idle, 0, Request()});
+}
+
+/**
+ * @brief Records a server finishing a request.
+ * @param server Index of the server.
+ * @param r Finished request.
+ */
+void DeferredLogSink::requestFinished(size_t server, const Request &r) {
+    records.push_back({FINISHED, false, server, 0, 0, 0, r});
+}
+
+/**
+ * @brief Records a server starting a request.
+ * @param server Index of the server.
+ * @param r Started request.
+ * @param wasIdle True if the server was idle rather than just finishing a request.
+ */
+void DeferredLogSink::requestStarted(size_t server, const Request &r, bool wasIdle) {
+    records.push_back({STARTED, wasIdle, server, 0, 0, 0, r});
+}
+
+/**
+ * @brief Records a new request arriving in the queue.
+ * @param r New request.
+ */
+void DeferredLogSink::requestArrived(const Request &r) {
+    records.push_back({ARRIVED, false, 0, 0, 0, 0, r});
+}
+
+/**
+ * @brief Records the autoscaler changing the number of servers in service.
+ * @param time Current simulation time.
+ * @param from Servers in service before.
+ * @param to Servers in service after.
+ * @param queued Requests waiting.
+ */
+void DeferredLogSink::scaled(size_t time, size_t from, size_t to, size_t queued) {
+    records.push_back({SCALED, false, time, from, to, queued, Request()});
+}
+
+/**
+ * @brief Records the simulation reaching its runtime limit.
+ * @param runTime Runtime limit.
+ */
+void DeferredLogSink::stopped(size_t runTime) {
+    records.push_back({STOPPED, false, runTime, 0, 0, 0, Request()});
+}
+
+/**
+ * @brief Records the end-of-run results.
+ * @param time Final simulation time.
+ * @param remaining Number of requests left in the queue.
+ */
+void DeferredLogSink::summary(size_t time, size_t remaining) {
+    records.push_back({SUMMARY, false, time, remaining, 0, 0, Request()});
+}
+
+/**
+ * @brief Records an end-of-run latency distribution.
+ * @param label What was measured.
+ * @param s Count, mean and percentiles, in ticks.
+ */
+void DeferredLogSink::latency(const string &label, const LatencySummary &s) {
+    records.push_back({LATENCY, false, latencies.size(), 0, 0, 0, Request()});
+    latencies.emplace_back(label, s);
+}
+
+/**
+ * @brief Records an end-of-run report call to make on replay.
+ * 
+ * The report calls are rare and varied, so they keep their arguments bound in
+ * a closure rather than in a Record of their own.
+ * 
+ * @param call Call, with its arguments bound.
+ */
+void DeferredLogSink::deferResult(function<void(LogSink &)> call) {
+    records.push_back({RESULT, false, results.size(), 0, 0, 0, Request()});
+    results.push_back(move(call));
+}
+
+/**
+ * @brief Records how many arrivals the firewall dropped.
+ * @param dropped Requests dropped.
+ * @param loads Rule sets loaded, counting reloads.
+ */
+void DeferredLogSink::firewallDropped(size_t dropped, size_t loads) {
+    deferResult([=](LogSink &sink) { sink.firewallDropped(dropped, loads); });
+}
+
+/**
+ * @brief Records how many arrivals one firewall rule decided.
+ * @param range Rule's range as "a.b.c.d/len".
+ * @param allow True for an allowlist rule, false for a blocklist one.
+ * @param hits Requests it decided.
+ */
+void DeferredLogSink::firewallRule(const string &range, bool allow, size_t hits) {
+    deferResult([=](LogSink &sink) { sink.firewallRule(range, allow, hits); });
+}
+
+/**
+ * @brief Records how many arrivals the rate limiter let through and throttled.
+ * @param admitted Requests let through.
+ * @param throttled Requests dropped for want of tokens.
+ * @param tracked Sources with a bucket at the end.
+ * @param evicted Buckets evicted to bound the table.
+ * @param tableBytes Bytes the bucket table takes.
+ */
+void DeferredLogSink::rateLimited(size_t admitted, size_t throttled, size_t tracked,
+                                  size_t evicted, size_t tableBytes) {
+    deferResult([=](LogSink &sink) {
+        sink.rateLimited(admitted, throttled, tracked, evicted, tableBytes);
+    });
+}
+
+/**
+ * @brief Records the latency budget admission control enforced.
+ * @param budget Longest acceptable wait in ticks.
+ * @param shedding Whether arrivals were rejected, or only goodput measured.
+ */
+void DeferredLogSink::admission(double budget, bool shedding) {
+    deferResult([=](LogSink &sink) { sink.admission(budget, shedding); });
+}
+
+/**
+ * @brief Records what admission control did with one job class.
+ * @param type Job class letter.
+ * @param offered Arrivals offered.
+ * @param rejected Arrivals shed.
+ * @param onTime Requests completed within the budget.
+ */
+void DeferredLogSink::admissionClass(char type, size_t offered, size_t rejected, size_t onTime) {
+    deferResult([=](LogSink &sink) { sink.admissionClass(type, offered, rejected, onTime); });
+}
+
+/**
+ * @brief Records the load offered to admission control and the goodput delivered.
+ * @param offeredLoad Arrivals per tick.
+ * @param goodput Requests completed within the budget per tick.
+ */
+void DeferredLogSink::goodput(double offeredLoad, double goodput) {
+    deferResult([=](LogSink &sink) { sink.goodput(offeredLoad, goodput); });
+}
+
+/**
+ * @brief Records the start of the per-class report of a mixed fleet.
+ */
+void DeferredLogSink::serverClasses() {
+    deferResult([](LogSink &sink) { sink.serverClasses(); });
+}
+
+/**
+ * @brief Records how busy one server class of a mixed fleet was and how fast it served.
+ * @param name Class name.
+ * @param count Servers in the class.
+ * @param speed Work each does per tick.
+ * @param slots Requests each runs at once.
+ * @param utilization Share of slot-ticks spent serving.
+ * @param sojourn Sojourn times of the requests it completed.
+ */
+void DeferredLogSink::serverClass(const string &name, size_t count, double speed, size_t slots,
+                                  double utilization, const LatencySummary &sojourn) {
+    deferResult([=](LogSink &sink) {
+        sink.serverClass(name, count, speed, slots, utilization, sojourn);
+    });
+}
+
+/**
+ * @brief Records how many faults were injected and the fate of the requests they cut short.
+ * @param crashes Single-server crashes.
+ * @param racks Rack outages.
+ * @param slowdowns Slowdowns.
+ * @param requeued In-flight requests queued again.
+ * @param lost In-flight requests dropped.
+ */
+void DeferredLogSink::failureSummary(size_t crashes, size_t racks, size_t slowdowns,
+                                     size_t requeued, size_t lost) {
+    deferResult([=](LogSink &sink) {
+        sink.failureSummary(crashes, racks, slowdowns, requeued, lost);
+    });
+}
+
+/**
+ * @brief Records how long faults took to be detected or recovered from.
+ * @param recovery True for the time to recover, false for the time to detect.
+ * @param meanTicks Mean ticks from the fault.
+ * @param count Faults detected or recovered from.
+ */
+void DeferredLogSink::failureDelay(bool recovery, double meanTicks, size_t count) {
+    deferResult([=](LogSink &sink) { sink.failureDelay(recovery, meanTicks, count); });
+}
+
+/**
+ * @brief Records one injected fault and how the fleet coped with it.
+ * @param e Fault, as kept by the fault model.
+ */
+void DeferredLogSink::failure(const FailureEvent &e) {
+    deferResult([=](LogSink &sink) { sink.failure(e); });
+}
+
+/**
+ * @brief Records how many faults were left out of the report.
+ * @param count Faults not reported one by one.
+ */
+void DeferredLogSink::failuresOmitted(size_t count) {
+    deferResult([=](LogSink &sink) { sink.failuresOmitted(count); });
+}
+
+/**
+ * @brief Does nothing; events are only written out by replay().
+ */
+void DeferredLogSink::flush() {}
+
+/**
+ * @brief Creates a log sink for the given level, format and output path.
+ * @param lvl Log level.
+ * @param format Output format.
+ * @param path Output path; empty for stdout.
+ * @return Newly created sink.
+ */
+unique_ptr<LogSink> makeLogSink(LogLevel lvl, LogFormat format, const string &path) {
+    if (format == LogFormat::Binary) {
+        return unique_ptr<LogSink>(new BinaryLogSink(lvl, path));
+    }
+    return unique_ptr<LogSink>(new TextLogSink(lvl, path));
+}
+
+/**
+ * @brief Parses a log level name ("off", "summary" or "event").
+ * @param name Level name.
+ * @param lvl Parsed level on success.
+ * @return True if the name was recognized.
+ */
+bool parseLogLevel(const string &name, LogLevel &lvl) {
+    if (name == "off") {
+        lvl = LogLevel::Off;
+    } else if (name == "summary") {
+        lvl = LogLevel::Summary;
+    } else if (name == "event") {
+        lvl = LogLevel::Event;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Replays a binary log into another sink.
+ * @param in Binary log stream.
+ * @param sink Sink receiving the decoded events.
+ * @return True if the whole log was decoded, false on a malformed record.
+ */
+bool replayBinaryLog(FILE *in, LogSink &sink) {
+    char magic[sizeof(BINARY_MAGIC)];
+    if (fread(magic, 1, sizeof(magic), in) != sizeof(magic) ||
+        memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0) {
+        return false;
+    }
+    int version = fgetc(in);
+    if (version < OLDEST_BINARY_VERSION || version > BINARY_VERSION) {
+        return false;
+    }
+
+    Request r;
+    string label;
+    LatencySummary latency;
+    FailureEvent failure;
+    size_t a, b, c, d, e;
+    double x, y;
+    int tag, flag;
+    while ((tag = fgetc(in)) != EOF) {
+        switch (tag) {
+        case TAG_TICK:
+            if (!readVarint(in, a)) return false;
+            sink.tick(a);
+            break;
+        case TAG_STATUS:
+            if (!readVarint(in, a) || !readVarint(in, b) || !readVarint(in, c)) return false;
+            sink.status(a, b, c);
+            break;
+        case TAG_FINISHED:
+            if (!readVarint(in, a) || !readRequest(in, r)) return false;
+            sink.requestFinished(a, r);
+            break;
+        case TAG_STARTED:
+        case TAG_STARTED_IDLE:
+            if (!readVarint(in, a) || !readRequest(in, r)) return false;
+            sink.requestStarted(a, r, tag == TAG_STARTED_IDLE);
+            break;
+        case TAG_ARRIVED:
+            if (!readRequest(in, r)) return false;
+            sink.requestArrived(r);
+            break;
+        case TAG_STOPPED:
+            if (!readVarint(in, a)) return false;
+            sink.stopped(a);
+            break;
+        case TAG_SUMMARY:
+            if (!readVarint(in, a) || !readVarint(in, b)) return false;
+            sink.summary(a, b);
+            break;
+        case TAG_SCALED:
+            if (!readVarint(in, a) || !readVarint(in, b) || !readVarint(in, c) ||
+                !readVarint(in, d)) return false;
+            sink.scaled(a, b, c, d);
+            break;
+        case TAG_LATENCY:
+            if (!readLatency(in, label, latency)) return false;
+            sink.latency(label, latency);
+            break;
+        case TAG_FIREWALL_DROPPED:
+            if (!readVarint(in, a) || !readVarint(in, b)) return false;
+            sink.firewallDropped(a, b);
+            break;
+        case TAG_FIREWALL_RULE:
+            if (!readString(in, label) || (flag = fgetc(in)) == EOF || !readVarint(in, a)) {
+                return false;
+            }
+            sink.firewallRule(label, flag != 0, a);
+            break;
+        case TAG_RATE_LIMITED:
+            if (!readVarint(in, a) || !readVarint(in, b) || !readVarint(in, c) ||
+                !readVarint(in, d) || !readVarint(in, e)) return false;
+            sink.rateLimited(a, b, c, d, e);
+            break;
+        case TAG_ADMISSION:
+            if (!readDouble(in, x) || (flag = fgetc(in)) == EOF) return false;
+            sink.admission(x, flag != 0);
+            break;
+        case TAG_ADMISSION_CLASS:
+            if ((flag = fgetc(in)) == EOF || !readVarint(in, a) || !readVarint(in, b) ||
+                !readVarint(in, c)) return false;
+            sink.admissionClass((char)flag, a, b, c);
+            break;
+        case TAG_GOODPUT:
+            if (!readDouble(in, x) || !readDouble(in, y)) return false;
+            sink.goodput(x, y);
+            break;
+        case TAG_SERVER_CLASSES:
+            sink.serverClasses();
+            break;
+        case TAG_SERVER_CLASS:
+            if (!readString(in, label) || !readVarint(in, a) || !readDouble(in, x) ||
+                !readVarint(in, b) || !readDouble(in, y) || !readSummary(in, latency)) {
+                return false;
+            }
+            sink.serverClass(label, a, x, b, y, latency);
+            break;
+        case TAG_FAILURE_SUMMARY:
+            if (!readVarint(in, a) || !readVarint(in, b) || !readVarint(in, c) ||
+                !readVarint(in, d) || !readVarint(in, e)) return false;
+            sink.failureSummary(a, b, c, d, e);
+            break;
+        case TAG_FAILURE_DELAY:
+            if ((flag = fgetc(in)) == EOF || !readDouble(in, x) || !readVarint(in, a)) return false;
+            sink.failureDelay(flag != 0, x, a);
+            break;
+        case TAG_FAILURE:
+            if (!readFailure(in, failure)) return false;
+            sink.failure(failure);
+            break;
+        case TAG_FAILURES_OMITTED:
+            if (!readVarint(in, a)) return false;
+            sink.failuresOmitted(a);
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
\ No newline at end of file
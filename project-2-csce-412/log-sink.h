@@ -0,0 +1,536 @@
+/**
+ * @file log-sink.h
+ * @brief Header file for the LogSink classes used to record simulation output.
+ */
+
+#ifndef LOGSINK_H
+#define LOGSINK_H
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "failure-model.h"
+#include "latency-histogram.h"
+#include "request.h"
+
+/**
+ * @enum LogLevel
+ * @brief How much the simulation writes to its log sink.
+ */
+enum class LogLevel {
+    Off,        ///< Write nothing.
+    Summary,    ///< Write only the end-of-run lines.
+    Event       ///< Write every tick, start, finish and arrival.
+};
+
+/**
+ * @enum LogFormat
+ * @brief On-disk representation of the log.
+ */
+enum class LogFormat {
+    Text,       ///< Human-readable lines, as printed by the original simulator.
+    Binary      ///< Compact tagged records that log-decode turns back into text.
+};
+
+/**
+ * @class LogSink
+ * @brief Receives structured simulation events and writes them somewhere.
+ *
+ * Each sink owns its own output buffer, so a sink must only be used from one
+ * thread at a time.
+ */
+class LogSink {
+private:
+    LogLevel level; ///< Level the simulation should log at.
+
+public:
+    /**
+     * @brief Constructs a sink at the given log level.
+     * @param lvl Log level.
+     */
+    explicit LogSink(LogLevel lvl);
+
+    /**
+     * @brief Virtual destructor.
+     */
+    virtual ~LogSink();
+
+    /**
+     * @brief Retrieves the log level of the sink.
+     * @return Log level.
+     */
+    LogLevel getLevel() const;
+
+    /**
+     * @brief Records the start of a tick.
+     * @param time Current simulation time.
+     */
+    virtual void tick(size_t time) = 0;
+
+    /**
+     * @brief Records the server utilization at the end of a tick.
+     * @param servers Total number of servers.
+     * @param active Number of busy servers.
+     * @param idle Number of idle servers.
+     */
+    virtual void status(size_t servers, size_t active, size_t idle) = 0;
+
+    /**
+     * @brief Records a server finishing a request.
+     * @param server Index of the server.
+     * @param r Finished request.
+     */
+    virtual void requestFinished(size_t server, const Request &r) = 0;
+
+    /**
+     * @brief Records a server starting a request.
+     * @param server Index of the server.
+     * @param r Started request.
+     * @param wasIdle True if the server was idle rather than just finishing a request.
+     */
+    virtual void requestStarted(size_t server, const Request &r, bool wasIdle) = 0;
+
+    /**
+     * @brief Records a new request arriving in the queue.
+     * @param r New request.
+     */
+    virtual void requestArrived(const Request &r) = 0;
+
+    /**
+     * @brief Records the autoscaler changing the number of servers in service.
+     * @param time Current simulation time.
+     * @param from Servers in service before.
+     * @param to Servers in service after.
+     * @param queued Requests waiting.
+     */
+    virtual void scaled(size_t time, size_t from, size_t to, size_t queued) = 0;
+
+    /**
+     * @brief Records the simulation reaching its runtime limit.
+     * @param runTime Runtime limit.
+     */
+    virtual void stopped(size_t runTime) = 0;
+
+    /**
+     * @brief Records the end-of-run results.
+     * @param time Final simulation time.
+     * @param remaining Number of requests left in the queue.
+     */
+    virtual void summary(size_t time, size_t remaining) = 0;
+
+    /**
+     * @brief Records an end-of-run latency distribution.
+     * @param label What was measured, e.g. "Wait time (P)".
+     * @param s Count, mean and percentiles, in ticks.
+     */
+    virtual void latency(const std::string &label, const LatencySummary &s) = 0;
+
+    /**
+     * @brief Records how many arrivals the firewall dropped.
+     * @param dropped Requests dropped.
+     * @param loads Rule sets loaded, counting reloads.
+     */
+    virtual void firewallDropped(size_t dropped, size_t loads) = 0;
+
+    /**
+     * @brief Records how many arrivals one firewall rule decided.
+     * @param range Rule's range as "a.b.c.d/len".
+     * @param allow True for an allowlist rule, false for a blocklist one.
+     * @param hits Requests it decided.
+     */
+    virtual void firewallRule(const std::string &range, bool allow, size_t hits) = 0;
+
+    /**
+     * @brief Records how many arrivals the rate limiter let through and throttled.
+     * @param admitted Requests let through.
+     * @param throttled Requests dropped for want of tokens.
+     * @param tracked Sources with a bucket at the end.
+     * @param evicted Buckets evicted to bound the table.
+     * @param tableBytes Bytes the bucket table takes.
+     */
+    virtual void rateLimited(size_t admitted, size_t throttled, size_t tracked,
+                             size_t evicted, size_t tableBytes) = 0;
+
+    /**
+     * @brief Records the latency budget admission control enforced.
+     * @param budget Longest acceptable wait in ticks.
+     * @param shedding Whether arrivals were rejected, or only goodput measured.
+     */
+    virtual void admission(double budget, bool shedding) = 0;
+
+    /**
+     * @brief Records what admission control did with one job class.
+     * @param type Job class letter.
+     * @param offered Arrivals offered.
+     * @param rejected Arrivals shed.
+     * @param onTime Requests completed within the budget.
+     */
+    virtual void admissionClass(char type, size_t offered, size_t rejected, size_t onTime) = 0;
+
+    /**
+     * @brief Records the load offered to admission control and the goodput delivered.
+     * @param offeredLoad Arrivals per tick.
+     * @param goodput Requests completed within the budget per tick.
+     */
+    virtual void goodput(double offeredLoad, double goodput) = 0;
+
+    /**
+     * @brief Records the start of the per-class report of a mixed fleet.
+     */
+    virtual void serverClasses() = 0;
+
+    /**
+     * @brief Records how busy one server class of a mixed fleet was and how fast it served.
+     * @param name Class name.
+     * @param count Servers in the class.
+     * @param speed Work each does per tick.
+     * @param slots Requests each runs at once.
+     * @param utilization Share of slot-ticks spent serving.
+     * @param sojourn Sojourn times of the requests it completed.
+     */
+    virtual void serverClass(const std::string &name, size_t count, double speed, size_t slots,
+                             double utilization, const LatencySummary &sojourn) = 0;
+
+    /**
+     * @brief Records how many faults were injected and the fate of the requests they cut short.
+     * @param crashes Single-server crashes.
+     * @param racks Rack outages.
+     * @param slowdowns Slowdowns.
+     * @param requeued In-flight requests queued again.
+     * @param lost In-flight requests dropped.
+     */
+    virtual void failureSummary(size_t crashes, size_t racks, size_t slowdowns,
+                                size_t requeued, size_t lost) = 0;
+
+    /**
+     * @brief Records how long faults took to be detected or recovered from.
+     * @param recovery True for the time to recover, false for the time to detect.
+     * @param meanTicks Mean ticks from the fault.
+     * @param count Faults detected or recovered from.
+     */
+    virtual void failureDelay(bool recovery, double meanTicks, size_t count) = 0;
+
+    /**
+     * @brief Records one injected fault and how the fleet coped with it.
+     * @param e Fault, as kept by the fault model.
+     */
+    virtual void failure(const FailureEvent &e) = 0;
+
+    /**
+     * @brief Records how many faults were left out of the report.
+     * @param count Faults not reported one by one.
+     */
+    virtual void failuresOmitted(size_t count) = 0;
+
+    /**
+     * @brief Writes out any buffered data.
+     */
+    virtual void flush() = 0;
+};
+
+/**
+ * @class BufferedLogSink
+ * @brief Shared output buffering for sinks that write to a FILE stream.
+ */
+class BufferedLogSink : public LogSink {
+private:
+    FILE *out;                  ///< Destination stream.
+    bool ownsFile;              ///< Whether the stream should be closed on destruction.
+    std::vector<char> buffer;   ///< Pending output.
+    size_t used;                ///< Number of bytes of buffer in use.
+
+protected:
+    /**
+     * @brief Appends raw bytes to the buffer, flushing when it fills.
+     * @param data Bytes to append.
+     * @param len Number of bytes.
+     */
+    void append(const char *data, size_t len);
+
+    /**
+     * @brief Appends a single byte to the buffer.
+     * @param c Byte to append.
+     */
+    void append(char c);
+
+    /**
+     * @brief Makes sure at least len bytes can be appended without flushing.
+     * @param len Number of bytes needed.
+     * @return Pointer to the free space in the buffer.
+     */
+    char *reserve(size_t len);
+
+    /**
+     * @brief Marks bytes written through reserve() as used.
+     * @param len Number of bytes written.
+     */
+    void commit(size_t len);
+
+public:
+    /**
+     * @brief Constructs a buffered sink writing to a file, or stdout if path is empty.
+     * @param lvl Log level.
+     * @param path Output path; empty for stdout.
+     * @param binary Whether to open the file in binary mode.
+     */
+    BufferedLogSink(LogLevel lvl, const std::string &path, bool binary);
+
+    /**
+     * @brief Flushes and closes the output.
+     */
+    ~BufferedLogSink() override;
+
+    /**
+     * @brief Writes the buffer to the output stream.
+     */
+    void flush() override;
+};
+
+/**
+ * @class TextLogSink
+ * @brief Writes events as the human-readable lines of the original simulator.
+ */
+class TextLogSink : public BufferedLogSink {
+private:
+    /**
+     * @brief Appends a decimal number.
+     * @param value Number to append.
+     */
+    void appendNumber(size_t value);
+
+    /**
+     * @brief Appends a request in the same format as operator<<.
+     * @param r Request to append.
+     */
+    void appendRequest(const Request &r);
+
+    /**
+     * @brief Appends a string literal.
+     * @param text Text to append.
+     */
+    void appendText(const char *text);
+
+    /**
+     * @brief Appends a real number in the default format of an ostream.
+     * @param value Number to append.
+     */
+    void appendDouble(double value);
+
+public:
+    /**
+     * @brief Constructs a text sink writing to a file, or stdout if path is empty.
+     * @param lvl Log level.
+     * @param path Output path; empty for stdout.
+     */
+    TextLogSink(LogLevel lvl, const std::string &path = "");
+
+    void tick(size_t time) override;
+    void status(size_t servers, size_t active, size_t idle) override;
+    void requestFinished(size_t server, const Request &r) override;
+    void requestStarted(size_t server, const Request &r, bool wasIdle) override;
+    void requestArrived(const Request &r) override;
+    void scaled(size_t time, size_t from, size_t to, size_t queued) override;
+    void stopped(size_t runTime) override;
+    void summary(size_t time, size_t remaining) override;
+    void latency(const std::string &label, const LatencySummary &s) override;
+    void firewallDropped(size_t dropped, size_t loads) override;
+    void firewallRule(const std::string &range, bool allow, size_t hits) override;
+    void rateLimited(size_t admitted, size_t throttled, size_t tracked,
+                     size_t evicted, size_t tableBytes) override;
+    void admission(double budget, bool shedding) override;
+    void admissionClass(char type, size_t offered, size_t rejected, size_t onTime) override;
+    void goodput(double offeredLoad, double goodput) override;
+    void serverClasses() override;
+    void serverClass(const std::string &name, size_t count, double speed, size_t slots,
+                     double utilization, const LatencySummary &sojourn) override;
+    void failureSummary(size_t crashes, size_t racks, size_t slowdowns,
+                        size_t requeued, size_t lost) override;
+    void failureDelay(bool recovery, double meanTicks, size_t count) override;
+    void failure(const FailureEvent &e) override;
+    void failuresOmitted(size_t count) override;
+};
+
+/**
+ * @class BinaryLogSink
+ * @brief Writes events as compact tagged records with varint-encoded fields.
+ */
+class BinaryLogSink : public BufferedLogSink {
+private:
+    /**
+     * @brief Appends an unsigned LEB128 varint.
+     * @param value Number to append.
+     */
+    void appendVarint(size_t value);
+
+    /**
+     * @brief Appends a little-endian 32-bit value.
+     * @param value Number to append.
+     */
+    void appendUint32(uint32_t value);
+
+    /**
+     * @brief Appends a request record body.
+     * @param r Request to append.
+     */
+    void appendRequest(const Request &r);
+
+    /**
+     * @brief Appends a length-prefixed string.
+     * @param text String to append.
+     */
+    void appendString(const std::string &text);
+
+    /**
+     * @brief Appends a real number as its IEEE bit pattern.
+     * @param value Number to append.
+     */
+    void appendDouble(double value);
+
+    /**
+     * @brief Appends a latency distribution: count, mean and percentiles.
+     * @param s Distribution to append.
+     */
+    void appendSummary(const LatencySummary &s);
+
+public:
+    /**
+     * @brief Constructs a binary sink writing to a file, or stdout if path is empty.
+     * @param lvl Log level.
+     * @param path Output path; empty for stdout.
+     */
+    BinaryLogSink(LogLevel lvl, const std::string &path = "");
+
+    void tick(size_t time) override;
+    void status(size_t servers, size_t active, size_t idle) override;
+    void requestFinished(size_t server, const Request &r) override;
+    void requestStarted(size_t server, const Request &r, bool wasIdle) override;
+    void requestArrived(const Request &r) override;
+    void scaled(size_t time, size_t from, size_t to, size_t queued) override;
+    void stopped(size_t runTime) override;
+    void summary(size_t time, size_t remaining) override;
+    void latency(const std::string &label, const LatencySummary &s) override;
+    void firewallDropped(size_t dropped, size_t loads) override;
+    void firewallRule(const std::string &range, bool allow, size_t hits) override;
+    void rateLimited(size_t admitted, size_t throttled, size_t tracked,
+                     size_t evicted, size_t tableBytes) override;
+    void admission(double budget, bool shedding) override;
+    void admissionClass(char type, size_t offered, size_t rejected, size_t onTime) override;
+    void goodput(double offeredLoad, double goodput) override;
+    void serverClasses() override;
+    void serverClass(const std::string &name, size_t count, double speed, size_t slots,
+                     double utilization, const LatencySummary &sojourn) override;
+    void failureSummary(size_t crashes, size_t racks, size_t slowdowns,
+                        size_t requeued, size_t lost) override;
+    void failureDelay(bool recovery, double meanTicks, size_t count) override;
+    void failure(const FailureEvent &e) override;
+    void failuresOmitted(size_t count) override;
+};
+
+/**
+ * @class DeferredLogSink
+ * @brief Keeps events in memory so they can be replayed into another sink later.
+ *
+ * Shards of a multithreaded run each log into their own deferred sink; the
+ * sinks are then replayed in shard order, which makes the combined output
+ * independent of thread timing.
+ */
+class DeferredLogSink : public LogSink {
+private:
+    /**
+     * @enum Kind
+     * @brief Which LogSink call a record stands for.
+     */
+    enum Kind : unsigned char {
+        TICK, STATUS, FINISHED, STARTED, ARRIVED, SCALED, STOPPED, SUMMARY, LATENCY, RESULT
+    };
+
+    /**
+     * @struct Record
+     * @brief Arguments of one recorded call.
+     */
+    struct Record {
+        Kind kind;          ///< Call recorded.
+        bool flag;          ///< wasIdle for STARTED.
+        size_t a, b, c, d;  ///< Numeric arguments in call order; index into latencies for
+                            ///< LATENCY, into results for RESULT.
+        Request r;          ///< Request argument, if any.
+    };
+
+    std::vector<Record> records;                                        ///< Calls in order.
+    std::vector<std::pair<std::string, LatencySummary>> latencies;      ///< Arguments of latency().
+    std::vector<std::function<void(LogSink &)>> results;                ///< Report calls.
+
+    /**
+     * @brief Records an end-of-run report call to make on replay.
+     * @param call Call, with its arguments bound.
+     */
+    void deferResult(std::function<void(LogSink &)> call);
+
+public:
+    /**
+     * @brief Constructs an empty sink.
+     * @param lvl Log level.
+     */
+    explicit DeferredLogSink(LogLevel lvl = LogLevel::Event);
+
+    /**
+     * @brief Replays the recorded events into another sink and forgets them.
+     * @param sink Sink receiving the events.
+     */
+    void replay(LogSink &sink);
+
+    void tick(size_t time) override;
+    void status(size_t servers, size_t active, size_t idle) override;
+    void requestFinished(size_t server, const Request &r) override;
+    void requestStarted(size_t server, const Request &r, bool wasIdle) override;
+    void requestArrived(const Request &r) override;
+    void scaled(size_t time, size_t from, size_t to, size_t queued) override;
+    void stopped(size_t runTime) override;
+    void summary(size_t time, size_t remaining) override;
+    void latency(const std::string &label, const LatencySummary &s) override;
+    void firewallDropped(size_t dropped, size_t loads) override;
+    void firewallRule(const std::string &range, bool allow, size_t hits) override;
+    void rateLimited(size_t admitted, size_t throttled, size_t tracked,
+                     size_t evicted, size_t tableBytes) override;
+    void admission(double budget, bool shedding) override;
+    void admissionClass(char type, size_t offered, size_t rejected, size_t onTime) override;
+    void goodput(double offeredLoad, double goodput) override;
+    void serverClasses() override;
+    void serverClass(const std::string &name, size_t count, double speed, size_t slots,
+                     double utilization, const LatencySummary &sojourn) override;
+    void failureSummary(size_t crashes, size_t racks, size_t slowdowns,
+                        size_t requeued, size_t lost) override;
+    void failureDelay(bool recovery, double meanTicks, size_t count) override;
+    void failure(const FailureEvent &e) override;
+    void failuresOmitted(size_t count) override;
+    void flush() override;
+};
+
+/**
+ * @brief Creates a log sink for the given level, format and output path.
+ * @param lvl Log level.
+ * @param format Output format.
+ * @param path Output path; empty for stdout.
+ * @return Newly created sink.
+ */
+std::unique_ptr<LogSink> makeLogSink(LogLevel lvl, LogFormat format, const std::string &path);
+
+/**
+ * @brief Parses a log level name ("off", "summary" or "event").
+ * @param name Level name.
+ * @param lvl Parsed level on success.
+ * @return True if the name was recognized.
+ */
+bool parseLogLevel(const std::string &name, LogLevel &lvl);
+
+/**
+ * @brief Replays a binary log into another sink.
+ * @param in Binary log stream.
+ * @param sink Sink receiving the decoded events.
+ * @return True if the whole log was decoded, false on a malformed record.
+ */
+bool replayBinaryLog(FILE *in, LogSink &sink);
+
+#endif
\ No newline at end of file
@@ -1,29 +1,364 @@
-
 /**
  * @file main.cpp
  * @brief Entry point for the load balancer simulation.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <string>
+#include "config.h"
+#include "firewall.h"
 #include "load-balancer.h"
+#include "replication.h"
+#include "trace-reader.h"
+#include "trace-recorder.h"
+
+/**
+ * @brief Writes the end-of-run results as a JSON object.
+ * @param path Output path.
+ * @param config Configuration the run used.
+ * @param lb Finished simulation.
+ * @param wallSeconds Wall-clock time spent in run().
+ * @return True if the file was written.
+ */
+static bool writeResults(const std::string &path, const SimulationConfig &config,
+                         const LoadBalancer &lb, double wallSeconds) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    out << "{\n"
+        << "  \"servers\": " << config.servers << ",\n"
+        << "  \"run_time\": " << config.runTime << ",\n"
+        << "  \"seed\": " << config.seed << ",\n"
+        << "  \"mode\": \"" << (config.mode == SimulationMode::Event ? "event" : "tick") << "\",\n"
+        << "  \"threads\": " << lb.getThreads() << ",\n"
+        << "  \"routing\": \"" << lb.getRoutingName() << "\",\n"
+        << "  \"load_imbalance\": " << lb.getLoadImbalance() << ",\n"
+        << "  \"final_time\": " << lb.getCurrentTime() << ",\n"
+        << "  \"remaining_requests\": " << lb.getQueueSize() << ",\n"
+        << "  \"wall_seconds\": " << wallSeconds << ",\n"
+        << "  \"final_servers\": " << lb.getServerCount() << ",\n"
+        << "  \"utilization\": " << lb.getUtilization() << ",\n"
+        << "  \"server_ticks\": " << lb.getServerTicks() << ",\n"
+        << "  \"skipped_records\": " << lb.getTraffic().getSkipped() << ",\n";
+    if (const Firewall *firewall = lb.getFirewall()) {
+        out << "  \"dropped_requests\": " << firewall->getDropped() << ",\n"
+            << "  \"firewall_loads\": " << firewall->getLoads() << ",\n"
+            << "  \"firewall\": [";
+        std::vector<FirewallCount> counts = firewall->getCounts();
+        for (size_t i = 0; i < counts.size(); i++) {
+            out << (i > 0 ? ",\n" : "\n") << "    {\"range\": \""
+                << formatCidr(counts[i].rule.prefix, counts[i].rule.length)
+                << "\", \"action\": \"" << (counts[i].rule.allow ? "allow" : "deny")
+                << "\", \"hits\": " << counts[i].hits << "}";
+        }
+        out << (counts.empty() ? "],\n" : "\n  ],\n");
+    }
+    const RateLimiter &limiter = lb.getRateLimiter();
+    if (limiter.isEnabled()) {
+        out << "  \"rate_limit\": {\"admitted\": " << limiter.getAdmitted()
+            << ", \"throttled\": " << limiter.getThrottled()
+            << ", \"tracked_sources\": " << limiter.getTracked()
+            << ", \"evictions\": " << limiter.getEvictions()
+            << ", \"table_bytes\": " << limiter.memoryUsage() << "},\n";
+    }
+    const AdmissionControl &admission = lb.getAdmission();
+    if (admission.isEnabled()) {
+        double ticks = (double)std::max(lb.getCurrentTime(), (size_t)1);
+        uint64_t offered = 0;
+        uint64_t onTime = 0;
+        out << "  \"admission\": {\"budget\": " << admission.getConfig().budget
+            << ", \"shedding\": " << (admission.getConfig().shed ? "true" : "false");
+        static const char *COUNT_KEYS[] = {"offered", "rejected", "on_time"};
+        for (size_t k = 0; k < 3; k++) {
+            out << ", \"" << COUNT_KEYS[k] << "\": {";
+            for (size_t c = 0; c < Scheduler::CLASSES; c++) {
+                uint64_t count = k == 0 ? admission.getOffered(c) :
+                                 k == 1 ? admission.getRejected(c) : lb.getMetrics().getOnTime(c);
+                out << (c > 0 ? ", " : "") << "\"" << (char)Scheduler::classType(c) << "\": "
+                    << count;
+                offered += k == 0 ? count : 0;
+                onTime += k == 2 ? count : 0;
+            }
+            out << "}";
+        }
+        out << ", \"offered_load\": " << offered / ticks << ", \"goodput\": " << onTime / ticks
+            << "},\n";
+    }
+    const std::vector<ServerClass> &fleet = lb.getFleet();
+    if (!fleet.empty()) {
+        out << "  \"server_classes\": [";
+        for (size_t k = 0; k < fleet.size(); k++) {
+            const Metrics &m = lb.getClassMetrics(k);
+            out << (k > 0 ? ",\n" : "\n") << "    {\"name\": \"" << fleet[k].name
+                << "\", \"servers\": " << fleet[k].count << ", \"speed\": " << fleet[k].speed
+                << ", \"slots\": " << fleet[k].slots
+                << ", \"utilization\": " << lb.getClassUtilization(k);
+            const Metrics::Kind SHOWN[] = {Metrics::WAIT, Metrics::SOJOURN};
+            for (Metrics::Kind kind : SHOWN) {
+                LatencyHistogram all;
+                for (size_t c = 0; c < Scheduler::CLASSES; c++) {
+                    all.merge(m.get(kind, c));
+                }
+                LatencySummary sum = all.summarize();
+                out << ", \"" << (kind == Metrics::WAIT ? "wait" : "sojourn") << "\": {"
+                    << "\"count\": " << sum.count << ", \"mean\": " << sum.mean
+                    << ", \"p50\": " << sum.p50 << ", \"p99\": " << sum.p99 << "}";
+            }
+            out << "}";
+        }
+        out << "\n  ],\n";
+    }
+    if (const FailureModel *failures = lb.getFailures()) {
+        static const char *KIND_NAMES[] = {"crash", "rack", "slowdown"};
+        const std::vector<FailureEvent> &events = failures->getEvents();
+        size_t requeued = 0;
+        size_t lost = 0;
+        for (const FailureEvent &e : events) {
+            requeued += e.requeued;
+            lost += e.lost;
+        }
+        out << "  \"failures\": {\"requeued\": " << requeued << ", \"lost\": " << lost
+            << ", \"events\": [";
+        auto tick = [](size_t t) {
+            return t == FailureEvent::NONE ? std::string("null") : std::to_string(t);
+        };
+        for (size_t i = 0; i < events.size(); i++) {
+            const FailureEvent &e = events[i];
+            out << (i > 0 ? ",\n" : "\n") << "    {\"time\": " << e.time
+                << ", \"kind\": \"" << KIND_NAMES[(size_t)e.kind] << "\", \"first_server\": "
+                << e.first << ", \"servers\": " << e.servers
+                << ", \"detected\": " << tick(e.detected) << ", \"repaired\": " << tick(e.repaired)
+                << ", \"recovered\": " << tick(e.recovered) << ", \"requeued\": " << e.requeued
+                << ", \"lost\": " << e.lost << ", \"baseline_wait\": " << e.baselineWait
+                << ", \"peak_wait\": " << e.peakWait << "}";
+        }
+        out << (events.empty() ? "]},\n" : "\n  ]},\n");
+    }
+    out << "  \"scaling_events\": [";
+    const std::vector<ScalingEvent> &events = lb.getAutoscaler().getEvents();
+    for (size_t i = 0; i < events.size(); i++) {
+        out << (i > 0 ? ",\n" : "\n") << "    {\"time\": " << events[i].time
+            << ", \"from\": " << events[i].from << ", \"to\": " << events[i].to
+            << ", \"queued\": " << events[i].queued << "}";
+    }
+    out << (events.empty() ? "],\n" : "\n  ],\n")
+        << "  \"remaps\": [";
+    const std::vector<RemapEvent> &remaps = lb.getRemaps();
+    for (size_t i = 0; i < remaps.size(); i++) {
+        out << (i > 0 ? ",\n" : "\n") << "    {\"time\": " << remaps[i].time
+            << ", \"from\": " << remaps[i].from << ", \"to\": " << remaps[i].to
+            << ", \"keys_moved\": " << remaps[i].moved
+            << ", \"keys_probed\": " << remaps[i].probed << "}";
+    }
+    out << (remaps.empty() ? "],\n" : "\n  ],\n")
+        << "  \"latency\": {";
+    static const char *KIND_KEYS[Metrics::KINDS] = {"wait", "service", "sojourn"};
+    const Metrics &metrics = lb.getMetrics();
+    for (size_t k = 0; k < Metrics::KINDS; k++) {
+        Metrics::Kind kind = (Metrics::Kind)k;
+        out << (k > 0 ? ",\n" : "\n") << "    \"" << KIND_KEYS[k] << "\": {";
+        for (size_t c = 0; c < Scheduler::CLASSES; c++) {
+            LatencySummary s = metrics.get(kind, c).summarize();
+            out << (c > 0 ? ", " : "") << "\"" << (char)Scheduler::classType(c) << "\": {"
+                << "\"count\": " << s.count << ", \"mean\": " << s.mean
+                << ", \"p50\": " << s.p50 << ", \"p90\": " << s.p90 << ", \"p99\": " << s.p99
+                << ", \"p99.9\": " << s.p999 << ", \"max\": " << s.max << "}";
+        }
+        out << "}";
+    }
+    out << "\n  },\n"
+        << "  \"throughput\": {\"window\": " << metrics.getWindow() << ", \"completions\": [";
+    std::vector<uint64_t> series = metrics.getThroughput(lb.getCurrentTime());
+    for (size_t i = 0; i < series.size(); i++) {
+        out << (i > 0 ? ", " : "") << series[i];
+    }
+    out << "]}\n"
+        << "}\n";
+    return (bool)out;
+}
+
+/**
+ * @brief Prints the confidence interval of every metric over the replications.
+ * @param config Configuration the replications used.
+ * @param replicator Finished replications.
+ */
+static void printReplications(const SimulationConfig &config, const Replicator &replicator) {
+    std::cout << "Replications: " << replicator.getSamples().size() << " of "
+              << config.replication.replications;
+    if (replicator.hasConverged()) {
+        std::cout << " (every 95% interval within " << config.replication.ciTarget * 100.0
+                  << "% of its mean)";
+    }
+    std::cout << "\n" << std::fixed << std::setprecision(4);
+    for (size_t m = 0; m < Replicator::METRICS; m++) {
+        Replicator::Metric metric = (Replicator::Metric)m;
+        ConfidenceInterval ci = replicator.estimate(metric);
+        std::cout << Replicator::metricName(metric) << ": " << ci.mean << " +/- " << ci.halfWidth
+                  << "\n";
+    }
+}
+
+/**
+ * @brief Writes the replication results as a JSON object.
+ * @param path Output path.
+ * @param config Configuration the replications used.
+ * @param replicator Finished replications.
+ * @param wallSeconds Wall-clock time spent running them.
+ * @return True if the file was written.
+ */
+static bool writeReplications(const std::string &path, const SimulationConfig &config,
+                              const Replicator &replicator, double wallSeconds) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    const std::vector<Replicator::Sample> &samples = replicator.getSamples();
+    out << "{\n"
+        << "  \"servers\": " << config.servers << ",\n"
+        << "  \"run_time\": " << config.runTime << ",\n"
+        << "  \"first_seed\": " << config.seed << ",\n"
+        << "  \"replications\": " << samples.size() << ",\n"
+        << "  \"converged\": " << (replicator.hasConverged() ? "true" : "false") << ",\n"
+        << "  \"wall_seconds\": " << wallSeconds << ",\n"
+        << "  \"metrics\": {";
+    for (size_t m = 0; m < Replicator::METRICS; m++) {
+        Replicator::Metric metric = (Replicator::Metric)m;
+        ConfidenceInterval ci = replicator.estimate(metric);
+        out << (m > 0 ? ",\n" : "\n") << "    \"" << Replicator::metricKey(metric) << "\": {"
+            << "\"mean\": " << ci.mean << ", \"ci95_half_width\": " << ci.halfWidth
+            << ", \"samples\": [";
+        for (size_t i = 0; i < samples.size(); i++) {
+            out << (i > 0 ? ", " : "") << samples[i].values[m];
+        }
+        out << "]}";
+    }
+    out << "\n  }\n"
+        << "}\n";
+    return (bool)out;
+}
 
 /**
  * @brief Main function to run the load balancer simulation.
+ * 
+ * Options come from the command line and optional config files (see usageText()).
+ * The server count and run time are prompted for when not given.
+ * 
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments.
  * @return Exit status.
  */
-int main() {
-    size_t numServers;
-    size_t runTime;
+int main(int argc, char *argv[]) {
+    SimulationConfig config;
+    std::string error;
+    if (!parseArguments(argc, argv, config, error) || !validateConfig(config, error)) {
+        std::cerr << "loadbalancer: " << error << "\n" << usageText();
+        return 1;
+    }
+    if (config.showHelp) {
+        std::cout << usageText();
+        return 0;
+    }
+
+    TickKernel kernel;
+    if (!selectTickKernel(config.kernel, kernel)) {
+        std::cerr << "Unsupported tick kernel: " << config.kernel << "\n";
+        return 1;
+    }
+    if (!config.traceFile.empty()) {
+        TraceReader probe;
+        if (!probe.open(config.traceFile, error)) {
+            std::cerr << "loadbalancer: " << error << "\n";
+            return 1;
+        }
+    }
+    if (!config.blocklistFile.empty() || !config.allowlistFile.empty()) {
+        Firewall probe;
+        if (!probe.load(config.blocklistFile, config.allowlistFile, error)) {
+            std::cerr << "loadbalancer: " << error << "\n";
+            return 1;
+        }
+    }
+    if (!config.hasSeed) {
+        config.seed = (uint64_t)time(nullptr);
+    }
 
-    std::cout << "Enter number of servers: ";
-    std::cin >> numServers;
-    std::cout << "Enter how long to run simulation: ";
-    std::cin >> runTime;
+    if (!config.hasServers) {
+        std::cout << "Enter number of servers: ";
+        std::cin >> config.servers;
+    }
+    if (!config.hasRunTime) {
+        std::cout << "Enter how long to run simulation: ";
+        std::cin >> config.runTime;
+        if (!validateConfig(config, error)) {
+            std::cerr << "loadbalancer: " << error << "\n";
+            return 1;
+        }
+    }
 
-    LoadBalancer lb(numServers, runTime);
+    if (config.replication.replications > 1) {
+        Replicator replicator(config, kernel);
+        auto start = std::chrono::steady_clock::now();
+        replicator.run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        printReplications(config, replicator);
+        if (!config.resultsFile.empty() &&
+            !writeReplications(config.resultsFile, config, replicator, elapsed.count())) {
+            std::cerr << "Cannot write results to " << config.resultsFile << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    std::unique_ptr<TrafficSource> traffic = makeTrafficSource(config, config.seed);
+    TraceRecorder *recorder = nullptr;
+    if (!config.recordFile.empty()) {
+        recorder = new TraceRecorder(std::move(traffic));
+        traffic.reset(recorder);
+        if (!recorder->open(config.recordFile, formatConfig(config), error)) {
+            std::cerr << "loadbalancer: " << error << "\n";
+            return 1;
+        }
+    }
+    // Blocks SIGHUP before makeLoadBalancer() starts any worker threads
+    std::unique_ptr<FirewallReloader> reloader;
+    if (!config.blocklistFile.empty() || !config.allowlistFile.empty()) {
+        reloader.reset(new FirewallReloader());
+    }
+    std::unique_ptr<LoadBalancer> sim =
+        makeLoadBalancer(config, config.seed, kernel, std::move(traffic));
+    LoadBalancer &lb = *sim;
+    if (reloader) {
+        reloader->start(*lb.getFirewall(), config.blocklistFile, config.allowlistFile);
+    }
+    lb.setLogSink(makeLogSink(config.logLevel, config.logFormat, config.logFile));
+
+    auto start = std::chrono::steady_clock::now();
     lb.run();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    // The firewall goes away with sim, before reloader would otherwise stop
+    if (reloader) {
+        reloader->stop();
+    }
     lb.printResults();
+    if (lb.getTraffic().getSkipped() > 0) {
+        std::cerr << "Skipped " << lb.getTraffic().getSkipped() << " malformed trace records\n";
+    }
+    if (recorder && !recorder->close()) {
+        std::cerr << "Cannot write trace to " << config.recordFile << "\n";
+        return 1;
+    }
+
+    if (!config.resultsFile.empty() &&
+        !writeResults(config.resultsFile, config, lb, elapsed.count())) {
+        std::cerr << "Cannot write results to " << config.resultsFile << "\n";
+        return 1;
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,149 @@
+/**
+ * @file metrics.cpp
+ * @brief Implementation of the Metrics class.
+ */
+
+#include "metrics.h"
+#include <algorithm>
+
+/**
+ * @brief Retrieves a human-readable name for a histogram kind.
+ * @param kind Histogram kind.
+ * @return "Wait", "Service" or "Sojourn".
+ */
+const char *Metrics::kindName(Kind kind) {
+    static const char *NAMES[KINDS] = {"Wait", "Service", "Sojourn"};
+    return NAMES[kind];
+}
+
+/**
+ * @brief Constructs empty metrics.
+ */
+Metrics::Metrics() : window(1), deadline(SIZE_MAX), onTime() {}
+
+/**
+ * @brief Records a request starting service.
+ * @param r Request, with its arrival time set.
+ * @param now Current simulation time.
+ */
+void Metrics::requestStarted(const Request &r, size_t now) {
+    histograms[WAIT][Scheduler::classOf(r.getJobType())].record(now - r.getArrivalTime());
+}
+
+/**
+ * @brief Records a request completing.
+ * 
+ * Completions on tick t fall in window (t - 1) / window; when that is past the
+ * last window allowed, the window is coarsened until it fits.
+ * 
+ * @param r Request, with its arrival time set.
+ * @param started Tick at which its service started.
+ * @param now Current simulation time.
+ */
+void Metrics::requestFinished(const Request &r, size_t started, size_t now) {
+    size_t cls = Scheduler::classOf(r.getJobType());
+    histograms[SERVICE][cls].record(now - started);
+    histograms[SOJOURN][cls].record(now - r.getArrivalTime());
+    if (started - r.getArrivalTime() <= deadline) {
+        onTime[cls]++;
+    }
+
+    size_t slot = (now == 0 ? 0 : now - 1) / window;
+    while (slot >= MAX_WINDOWS) {
+        coarsen();
+        slot = (now - 1) / window;
+    }
+    if (slot >= completions.size()) {
+        completions.resize(slot + 1, 0);
+    }
+    completions[slot]++;
+}
+
+/**
+ * @brief Doubles the throughput window, adding neighbouring windows together.
+ */
+void Metrics::coarsen() {
+    size_t half = (completions.size() + 1) / 2;
+    for (size_t i = 0; i < half; i++) {
+        uint64_t second = 2 * i + 1 < completions.size() ? completions[2 * i + 1] : 0;
+        completions[i] = completions[2 * i] + second;
+    }
+    completions.resize(half);
+    window *= 2;
+}
+
+/**
+ * @brief Adds the requests recorded by other metrics, e.g. another shard's.
+ * 
+ * Both series start at tick 1 and their windows are powers of two, so the finer
+ * one folds exactly into the coarser one's windows.
+ * 
+ * @param other Metrics to add.
+ */
+void Metrics::merge(const Metrics &other) {
+    for (size_t k = 0; k < KINDS; k++) {
+        for (size_t c = 0; c < Scheduler::CLASSES; c++) {
+            histograms[k][c].merge(other.histograms[k][c]);
+        }
+    }
+    for (size_t c = 0; c < Scheduler::CLASSES; c++) {
+        onTime[c] += other.onTime[c];
+    }
+    while (window < other.window) {
+        coarsen();
+    }
+    size_t ratio = window / other.window;
+    for (size_t i = 0; i < other.completions.size(); i++) {
+        if (i / ratio >= completions.size()) {
+            completions.resize(i / ratio + 1, 0);
+        }
+        completions[i / ratio] += other.completions[i];
+    }
+}
+
+/**
+ * @brief Sets the wait up to which a completion counts as on time (by
+ *        default, every completion does).
+ * @param ticks Deadline in ticks. Call before recording any completion.
+ */
+void Metrics::setDeadline(size_t ticks) {
+    deadline = ticks;
+}
+
+/**
+ * @brief Retrieves the number of completions of a class that started within the deadline.
+ * @param cls Class index.
+ * @return On-time completions.
+ */
+uint64_t Metrics::getOnTime(size_t cls) const {
+    return onTime[cls];
+}
+
+/**
+ * @brief Retrieves a latency histogram.
+ * @param kind What was measured.
+ * @param cls Class index.
+ * @return Histogram.
+ */
+const LatencyHistogram& Metrics::get(Kind kind, size_t cls) const {
+    return histograms[kind][cls];
+}
+
+/**
+ * @brief Retrieves the number of ticks per throughput window.
+ * @return Window length.
+ */
+size_t Metrics::getWindow() const {
+    return window;
+}
+
+/**
+ * @brief Retrieves the completions per window, covering ticks 1 to endTime.
+ * @param endTime Last tick of the run.
+ * @return Completions in each window; the last window may be partial.
+ */
+std::vector<uint64_t> Metrics::getThroughput(size_t endTime) const {
+    std::vector<uint64_t> series = completions;
+    series.resize(std::max(series.size(), (endTime + window - 1) / window), 0);
+    return series;
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+/**
+ * @file metrics.h
+ * @brief Header file for the Metrics class that collects per-request latencies.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "latency-histogram.h"
+#include "request.h"
+#include "scheduler.h"
+
+/**
+ * @class Metrics
+ * @brief Latency distributions and throughput of the requests a simulation completes.
+ *
+ * For each job class, three histograms are kept: wait (arrival to start),
+ * service (start to completion) and sojourn (arrival to completion). Completions
+ * are also counted per window of ticks. The window starts at one tick and
+ * doubles, merging neighbours, whenever the series would exceed MAX_WINDOWS,
+ * so memory stays fixed however long the run is.
+ */
+class Metrics {
+public:
+    /**
+     * @brief Largest number of throughput windows kept.
+     */
+    static const size_t MAX_WINDOWS = 4096;
+
+    /**
+     * @enum Kind
+     * @brief Which part of a request's life a histogram measures.
+     */
+    enum Kind {
+        WAIT,       ///< Arrival to start of service.
+        SERVICE,    ///< Start of service to completion.
+        SOJOURN,    ///< Arrival to completion.
+        KINDS       ///< Number of kinds.
+    };
+
+    /**
+     * @brief Retrieves a human-readable name for a histogram kind.
+     * @param kind Histogram kind.
+     * @return "Wait", "Service" or "Sojourn".
+     */
+    static const char *kindName(Kind kind);
+
+private:
+    LatencyHistogram histograms[KINDS][Scheduler::CLASSES];    ///< Latencies by kind and class.
+    std::vector<uint64_t> completions;              ///< Completions per window of ticks.
+    size_t window;                                  ///< Ticks per window.
+    size_t deadline;                                ///< Wait that still counts as on time.
+    uint64_t onTime[Scheduler::CLASSES];            ///< Completions within the deadline per class.
+
+    /**
+     * @brief Doubles the throughput window, adding neighbouring windows together.
+     */
+    void coarsen();
+
+public:
+    /**
+     * @brief Constructs empty metrics.
+     */
+    Metrics();
+
+    /**
+     * @brief Records a request starting service.
+     * @param r Request, with its arrival time set.
+     * @param now Current simulation time.
+     */
+    void requestStarted(const Request &r, size_t now);
+
+    /**
+     * @brief Records a request completing.
+     * @param r Request, with its arrival time set.
+     * @param started Tick at which its service started.
+     * @param now Current simulation time.
+     */
+    void requestFinished(const Request &r, size_t started, size_t now);
+
+    /**
+     * @brief Adds the requests recorded by other metrics, e.g. another shard's.
+     * @param other Metrics to add.
+     */
+    void merge(const Metrics &other);
+
+    /**
+     * @brief Retrieves a latency histogram.
+     * @param kind What was measured.
+     * @param cls Class index.
+     * @return Histogram.
+     */
+    const LatencyHistogram& get(Kind kind, size_t cls) const;
+
+    /**
+     * @brief Sets the wait up to which a completion counts as on time (by
+     *        default, every completion does).
+     * @param ticks Deadline in ticks. Call before recording any completion.
+     */
+    void setDeadline(size_t ticks);
+
+    /**
+     * @brief Retrieves the number of completions of a class that started within the deadline.
+     * @param cls Class index.
+     * @return On-time completions.
+     */
+    uint64_t getOnTime(size_t cls) const;
+
+    /**
+     * @brief Retrieves the number of ticks per throughput window.
+     * @return Window length.
+     */
+    size_t getWindow() const;
+
+    /**
+     * @brief Retrieves the completions per window, covering ticks 1 to endTime.
+     * @param endTime Last tick of the run.
+     * @return Completions in each window; the last window may be partial.
+     */
+    std::vector<uint64_t> getThroughput(size_t endTime) const;
+};
+
+#endif
\ No newline at end of file
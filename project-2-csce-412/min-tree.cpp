@@ -0,0 +1,104 @@
+/**
+ * @file min-tree.cpp
+ * @brief Implementation of the MinTree class.
+ */
+
+#include "min-tree.h"
+
+/**
+ * @brief Constructs a tree of n zero values.
+ * @param n Number of values.
+ */
+MinTree::MinTree(size_t n) : count(0), leaves(0) {
+    resize(n);
+}
+
+/**
+ * @brief Picks the smaller of two leaves.
+ * @param a Leaf index.
+ * @param b Leaf index, greater than a.
+ * @return a unless b holds a strictly smaller value.
+ */
+uint32_t MinTree::better(uint32_t a, uint32_t b) const {
+    return values[b] < values[a] ? b : a;
+}
+
+/**
+ * @brief Changes the number of values. Kept values stay; new ones are zero.
+ * 
+ * Rebuilds every inner node, so this is O(n).
+ * 
+ * @param n Number of values.
+ */
+void MinTree::resize(size_t n) {
+    size_t newLeaves = 1;
+    while (newLeaves < n) {
+        newLeaves *= 2;
+    }
+    values.resize(newLeaves, UINT64_MAX);
+    for (size_t i = count; i < n; i++) {
+        values[i] = 0;
+    }
+    for (size_t i = n; i < newLeaves; i++) {
+        values[i] = UINT64_MAX;
+    }
+    count = n;
+    leaves = newLeaves;
+
+    // Node 1 is the root; the children of node k are 2k and 2k + 1, and leaf i is node leaves + i
+    winners.assign(leaves, 0);
+    for (size_t node = leaves - 1; node >= 1; node--) {
+        uint32_t left, right;
+        if (2 * node >= leaves) {
+            left = (uint32_t)(2 * node - leaves);
+            right = left + 1;
+        } else {
+            left = winners[2 * node];
+            right = winners[2 * node + 1];
+        }
+        winners[node] = better(left, right);
+    }
+}
+
+/**
+ * @brief Retrieves the number of values.
+ * @return Number of values.
+ */
+size_t MinTree::size() const {
+    return count;
+}
+
+/**
+ * @brief Changes one value.
+ * @param index Value index.
+ * @param value New value.
+ */
+void MinTree::set(size_t index, uint64_t value) {
+    values[index] = value;
+    size_t node = (leaves + index) / 2;
+    if (node == 0) {
+        return;
+    }
+    size_t left = index & ~(size_t)1;
+    winners[node] = better((uint32_t)left, (uint32_t)(left + 1));
+    for (node /= 2; node >= 1; node /= 2) {
+        winners[node] = better(winners[2 * node], winners[2 * node + 1]);
+    }
+}
+
+/**
+ * @brief Retrieves one value.
+ * @param index Value index.
+ * @return Value.
+ */
+uint64_t MinTree::get(size_t index) const {
+    return values[index];
+}
+
+/**
+ * @brief Finds the smallest value.
+ * @return Index of the smallest value (the lowest such index). The tree must not be empty.
+ */
+size_t MinTree::argmin() const {
+    return leaves == 1 ? 0 : winners[1];
+}
\ No newline at end of file
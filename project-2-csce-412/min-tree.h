@@ -0,0 +1,76 @@
+/**
+ * @file min-tree.h
+ * @brief Header file for the MinTree class.
+ */
+
+#ifndef MINTREE_H
+#define MINTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class MinTree
+ * @brief Array of values that can report the index of its smallest value in O(1).
+ *
+ * A complete binary tree over the values stores, at each inner node, the index
+ * of the smallest value below it (the lower index on ties). Changing a value
+ * replays the comparisons on its path to the root, which is O(log n).
+ */
+class MinTree {
+private:
+    std::vector<uint64_t> values;   ///< Leaf values, padded to a power of two with UINT64_MAX.
+    std::vector<uint32_t> winners;  ///< Index of the smallest leaf under each inner node.
+    size_t count;                   ///< Number of real values.
+    size_t leaves;                  ///< Number of leaves (a power of two).
+
+    /**
+     * @brief Picks the smaller of two leaves.
+     * @param a Leaf index.
+     * @param b Leaf index, greater than a.
+     * @return a unless b holds a strictly smaller value.
+     */
+    uint32_t better(uint32_t a, uint32_t b) const;
+
+public:
+    /**
+     * @brief Constructs a tree of n zero values.
+     * @param n Number of values.
+     */
+    explicit MinTree(size_t n = 0);
+
+    /**
+     * @brief Changes the number of values. Kept values stay; new ones are zero.
+     * @param n Number of values.
+     */
+    void resize(size_t n);
+
+    /**
+     * @brief Retrieves the number of values.
+     * @return Number of values.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Changes one value.
+     * @param index Value index.
+     * @param value New value.
+     */
+    void set(size_t index, uint64_t value);
+
+    /**
+     * @brief Retrieves one value.
+     * @param index Value index.
+     * @return Value.
+     */
+    uint64_t get(size_t index) const;
+
+    /**
+     * @brief Finds the smallest value.
+     * @return Index of the smallest value (the lowest such index). The tree must not be empty.
+     */
+    size_t argmin() const;
+};
+
+#endif
\ No newline at end of file
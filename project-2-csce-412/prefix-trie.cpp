@@ -0,0 +1,159 @@
+/**
+ * @file prefix-trie.cpp
+ * @brief Implementation of the PrefixTrie class.
+ */
+
+#include "prefix-trie.h"
+
+/**
+ * @brief Constructs an empty table: every lookup returns NONE.
+ */
+PrefixTrie::PrefixTrie() : direct((size_t)1 << DIRECT_BITS, LEAF | NONE) {}
+
+/**
+ * @brief Walks the binary trie through up to STRIDE bits of a slot index.
+ * @param tree Binary trie.
+ * @param from Node to start at.
+ * @param slot Slot index whose bits, most significant first, choose the path.
+ * @param bits Number of bits to follow.
+ * @param value Value of the longest prefix passed; updated along the way.
+ * @return Node reached after all bits, or -1 if the path ends sooner.
+ */
+int32_t PrefixTrie::walk(const std::vector<BuildNode> &tree, int32_t from, uint32_t slot,
+                         unsigned bits, uint32_t &value) {
+    int32_t node = from;
+    for (unsigned i = bits; i-- > 0;) {
+        node = tree[node].child[(slot >> i) & 1];
+        if (node < 0) {
+            return -1;
+        }
+        if (tree[node].value != NONE) {
+            value = tree[node].value;
+        }
+    }
+    return node;
+}
+
+/**
+ * @brief Fills in a compressed node and, recursively, its children.
+ *
+ * The last node covers only the 4 address bits left after 16 + 2 * 6; its
+ * slot index has them in the top 4 of its 6 bits, as lookup() extracts them.
+ *
+ * @param tree Binary trie.
+ * @param index Position of the node in nodes (already allocated).
+ * @param from Binary trie node for the prefix the node covers.
+ * @param depth Address bits consumed before the node.
+ * @param value Value of the longest prefix covering the node.
+ */
+void PrefixTrie::compile(const std::vector<BuildNode> &tree, size_t index, int32_t from,
+                         unsigned depth, uint32_t value) {
+    const unsigned SLOTS = 1 << STRIDE;
+    unsigned bits = depth + STRIDE <= 32 ? STRIDE : 32 - depth;
+    int32_t below[SLOTS];
+    uint32_t values[SLOTS];
+    Node node = {0, 0, (uint32_t)leaves.size(), (uint32_t)nodes.size()};
+
+    bool first = true;
+    uint32_t last = NONE;
+    for (unsigned slot = 0; slot < SLOTS; slot++) {
+        values[slot] = value;
+        below[slot] = walk(tree, from, slot >> (STRIDE - bits), bits, values[slot]);
+        bool deeper = below[slot] >= 0 && depth + bits < 32 &&
+                      (tree[below[slot]].child[0] >= 0 || tree[below[slot]].child[1] >= 0);
+        if (deeper) {
+            node.vector |= (uint64_t)1 << slot;
+        } else {
+            below[slot] = -1;
+            if (first || values[slot] != last) {
+                node.leafvec |= (uint64_t)1 << slot;
+                leaves.push_back(values[slot]);
+                last = values[slot];
+                first = false;
+            }
+        }
+    }
+
+    nodes.resize(nodes.size() + __builtin_popcountll(node.vector));
+    nodes[index] = node;
+    size_t child = node.base1;
+    for (unsigned slot = 0; slot < SLOTS; slot++) {
+        if (below[slot] >= 0) {
+            compile(tree, child++, below[slot], depth + bits, values[slot]);
+        }
+    }
+}
+
+/**
+ * @brief Replaces the contents with a set of prefixes.
+ *
+ * The prefixes go into a plain binary trie first, which is then compressed
+ * one direct-table entry at a time.
+ *
+ * @param prefixes Prefixes; of identical ones, the last wins.
+ */
+void PrefixTrie::build(const std::vector<Prefix> &prefixes) {
+    std::vector<BuildNode> tree(1, BuildNode{{-1, -1}, NONE});
+    for (const Prefix &prefix : prefixes) {
+        int32_t node = 0;
+        for (unsigned i = 0; i < prefix.length && i < 32; i++) {
+            unsigned bit = (prefix.address >> (31 - i)) & 1;
+            if (tree[node].child[bit] < 0) {
+                tree[node].child[bit] = (int32_t)tree.size();
+                tree.push_back(BuildNode{{-1, -1}, NONE});
+            }
+            node = tree[node].child[bit];
+        }
+        tree[node].value = prefix.value;
+    }
+
+    nodes.clear();
+    leaves.clear();
+    for (uint32_t top = 0; top < direct.size(); top++) {
+        uint32_t value = tree[0].value;
+        int32_t node = walk(tree, 0, top, DIRECT_BITS, value);
+        if (node >= 0 && (tree[node].child[0] >= 0 || tree[node].child[1] >= 0)) {
+            direct[top] = (uint32_t)nodes.size();
+            nodes.emplace_back();
+            compile(tree, direct[top], node, DIRECT_BITS, value);
+        } else {
+            direct[top] = LEAF | value;
+        }
+    }
+    nodes.shrink_to_fit();
+    leaves.shrink_to_fit();
+}
+
+/**
+ * @brief Finds the value of the longest prefix that matches an address.
+ * @param address IPv4 address, most significant octet first.
+ * @return Value, or NONE if no prefix matches.
+ */
+uint32_t PrefixTrie::lookup(uint32_t address) const {
+    uint32_t entry = direct[address >> (32 - DIRECT_BITS)];
+    if (entry & LEAF) {
+        return entry & ~LEAF;
+    }
+
+    // Left-align the address in 64 bits so the last, 4-bit step reads zeros past it
+    uint64_t key = (uint64_t)address << 32;
+    const Node *node = &nodes[entry];
+    for (unsigned depth = DIRECT_BITS;; depth += STRIDE) {
+        unsigned slot = (unsigned)((key << depth) >> (64 - STRIDE));
+        uint64_t upTo = ((uint64_t)2 << slot) - 1;
+        if ((node->vector >> slot) & 1) {
+            node = &nodes[node->base1 + __builtin_popcountll(node->vector & upTo) - 1];
+        } else {
+            return leaves[node->base0 + __builtin_popcountll(node->leafvec & upTo) - 1];
+        }
+    }
+}
+
+/**
+ * @brief Retrieves the memory held by the table.
+ * @return Size in bytes.
+ */
+size_t PrefixTrie::memoryUsage() const {
+    return direct.size() * sizeof(uint32_t) + nodes.size() * sizeof(Node) +
+           leaves.size() * sizeof(uint32_t);
+}
\ No newline at end of file
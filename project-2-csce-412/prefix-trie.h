@@ -0,0 +1,119 @@
+/**
+ * @file prefix-trie.h
+ * @brief Header file for the PrefixTrie class, a longest-prefix-match table for IPv4.
+ */
+
+#ifndef PREFIXTRIE_H
+#define PREFIXTRIE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class PrefixTrie
+ * @brief Maps IPv4 addresses to the value of their longest matching prefix.
+ *
+ * The layout follows Poptrie: the top 16 bits index a direct table, and the
+ * remaining bits are consumed 6 at a time by nodes of 64 slots. A node keeps
+ * two 64-bit maps instead of 64 pointers: one marks the slots that lead to
+ * child nodes, the other marks where a run of equal results starts. Children
+ * and results are stored contiguously, so the array position of a slot is a
+ * base index plus the population count of the map below it. A lookup touches
+ * the direct table and at most three small nodes.
+ *
+ * The table is immutable once built; to change it, build a new one.
+ */
+class PrefixTrie {
+private:
+    static constexpr unsigned DIRECT_BITS = 16;     ///< Address bits resolved by the direct table.
+    static constexpr unsigned STRIDE = 6;           ///< Address bits resolved per node.
+    static constexpr uint32_t LEAF = 1u << 31;      ///< Direct-table flag for a final result.
+
+    /**
+     * @struct Node
+     * @brief A 64-slot node in compressed form.
+     */
+    struct Node {
+        uint64_t vector;    ///< Bit per slot that leads to a child node.
+        uint64_t leafvec;   ///< Bit per slot that starts a new run of results.
+        uint32_t base0;     ///< Index of the node's first result in leaves.
+        uint32_t base1;     ///< Index of the node's first child in nodes.
+    };
+
+    /**
+     * @struct BuildNode
+     * @brief A node of the binary trie the compressed form is built from.
+     */
+    struct BuildNode {
+        int32_t child[2];   ///< Index of the child for each next bit, or -1.
+        uint32_t value;     ///< Value of the prefix ending here, or NONE.
+    };
+
+    std::vector<uint32_t> direct;   ///< Result (with LEAF) or node index for each top 16 bits.
+    std::vector<Node> nodes;        ///< Compressed nodes; siblings are contiguous.
+    std::vector<uint32_t> leaves;   ///< Result runs; each node's runs are contiguous.
+
+    /**
+     * @brief Walks the binary trie through up to STRIDE bits of a slot index.
+     * @param tree Binary trie.
+     * @param from Node to start at.
+     * @param slot Slot index whose bits, most significant first, choose the path.
+     * @param bits Number of bits to follow.
+     * @param value Value of the longest prefix passed; updated along the way.
+     * @return Node reached after all bits, or -1 if the path ends sooner.
+     */
+    static int32_t walk(const std::vector<BuildNode> &tree, int32_t from, uint32_t slot,
+                        unsigned bits, uint32_t &value);
+
+    /**
+     * @brief Fills in a compressed node and, recursively, its children.
+     * @param tree Binary trie.
+     * @param index Position of the node in nodes (already allocated).
+     * @param from Binary trie node for the prefix the node covers.
+     * @param depth Address bits consumed before the node.
+     * @param value Value of the longest prefix covering the node.
+     */
+    void compile(const std::vector<BuildNode> &tree, size_t index, int32_t from,
+                 unsigned depth, uint32_t value);
+
+public:
+    /// Lookup result when no prefix matches.
+    static const uint32_t NONE = LEAF - 1;
+
+    /**
+     * @struct Prefix
+     * @brief An entry to build the table from.
+     */
+    struct Prefix {
+        uint32_t address;   ///< Network address; bits past length are ignored.
+        uint8_t length;     ///< Prefix length, 0 to 32.
+        uint32_t value;     ///< Value returned for addresses it matches best (below NONE).
+    };
+
+    /**
+     * @brief Constructs an empty table: every lookup returns NONE.
+     */
+    PrefixTrie();
+
+    /**
+     * @brief Replaces the contents with a set of prefixes.
+     * @param prefixes Prefixes; of identical ones, the last wins.
+     */
+    void build(const std::vector<Prefix> &prefixes);
+
+    /**
+     * @brief Finds the value of the longest prefix that matches an address.
+     * @param address IPv4 address, most significant octet first.
+     * @return Value, or NONE if no prefix matches.
+     */
+    uint32_t lookup(uint32_t address) const;
+
+    /**
+     * @brief Retrieves the memory held by the table.
+     * @return Size in bytes.
+     */
+    size_t memoryUsage() const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,147 @@
+/**
+ * @file rate-limiter.cpp
+ * @brief Implementation of the RateLimiter class.
+ */
+
+#include "rate-limiter.h"
+#include <algorithm>
+
+/**
+ * @brief Constructs a rate limiter.
+ * @param cfg Limit parameters; nothing is allocated unless enabled.
+ */
+RateLimiter::RateLimiter(const RateLimitConfig &cfg)
+    : config(cfg), mask(0), tracked(0), admitted(0), throttled(0), evictions(0) {
+    if (config.enabled) {
+        size_t size = PROBES;
+        while (size < config.tableSize) {
+            size *= 2;
+        }
+        config.tableSize = size;
+        table.assign(size, Bucket{0, 0.0f, 0});
+        mask = size - 1;
+    }
+}
+
+/**
+ * @brief Finds the bucket of a source, claiming or evicting a slot if it has none.
+ *
+ * Probing stops at the first empty slot: sources are never removed except by
+ * being overwritten, so one further along cannot be the same source.
+ *
+ * @param ip Source address.
+ * @return Bucket, with lastSeen still 0 if it was just claimed.
+ */
+RateLimiter::Bucket &RateLimiter::find(uint32_t ip) {
+    // Fibonacci hashing spreads neighbouring addresses across the table
+    size_t home = (size_t)(((uint64_t)ip * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    size_t oldest = home;
+    for (size_t i = 0; i < PROBES; i++) {
+        Bucket &bucket = table[(home + i) & mask];
+        if (bucket.lastSeen == 0) {
+            bucket.ip = ip;
+            tracked++;
+            return bucket;
+        }
+        if (bucket.ip == ip) {
+            return bucket;
+        }
+        if (bucket.lastSeen < table[oldest].lastSeen) {
+            oldest = (home + i) & mask;
+        }
+    }
+    evictions++;
+    Bucket &bucket = table[oldest];
+    bucket.ip = ip;
+    bucket.lastSeen = 0;
+    return bucket;
+}
+
+/**
+ * @brief Retrieves the limit parameters.
+ * @return Limit parameters, with tableSize as allocated.
+ */
+const RateLimitConfig& RateLimiter::getConfig() const {
+    return config;
+}
+
+/**
+ * @brief Checks whether arrivals are limited at all.
+ * @return True if enabled.
+ */
+bool RateLimiter::isEnabled() const {
+    return config.enabled;
+}
+
+/**
+ * @brief Removes the requests whose source is over its rate, keeping the others in order.
+ * @param rs Requests arriving at the same tick; the kept ones are moved to the front.
+ * @param n Number of requests.
+ * @param now Current simulation time; never earlier than in the previous call.
+ * @return Number of requests kept.
+ */
+size_t RateLimiter::filter(Request *rs, size_t n, size_t now) {
+    if (!config.enabled) {
+        return n;
+    }
+    uint64_t stamp = (uint64_t)now + 1;
+    size_t kept = 0;
+    for (size_t i = 0; i < n; i++) {
+        Bucket &bucket = find(rs[i].getIpIn());
+        double tokens = config.burst;
+        if (bucket.lastSeen != 0) {
+            tokens = std::min(config.burst,
+                              bucket.tokens + config.rate * (double)(stamp - bucket.lastSeen));
+        }
+        bucket.lastSeen = stamp;
+        if (tokens < 1.0) {
+            bucket.tokens = (float)tokens;
+            throttled++;
+            continue;
+        }
+        bucket.tokens = (float)(tokens - 1.0);
+        admitted++;
+        rs[kept++] = rs[i];
+    }
+    return kept;
+}
+
+/**
+ * @brief Retrieves the number of requests let through.
+ * @return Admitted requests.
+ */
+uint64_t RateLimiter::getAdmitted() const {
+    return admitted;
+}
+
+/**
+ * @brief Retrieves the number of requests dropped for exceeding their source's rate.
+ * @return Throttled requests.
+ */
+uint64_t RateLimiter::getThrottled() const {
+    return throttled;
+}
+
+/**
+ * @brief Retrieves the number of buckets evicted to make room for new sources.
+ * @return Evictions.
+ */
+uint64_t RateLimiter::getEvictions() const {
+    return evictions;
+}
+
+/**
+ * @brief Retrieves the number of sources currently tracked.
+ * @return Occupied slots.
+ */
+size_t RateLimiter::getTracked() const {
+    return tracked;
+}
+
+/**
+ * @brief Retrieves the memory held by the bucket table.
+ * @return Size in bytes.
+ */
+size_t RateLimiter::memoryUsage() const {
+    return table.size() * sizeof(Bucket);
+}
\ No newline at end of file
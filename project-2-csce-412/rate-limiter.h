@@ -0,0 +1,129 @@
+/**
+ * @file rate-limiter.h
+ * @brief Header file for the RateLimiter class that caps the request rate of each source.
+ */
+
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "request.h"
+
+/**
+ * @struct RateLimitConfig
+ * @brief Parameters of the per-source rate limit.
+ */
+struct RateLimitConfig {
+    bool enabled = false;       ///< Whether arrivals are rate limited at all.
+    double rate = 1.0;          ///< Requests per tick each source may sustain.
+    double burst = 10.0;        ///< Requests a source may send at once after being quiet.
+    size_t tableSize = 65536;   ///< Sources tracked at most; rounded up to a power of two.
+};
+
+/**
+ * @class RateLimiter
+ * @brief Throttles each source IP with its own token bucket.
+ *
+ * A bucket holds up to burst tokens and refills at rate tokens per tick; each
+ * admitted request spends one, and a request finding less than one is
+ * throttled. Refills are computed from the time of the last visit, so idle
+ * buckets cost nothing.
+ *
+ * Buckets live in a fixed-size open-addressing table, so memory does not grow
+ * with the number of distinct sources. A source may sit in any of PROBES slots
+ * after its hash; when all are taken by others, the least recently seen of
+ * them is evicted. This approximates LRU without a list to maintain, and an
+ * evicted source comes back with a full bucket, which only errs toward
+ * admitting.
+ */
+class RateLimiter {
+private:
+    static constexpr size_t PROBES = 8;     ///< Slots a source may occupy, from its hash on.
+
+    /**
+     * @struct Bucket
+     * @brief Token bucket of one source.
+     */
+    struct Bucket {
+        uint32_t ip;        ///< Source address.
+        float tokens;       ///< Tokens left at lastSeen.
+        uint64_t lastSeen;  ///< Tick of the last request plus one; 0 marks an empty slot.
+    };
+
+    RateLimitConfig config;         ///< Limit parameters.
+    std::vector<Bucket> table;      ///< Buckets; empty when disabled.
+    size_t mask;                    ///< table.size() - 1.
+    size_t tracked;                 ///< Occupied slots.
+    uint64_t admitted;              ///< Requests let through.
+    uint64_t throttled;             ///< Requests dropped.
+    uint64_t evictions;             ///< Buckets evicted to make room.
+
+    /**
+     * @brief Finds the bucket of a source, claiming or evicting a slot if it has none.
+     * @param ip Source address.
+     * @return Bucket, with lastSeen still 0 if it was just claimed.
+     */
+    Bucket &find(uint32_t ip);
+
+public:
+    /**
+     * @brief Constructs a rate limiter.
+     * @param cfg Limit parameters; nothing is allocated unless enabled.
+     */
+    explicit RateLimiter(const RateLimitConfig &cfg = RateLimitConfig());
+
+    /**
+     * @brief Retrieves the limit parameters.
+     * @return Limit parameters, with tableSize as allocated.
+     */
+    const RateLimitConfig& getConfig() const;
+
+    /**
+     * @brief Checks whether arrivals are limited at all.
+     * @return True if enabled.
+     */
+    bool isEnabled() const;
+
+    /**
+     * @brief Removes the requests whose source is over its rate, keeping the others in order.
+     * @param rs Requests arriving at the same tick; the kept ones are moved to the front.
+     * @param n Number of requests.
+     * @param now Current simulation time; never earlier than in the previous call.
+     * @return Number of requests kept.
+     */
+    size_t filter(Request *rs, size_t n, size_t now);
+
+    /**
+     * @brief Retrieves the number of requests let through.
+     * @return Admitted requests.
+     */
+    uint64_t getAdmitted() const;
+
+    /**
+     * @brief Retrieves the number of requests dropped for exceeding their source's rate.
+     * @return Throttled requests.
+     */
+    uint64_t getThrottled() const;
+
+    /**
+     * @brief Retrieves the number of buckets evicted to make room for new sources.
+     * @return Evictions.
+     */
+    uint64_t getEvictions() const;
+
+    /**
+     * @brief Retrieves the number of sources currently tracked.
+     * @return Occupied slots.
+     */
+    size_t getTracked() const;
+
+    /**
+     * @brief Retrieves the memory held by the bucket table.
+     * @return Size in bytes.
+     */
+    size_t memoryUsage() const;
+};
+
+#endif
\ No newline at end of file
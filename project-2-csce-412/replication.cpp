@@ -0,0 +1,285 @@
+/**
+ * @file replication.cpp
+ * @brief Implementation of the replication runner and its statistics.
+ */
+
+#include "replication.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include "config.h"
+#include "trace-reader.h"
+#include "worker-pool.h"
+
+namespace {
+
+const size_t MIN_REPLICATIONS = 3;  ///< Fewest replications before stopping early.
+
+/// 97.5th percentiles of Student's t for 1 to 30 degrees of freedom.
+const double T975[30] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+} // namespace
+
+/**
+ * @brief Retrieves the 97.5th percentile of Student's t distribution.
+ * 
+ * Past the table, the Cornish-Fisher expansion around the normal quantile is
+ * accurate to better than 0.001.
+ * 
+ * @param df Degrees of freedom (at least 1).
+ * @return Quantile.
+ */
+double studentT975(size_t df) {
+    if (df == 0) {
+        df = 1;
+    }
+    if (df <= 30) {
+        return T975[df - 1];
+    }
+    const double z = 1.959964;
+    double n = (double)df;
+    return z + (z * z * z + z) / (4.0 * n) +
+           (5.0 * std::pow(z, 5) + 16.0 * z * z * z + 3.0 * z) / (96.0 * n * n);
+}
+
+/**
+ * @brief Computes the 95% confidence interval of a mean.
+ * @param samples Independent observations.
+ * @return Mean and half-width; the half-width is 0 with fewer than two samples.
+ */
+ConfidenceInterval confidenceInterval(const std::vector<double> &samples) {
+    ConfidenceInterval ci;
+    size_t n = samples.size();
+    if (n == 0) {
+        return ci;
+    }
+    double sum = 0.0;
+    for (double x : samples) {
+        sum += x;
+    }
+    ci.mean = sum / (double)n;
+    if (n < 2) {
+        return ci;
+    }
+    double squares = 0.0;
+    for (double x : samples) {
+        squares += (x - ci.mean) * (x - ci.mean);
+    }
+    double stddev = std::sqrt(squares / (double)(n - 1));
+    ci.halfWidth = studentT975(n - 1) * stddev / std::sqrt((double)n);
+    return ci;
+}
+
+/**
+ * @brief Builds a load balancer for a configuration, as the binary would run it.
+ * @param config Simulation options.
+ * @param seed Random seed for this run.
+ * @param kernel Tick kernel.
+ * @return Load balancer ready to run, still logging per-event text to stdout.
+ */
+std::unique_ptr<LoadBalancer> makeLoadBalancer(const SimulationConfig &config, uint64_t seed,
+                                               TickKernel kernel) {
+    return makeLoadBalancer(config, seed, kernel, makeTrafficSource(config, seed));
+}
+
+/**
+ * @brief Builds a load balancer for a configuration around a given traffic source.
+ * @param config Simulation options.
+ * @param seed Random seed for this run.
+ * @param kernel Tick kernel.
+ * @param traffic Source of the initial queue and later arrivals.
+ * @return Load balancer ready to run, still logging per-event text to stdout.
+ */
+std::unique_ptr<LoadBalancer> makeLoadBalancer(const SimulationConfig &config, uint64_t seed,
+                                               TickKernel kernel,
+                                               std::unique_ptr<TrafficSource> traffic) {
+    std::unique_ptr<LoadBalancer> lb(
+        new LoadBalancer(config.servers, config.runTime, std::move(traffic), config.mode));
+    lb->setTickKernel(kernel);
+    lb->setScheduler(config.scheduling);
+    if (!config.fleet.empty()) {
+        lb->setFleet(config.fleet);
+    }
+    if (!config.blocklistFile.empty() || !config.allowlistFile.empty()) {
+        // Unreadable lists leave the firewall empty; callers check them up front
+        std::unique_ptr<Firewall> firewall(new Firewall());
+        std::string error;
+        firewall->load(config.blocklistFile, config.allowlistFile, error);
+        lb->setFirewall(std::move(firewall));
+    }
+    if (config.rateLimit.enabled) {
+        lb->setRateLimit(config.rateLimit);
+    }
+    if (config.admission.budget > 0.0) {
+        lb->setAdmission(config.admission);
+    }
+    if (config.failures.enabled()) {
+        lb->setFailures(config.failures, config.health, seed);
+    }
+    lb->setRoutingPolicy(makeRoutingPolicy(config.routing, seed));
+    lb->setThreads(config.threads);
+    if (config.autoscaling.enabled) {
+        lb->setAutoscaler(config.autoscaling);
+    }
+    return lb;
+}
+
+/**
+ * @brief Builds the traffic source a configuration asks for: a replayed trace or a workload.
+ * @param config Simulation options.
+ * @param seed Random seed for the workload.
+ * @return Traffic source.
+ */
+std::unique_ptr<TrafficSource> makeTrafficSource(const SimulationConfig &config, uint64_t seed) {
+    if (config.traceFile.empty()) {
+        return std::unique_ptr<TrafficSource>(
+            new Workload(RandomStreams::fromSeed(seed), config.arrivals, config.durations));
+    }
+    // An unreadable trace replays as an empty one; callers check it up front
+    std::unique_ptr<TraceReader> reader(new TraceReader());
+    std::string error;
+    reader->open(config.traceFile, error);
+    return reader;
+}
+
+/**
+ * @brief Retrieves a human-readable name for a metric.
+ * @param metric Metric.
+ * @return Name, e.g. "Throughput (requests/tick)".
+ */
+const char *Replicator::metricName(Metric metric) {
+    static const char *NAMES[METRICS] = {
+        "Throughput (requests/tick)", "Mean wait (ticks)", "p99 wait (ticks)",
+        "Final queue length", "Utilization"
+    };
+    return NAMES[metric];
+}
+
+/**
+ * @brief Retrieves the JSON key for a metric.
+ * @param metric Metric.
+ * @return Key, e.g. "throughput".
+ */
+const char *Replicator::metricKey(Metric metric) {
+    static const char *KEYS[METRICS] = {
+        "throughput", "mean_wait", "p99_wait", "final_queue", "utilization"
+    };
+    return KEYS[metric];
+}
+
+/**
+ * @brief Prepares replications of a configuration.
+ * @param cfg Configuration; replication i uses seed cfg.seed + i. Must outlive the replicator.
+ * @param k Tick kernel.
+ */
+Replicator::Replicator(const SimulationConfig &cfg, TickKernel k)
+    : config(cfg), kernel(k), converged(false) {}
+
+/**
+ * @brief Runs one replication with logging off.
+ * @param seed Seed for the replication.
+ * @return Its measurements.
+ */
+Replicator::Sample Replicator::runOne(uint64_t seed) const {
+    std::unique_ptr<LoadBalancer> lb = makeLoadBalancer(config, seed, kernel);
+    lb->setLogSink(makeLogSink(LogLevel::Off, LogFormat::Text, ""));
+    lb->run();
+
+    LatencyHistogram waits;
+    for (size_t c = 0; c < Scheduler::CLASSES; c++) {
+        waits.merge(lb->getMetrics().get(Metrics::WAIT, c));
+    }
+    Sample s;
+    s.seed = seed;
+    s.values[THROUGHPUT] = (double)lb->getCompletedRequests() /
+                           (double)std::max(lb->getCurrentTime(), (size_t)1);
+    s.values[MEAN_WAIT] = waits.mean();
+    s.values[P99_WAIT] = (double)waits.percentile(99.0);
+    s.values[FINAL_QUEUE] = (double)lb->getQueueSize();
+    s.values[UTILIZATION] = lb->getUtilization();
+    return s;
+}
+
+/**
+ * @brief Checks whether every metric's interval meets the target.
+ * 
+ * A metric that came out the same in every replication has a zero-width
+ * interval and always meets it.
+ * 
+ * @return True if the run can stop.
+ */
+bool Replicator::meetsTarget() const {
+    for (size_t m = 0; m < METRICS; m++) {
+        ConfidenceInterval ci = estimate((Metric)m);
+        if (ci.halfWidth > config.replication.ciTarget * std::fabs(ci.mean)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Runs the replications.
+ * 
+ * The calling thread takes part as one of the jobs.
+ */
+void Replicator::run() {
+    size_t total = std::max(config.replication.replications, (size_t)1);
+    size_t jobs = config.replication.jobs;
+    if (jobs == 0) {
+        jobs = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    jobs = std::min(jobs, total);
+
+    WorkerPool pool(jobs);
+    std::vector<Sample> round(jobs);
+    samples.clear();
+    converged = false;
+    for (size_t first = 0; first < total && !converged; first += jobs) {
+        size_t count = std::min(jobs, total - first);
+        pool.run([&](size_t k) {
+            if (k < count) {
+                round[k] = runOne(config.seed + first + k);
+            }
+        });
+        for (size_t k = 0; k < count && !converged; k++) {
+            samples.push_back(round[k]);
+            converged = config.replication.ciTarget > 0.0 && samples.size() >= MIN_REPLICATIONS &&
+                        meetsTarget();
+        }
+    }
+}
+
+/**
+ * @brief Retrieves the replications kept.
+ * @return Samples in seed order.
+ */
+const std::vector<Replicator::Sample>& Replicator::getSamples() const {
+    return samples;
+}
+
+/**
+ * @brief Checks whether the run stopped early on the interval target.
+ * @return True if it did.
+ */
+bool Replicator::hasConverged() const {
+    return converged;
+}
+
+/**
+ * @brief Computes the 95% confidence interval of a metric.
+ * @param metric Metric.
+ * @return Mean and half-width over the replications kept.
+ */
+ConfidenceInterval Replicator::estimate(Metric metric) const {
+    std::vector<double> values;
+    values.reserve(samples.size());
+    for (const Sample &s : samples) {
+        values.push_back(s.values[metric]);
+    }
+    return confidenceInterval(values);
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+/**
+ * @file replication.h
+ * @brief Header file for running independent replications of a simulation in parallel.
+ */
+
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "load-balancer.h"
+#include "tick-kernel.h"
+
+struct SimulationConfig;
+
+/**
+ * @struct ReplicationConfig
+ * @brief How many replications to run and when to stop.
+ */
+struct ReplicationConfig {
+    size_t replications = 1;    ///< Most replications to run; 1 runs the simulation once, as usual.
+    size_t jobs = 0;            ///< Replications run at once; 0 uses every core.
+    double ciTarget = 0.0;      ///< Stop once every 95% half-width is within this share of its mean; 0 never stops early.
+};
+
+/**
+ * @struct ConfidenceInterval
+ * @brief Sample mean and the half-width of its 95% confidence interval.
+ */
+struct ConfidenceInterval {
+    double mean = 0.0;          ///< Sample mean.
+    double halfWidth = 0.0;     ///< Half-width of the interval around the mean.
+};
+
+/**
+ * @brief Retrieves the 97.5th percentile of Student's t distribution.
+ * @param df Degrees of freedom (at least 1).
+ * @return Quantile, from a table up to 30 degrees of freedom and an expansion beyond.
+ */
+double studentT975(size_t df);
+
+/**
+ * @brief Computes the 95% confidence interval of a mean.
+ * @param samples Independent observations.
+ * @return Mean and half-width; the half-width is 0 with fewer than two samples.
+ */
+ConfidenceInterval confidenceInterval(const std::vector<double> &samples);
+
+/**
+ * @brief Builds a load balancer for a configuration, as the binary would run it.
+ * @param config Simulation options.
+ * @param seed Random seed for this run.
+ * @param kernel Tick kernel.
+ * @return Load balancer ready to run, still logging per-event text to stdout.
+ */
+std::unique_ptr<LoadBalancer> makeLoadBalancer(const SimulationConfig &config, uint64_t seed,
+                                               TickKernel kernel);
+
+/**
+ * @brief Builds a load balancer for a configuration around a given traffic source.
+ * @param config Simulation options.
+ * @param seed Random seed for this run.
+ * @param kernel Tick kernel.
+ * @param traffic Source of the initial queue and later arrivals.
+ * @return Load balancer ready to run, still logging per-event text to stdout.
+ */
+std::unique_ptr<LoadBalancer> makeLoadBalancer(const SimulationConfig &config, uint64_t seed,
+                                               TickKernel kernel,
+                                               std::unique_ptr<TrafficSource> traffic);
+
+/**
+ * @brief Builds the traffic source a configuration asks for: a replayed trace or a workload.
+ * @param config Simulation options.
+ * @param seed Random seed for the workload.
+ * @return Traffic source.
+ */
+std::unique_ptr<TrafficSource> makeTrafficSource(const SimulationConfig &config, uint64_t seed);
+
+/**
+ * @class Replicator
+ * @brief Runs replications of one configuration with consecutive seeds on a thread pool.
+ *
+ * Replications run in rounds of one per job. After each round the results are
+ * taken in seed order and the run stops at the first replication (from the
+ * third on) whose intervals all meet the target, so the replications kept and
+ * the estimates never depend on the number of jobs.
+ */
+class Replicator {
+public:
+    /**
+     * @enum Metric
+     * @brief Quantity measured on every replication.
+     */
+    enum Metric {
+        THROUGHPUT,     ///< Requests completed per tick.
+        MEAN_WAIT,      ///< Mean wait of all started requests, in ticks.
+        P99_WAIT,       ///< 99th percentile wait, in ticks.
+        FINAL_QUEUE,    ///< Requests still queued at the end.
+        UTILIZATION,    ///< Share of server-ticks spent processing requests.
+        METRICS         ///< Number of metrics.
+    };
+
+    /**
+     * @struct Sample
+     * @brief Measurements of one replication.
+     */
+    struct Sample {
+        uint64_t seed;              ///< Seed the replication ran with.
+        double values[METRICS];     ///< Value of each metric.
+    };
+
+    /**
+     * @brief Retrieves a human-readable name for a metric.
+     * @param metric Metric.
+     * @return Name, e.g. "Throughput (requests/tick)".
+     */
+    static const char *metricName(Metric metric);
+
+    /**
+     * @brief Retrieves the JSON key for a metric.
+     * @param metric Metric.
+     * @return Key, e.g. "throughput".
+     */
+    static const char *metricKey(Metric metric);
+
+private:
+    const SimulationConfig &config; ///< Configuration every replication runs.
+    TickKernel kernel;              ///< Tick kernel.
+    std::vector<Sample> samples;    ///< Replications kept, in seed order.
+    bool converged;                 ///< Whether the run stopped on the interval target.
+
+    /**
+     * @brief Runs one replication with logging off.
+     * @param seed Seed for the replication.
+     * @return Its measurements.
+     */
+    Sample runOne(uint64_t seed) const;
+
+    /**
+     * @brief Checks whether every metric's interval meets the target.
+     * @return True if the run can stop.
+     */
+    bool meetsTarget() const;
+
+public:
+    /**
+     * @brief Prepares replications of a configuration.
+     * @param cfg Configuration; replication i uses seed cfg.seed + i. Must outlive the replicator.
+     * @param k Tick kernel.
+     */
+    Replicator(const SimulationConfig &cfg, TickKernel k);
+
+    /**
+     * @brief Runs the replications.
+     */
+    void run();
+
+    /**
+     * @brief Retrieves the replications kept.
+     * @return Samples in seed order.
+     */
+    const std::vector<Sample>& getSamples() const;
+
+    /**
+     * @brief Checks whether the run stopped early on the interval target.
+     * @return True if it did.
+     */
+    bool hasConverged() const;
+
+    /**
+     * @brief Computes the 95% confidence interval of a metric.
+     * @param metric Metric.
+     * @return Mean and half-width over the replications kept.
+     */
+    ConfidenceInterval estimate(Metric metric) const;
+};
+
+#endif
\ No newline at end of file
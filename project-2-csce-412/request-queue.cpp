@@ -0,0 +1,139 @@
+/**
+ * @file request-queue.cpp
+ * @brief Implementation of the RequestQueue class.
+ */
+
+#include "request-queue.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const size_t MIN_CAPACITY = 8;   ///< Smallest buffer allocated; small so per-server queues stay cheap.
+
+}
+
+/**
+ * @brief Constructs an empty queue. No memory is allocated until the first push.
+ */
+RequestQueue::RequestQueue() : capacity(0), head(0), tail(0) {}
+
+/**
+ * @brief Moves the contents into a larger buffer.
+ * 
+ * The new capacity is the smallest power of two that is at least minCapacity and
+ * at least double the old one. Requests are unwrapped so the front lands in slot 0.
+ * 
+ * @param minCapacity Minimum number of slots required.
+ */
+void RequestQueue::grow(size_t minCapacity) {
+    size_t newCapacity = std::max(MIN_CAPACITY, capacity * 2);
+    while (newCapacity < minCapacity) {
+        newCapacity *= 2;
+    }
+
+    std::unique_ptr<Request[]> newSlots(new Request[newCapacity]);
+    size_t count = size();
+    if (count > 0) {
+        size_t start = head & (capacity - 1);
+        size_t first = std::min(count, capacity - start);
+        memcpy(&newSlots[0], &slots[start], first * sizeof(Request));
+        memcpy(&newSlots[first], &slots[0], (count - first) * sizeof(Request));
+    }
+
+    slots = std::move(newSlots);
+    capacity = newCapacity;
+    head = 0;
+    tail = count;
+}
+
+/**
+ * @brief Makes room for at least n requests in total without reallocating.
+ * @param n Number of requests the queue should be able to hold.
+ */
+void RequestQueue::reserve(size_t n) {
+    if (n > capacity) {
+        grow(n);
+    }
+}
+
+/**
+ * @brief Checks whether the queue is empty.
+ * @return True if no requests are queued.
+ */
+bool RequestQueue::empty() const {
+    return head == tail;
+}
+
+/**
+ * @brief Retrieves the number of queued requests.
+ * @return Number of queued requests.
+ */
+size_t RequestQueue::size() const {
+    return tail - head;
+}
+
+/**
+ * @brief Adds a request to the back of the queue.
+ * @param r Request to add.
+ */
+void RequestQueue::push(const Request &r) {
+    if (size() == capacity) {
+        grow(capacity + 1);
+    }
+    slots[tail & (capacity - 1)] = r;
+    tail++;
+}
+
+/**
+ * @brief Adds several requests to the back of the queue.
+ * @param rs Requests to add.
+ * @param n Number of requests.
+ */
+void RequestQueue::push(const Request *rs, size_t n) {
+    if (n == 0) {
+        return;
+    }
+    if (size() + n > capacity) {
+        grow(size() + n);
+    }
+    size_t start = tail & (capacity - 1);
+    size_t first = std::min(n, capacity - start);
+    memcpy(&slots[start], rs, first * sizeof(Request));
+    memcpy(&slots[0], rs + first, (n - first) * sizeof(Request));
+    tail += n;
+}
+
+/**
+ * @brief Retrieves the request at the front of the queue.
+ * @return Front request. The queue must not be empty.
+ */
+const Request& RequestQueue::front() const {
+    return slots[head & (capacity - 1)];
+}
+
+/**
+ * @brief Removes the request at the front of the queue.
+ */
+void RequestQueue::pop() {
+    head++;
+}
+
+/**
+ * @brief Removes up to n requests from the front of the queue.
+ * @param out Destination for the removed requests.
+ * @param n Maximum number of requests to remove.
+ * @return Number of requests removed.
+ */
+size_t RequestQueue::pop(Request *out, size_t n) {
+    n = std::min(n, size());
+    if (n == 0) {
+        return 0;
+    }
+    size_t start = head & (capacity - 1);
+    size_t first = std::min(n, capacity - start);
+    memcpy(out, &slots[start], first * sizeof(Request));
+    memcpy(out + first, &slots[0], (n - first) * sizeof(Request));
+    head += n;
+    return n;
+}
\ No newline at end of file
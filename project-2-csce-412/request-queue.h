@@ -0,0 +1,90 @@
+/**
+ * @file request-queue.h
+ * @brief Header file for the RequestQueue class.
+ */
+
+#ifndef REQUESTQUEUE_H
+#define REQUESTQUEUE_H
+
+#include <cstddef>
+#include <memory>
+#include "request.h"
+
+/**
+ * @class RequestQueue
+ * @brief FIFO queue of requests stored in a power-of-two ring buffer.
+ *
+ * All requests live in one contiguous array indexed with a mask, so push and pop
+ * are a store or load plus an increment. The buffer doubles when it fills.
+ */
+class RequestQueue {
+private:
+    std::unique_ptr<Request[]> slots;   ///< Ring storage; capacity is a power of two.
+    size_t capacity;                    ///< Number of slots.
+    size_t head;                        ///< Total number of requests ever popped.
+    size_t tail;                        ///< Total number of requests ever pushed.
+
+    /**
+     * @brief Moves the contents into a larger buffer.
+     * @param minCapacity Minimum number of slots required.
+     */
+    void grow(size_t minCapacity);
+
+public:
+    /**
+     * @brief Constructs an empty queue.
+     */
+    RequestQueue();
+
+    /**
+     * @brief Makes room for at least n requests in total without reallocating.
+     * @param n Number of requests the queue should be able to hold.
+     */
+    void reserve(size_t n);
+
+    /**
+     * @brief Checks whether the queue is empty.
+     * @return True if no requests are queued.
+     */
+    bool empty() const;
+
+    /**
+     * @brief Retrieves the number of queued requests.
+     * @return Number of queued requests.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Adds a request to the back of the queue.
+     * @param r Request to add.
+     */
+    void push(const Request &r);
+
+    /**
+     * @brief Adds several requests to the back of the queue.
+     * @param rs Requests to add.
+     * @param n Number of requests.
+     */
+    void push(const Request *rs, size_t n);
+
+    /**
+     * @brief Retrieves the request at the front of the queue.
+     * @return Front request. The queue must not be empty.
+     */
+    const Request& front() const;
+
+    /**
+     * @brief Removes the request at the front of the queue.
+     */
+    void pop();
+
+    /**
+     * @brief Removes up to n requests from the front of the queue.
+     * @param out Destination for the removed requests.
+     * @param n Maximum number of requests to remove.
+     * @return Number of requests removed.
+     */
+    size_t pop(Request *out, size_t n);
+};
+
+#endif
\ No newline at end of file
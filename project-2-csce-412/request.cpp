@@ -4,21 +4,38 @@
  */
 
 #include "request.h"
+#include <charconv>
 
 /**
  * @brief Constructs a Request with given parameters.
- * @param in Source IP address.
- * @param out Destination IP address.
+ * @param in Source IPv4 address.
+ * @param out Destination IPv4 address.
  * @param time Duration of the request.
  * @param type Type of the job.
  */
-Request::Request(const std::string &in, const std::string &out, size_t time, char type)
-    : ipIn(in), ipOut(out), duration(time), jobType(type) {}
+Request::Request(uint32_t in, uint32_t out, uint16_t time, JobType type)
+    : ipIn(in), ipOut(out), arrival(0), duration(time), jobType(type) {}
 
 /**
  * @brief Constructs a default Request object.
  */
-Request::Request() : ipIn(""), ipOut(""), duration(0), jobType('U') {}
+Request::Request() : ipIn(0), ipOut(0), arrival(0), duration(0), jobType(JobType::Unknown) {}
+
+/**
+ * @brief Retrieves the source IP address.
+ * @return Source IPv4 address.
+ */
+uint32_t Request::getIpIn() const {
+    return ipIn;
+}
+
+/**
+ * @brief Retrieves the destination IP address.
+ * @return Destination IPv4 address.
+ */
+uint32_t Request::getIpOut() const {
+    return ipOut;
+}
 
 /**
  * @brief Retrieves the duration of the request.
@@ -32,10 +49,43 @@ size_t Request::getDuration() const {
  * @brief Retrieves the job type of the request.
  * @return Job type.
  */
-char Request::getJobType() const {
+JobType Request::getJobType() const {
     return jobType;
 }
 
+/**
+ * @brief Retrieves the tick at which the request joined the queue.
+ * @return Arrival time.
+ */
+size_t Request::getArrivalTime() const {
+    return arrival;
+}
+
+/**
+ * @brief Records the tick at which the request joined the queue.
+ * @param time Arrival time.
+ */
+void Request::setArrivalTime(size_t time) {
+    arrival = (uint32_t)time;
+}
+
+/**
+ * @brief Writes an IPv4 address in dotted-quad form.
+ * @param ip Packed IPv4 address, most significant octet first.
+ * @param out Destination buffer of at least MAX_IP_LENGTH characters.
+ * @return Number of characters written (not null-terminated).
+ */
+size_t Request::formatIP(uint32_t ip, char *out) {
+    char *p = out;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        p = std::to_chars(p, out + MAX_IP_LENGTH, (ip >> shift) & 0xff).ptr;
+        if (shift > 0) {
+            *p++ = '.';
+        }
+    }
+    return p - out;
+}
+
 /**
  * @brief Overloads the stream operator for printing requests.
  * @param os Output stream.
@@ -43,7 +93,12 @@ char Request::getJobType() const {
  * @return Output stream reference.
  */
 std::ostream& operator<<(std::ostream &os, const Request &r) {
-    os << "Request(" << r.ipIn << "->" << r.ipOut
-       << ", time=" << r.duration << ", type=" << r.jobType << ")";
+    char in[Request::MAX_IP_LENGTH];
+    char out[Request::MAX_IP_LENGTH];
+    os << "Request(";
+    os.write(in, Request::formatIP(r.ipIn, in));
+    os << "->";
+    os.write(out, Request::formatIP(r.ipOut, out));
+    os << ", time=" << r.duration << ", type=" << (char)r.jobType << ")";
     return os;
 }
\ No newline at end of file
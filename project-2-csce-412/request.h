@@ -6,36 +6,66 @@
 #ifndef REQUEST_H
 #define REQUEST_H
 
-#include <string>
+#include <cstdint>
 #include <iostream>
 
+/**
+ * @enum JobType
+ * @brief Kind of job a request carries. Values are the letters used in the log.
+ */
+enum class JobType : uint8_t {
+    Unknown = 'U',  ///< No job (empty request).
+    Standard = 'S', ///< Standard job.
+    Priority = 'P'  ///< Priority job.
+};
+
 /**
  * @class Request
  * @brief Represents a network request with associated properties.
+ *
+ * Addresses are stored as packed IPv4 values so a Request is small and trivially
+ * copyable; they are only turned into dotted-quad text when the request is printed.
  */
 class Request {
 private:
-    std::string ipIn;  ///< Source IP address.
-    std::string ipOut; ///< Destination IP address.
-    size_t duration;   ///< Duration required to process the request.
-    char jobType;      ///< Type of job ('S' for simple, 'P' for priority).
+    uint32_t ipIn;      ///< Source IPv4 address.
+    uint32_t ipOut;     ///< Destination IPv4 address.
+    uint32_t arrival;   ///< Tick at which the request joined the queue; runs end before 2^32.
+    uint16_t duration;  ///< Duration required to process the request.
+    JobType jobType;    ///< Type of job (standard or priority).
 
 public:
+    /**
+     * @brief Longest dotted-quad address, in characters.
+     */
+    static const size_t MAX_IP_LENGTH = 15;
+
     /**
      * @brief Parameterized constructor for Request.
-     * @param in Source IP address.
-     * @param out Destination IP address.
+     * @param in Source IPv4 address.
+     * @param out Destination IPv4 address.
      * @param time Duration of the request.
      * @param type Type of the job.
      */
-    Request(const std::string &in, const std::string &out,
-            size_t time, char type);
+    Request(uint32_t in, uint32_t out, uint16_t time, JobType type);
 
     /**
      * @brief Default constructor for Request.
      */
     Request();
 
+    /**
+     * @brief Retrieves the source IP address.
+     * @return Source IPv4 address.
+     */
+    uint32_t getIpIn() const;
+
+    /**
+     * @brief Retrieves the destination IP address.
+     * @return Destination IPv4 address.
+     */
+    uint32_t getIpOut() const;
+
     /**
      * @brief Retrieves the duration of the request.
      * @return Duration of the request.
@@ -46,7 +76,27 @@ public:
      * @brief Retrieves the job type of the request.
      * @return Job type.
      */
-    char getJobType() const;
+    JobType getJobType() const;
+
+    /**
+     * @brief Retrieves the tick at which the request joined the queue.
+     * @return Arrival time.
+     */
+    size_t getArrivalTime() const;
+
+    /**
+     * @brief Records the tick at which the request joined the queue.
+     * @param time Arrival time.
+     */
+    void setArrivalTime(size_t time);
+
+    /**
+     * @brief Writes an IPv4 address in dotted-quad form.
+     * @param ip Packed IPv4 address.
+     * @param out Destination buffer of at least MAX_IP_LENGTH characters.
+     * @return Number of characters written (not null-terminated).
+     */
+    static size_t formatIP(uint32_t ip, char *out);
 
     /**
      * @brief Overloads the stream operator for printing requests.
@@ -57,4 +107,6 @@ public:
     friend std::ostream& operator<<(std::ostream &os, const Request &r);
 };
 
+static_assert(sizeof(Request) <= 16, "Request should stay within 16 bytes");
+
 #endif
\ No newline at end of file
@@ -0,0 +1,177 @@
+/**
+ * @file rng.cpp
+ * @brief Implementation of the random number generators.
+ */
+
+#include "rng.h"
+
+namespace {
+
+/**
+ * @brief Rotates a 64-bit value left.
+ * @param x Value to rotate.
+ * @param k Number of bits.
+ * @return Rotated value.
+ */
+inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @brief Advances a SplitMix64 state and returns the next output.
+ * @param x SplitMix64 state.
+ * @return Next output.
+ */
+uint64_t splitMix64(uint64_t &x) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief One xoshiro256** step.
+ * @param s Generator state.
+ * @return Next output.
+ */
+inline uint64_t xoshiroStep(uint64_t *s) {
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+} // namespace
+
+/**
+ * @brief Virtual destructor.
+ */
+RandomGenerator::~RandomGenerator() {}
+
+/**
+ * @brief Draws several values at once.
+ * @param out Destination array.
+ * @param n Number of values to draw.
+ */
+void RandomGenerator::fill(uint64_t *out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = next();
+    }
+}
+
+/**
+ * @brief Seeds the generator by expanding a 64-bit seed with SplitMix64.
+ * @param seed Seed value.
+ */
+Xoshiro256::Xoshiro256(uint64_t seed) {
+    for (uint64_t &word : state) {
+        word = splitMix64(seed);
+    }
+}
+
+/**
+ * @brief Draws the next value.
+ * @return Uniformly distributed 64-bit value.
+ */
+uint64_t Xoshiro256::next() {
+    return xoshiroStep(state);
+}
+
+/**
+ * @brief Draws several values at once without a virtual call per value.
+ * 
+ * The state is kept in locals for the duration of the loop.
+ * 
+ * @param out Destination array.
+ * @param n Number of values to draw.
+ */
+void Xoshiro256::fill(uint64_t *out, size_t n) {
+    uint64_t s[4] = {state[0], state[1], state[2], state[3]};
+    for (size_t i = 0; i < n; i++) {
+        out[i] = xoshiroStep(s);
+    }
+    for (int i = 0; i < 4; i++) {
+        state[i] = s[i];
+    }
+}
+
+/**
+ * @brief Advances the generator by 2^128 draws.
+ */
+void Xoshiro256::jump() {
+    static const uint64_t JUMP[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                    0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+    uint64_t s[4] = {0, 0, 0, 0};
+    for (uint64_t mask : JUMP) {
+        for (int b = 0; b < 64; b++) {
+            if (mask & ((uint64_t)1 << b)) {
+                for (int i = 0; i < 4; i++) {
+                    s[i] ^= state[i];
+                }
+            }
+            xoshiroStep(state);
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        state[i] = s[i];
+    }
+}
+
+/**
+ * @brief Maps a random value onto [0, bound) using its upper 32 bits.
+ * 
+ * Uses a multiply and shift instead of a modulo; the bias is below 2^-32 * bound.
+ * 
+ * @param draw Uniformly distributed 64-bit value.
+ * @param bound Exclusive upper limit.
+ * @return Value in [0, bound).
+ */
+uint32_t uniformBelow(uint64_t draw, uint32_t bound) {
+    return (uint32_t)(((draw >> 32) * bound) >> 32);
+}
+
+/**
+ * @brief Maps a random value onto [0, 1).
+ * @param draw Uniformly distributed 64-bit value.
+ * @return Value in [0, 1).
+ */
+double uniformUnit(uint64_t draw) {
+    return (double)(draw >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Builds the default xoshiro256** streams for a seed.
+ * @param seed Seed value.
+ * @return Streams jumped 0, 1, 2 and 3 times from the seed.
+ */
+RandomStreams RandomStreams::fromSeed(uint64_t seed) {
+    RandomStreams streams;
+    std::unique_ptr<RandomGenerator> *targets[] = {
+        &streams.arrivals, &streams.durations, &streams.addresses, &streams.jobTypes};
+
+    Xoshiro256 base(seed);
+    for (auto *target : targets) {
+        target->reset(new Xoshiro256(base));
+        base.jump();
+    }
+    return streams;
+}
+
+/**
+ * @brief Builds a further stream for a subsystem outside the workload.
+ * @param seed Seed value.
+ * @param index Stream number; 0 to 3 are the streams fromSeed() hands out.
+ * @return Generator jumped index times from the seed.
+ */
+std::unique_ptr<RandomGenerator> RandomStreams::extraStream(uint64_t seed, size_t index) {
+    std::unique_ptr<Xoshiro256> stream(new Xoshiro256(seed));
+    for (size_t i = 0; i < index; i++) {
+        stream->jump();
+    }
+    return stream;
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+/**
+ * @file rng.h
+ * @brief Random number generators used by the simulation.
+ */
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @class RandomGenerator
+ * @brief Interface for a source of uniformly distributed 64-bit values.
+ */
+class RandomGenerator {
+public:
+    /**
+     * @brief Virtual destructor.
+     */
+    virtual ~RandomGenerator();
+
+    /**
+     * @brief Draws the next value.
+     * @return Uniformly distributed 64-bit value.
+     */
+    virtual uint64_t next() = 0;
+
+    /**
+     * @brief Draws several values at once.
+     * @param out Destination array.
+     * @param n Number of values to draw.
+     */
+    virtual void fill(uint64_t *out, size_t n);
+};
+
+/**
+ * @class Xoshiro256
+ * @brief The xoshiro256** generator: fast, 256 bits of state, period 2^256 - 1.
+ */
+class Xoshiro256 : public RandomGenerator {
+private:
+    uint64_t state[4]; ///< Generator state; never all zero.
+
+public:
+    /**
+     * @brief Seeds the generator by expanding a 64-bit seed with SplitMix64.
+     * @param seed Seed value.
+     */
+    explicit Xoshiro256(uint64_t seed);
+
+    /**
+     * @brief Draws the next value.
+     * @return Uniformly distributed 64-bit value.
+     */
+    uint64_t next() override;
+
+    /**
+     * @brief Draws several values at once without a virtual call per value.
+     * @param out Destination array.
+     * @param n Number of values to draw.
+     */
+    void fill(uint64_t *out, size_t n) override;
+
+    /**
+     * @brief Advances the generator by 2^128 draws.
+     *
+     * Generators jumped different numbers of times from the same seed produce
+     * non-overlapping sequences, which makes them independent streams.
+     */
+    void jump();
+};
+
+/**
+ * @brief Maps a random value onto [0, bound) using its upper 32 bits.
+ * @param draw Uniformly distributed 64-bit value.
+ * @param bound Exclusive upper limit.
+ * @return Value in [0, bound).
+ */
+uint32_t uniformBelow(uint64_t draw, uint32_t bound);
+
+/**
+ * @brief Maps a random value onto [0, 1).
+ * @param draw Uniformly distributed 64-bit value.
+ * @return Value in [0, 1).
+ */
+double uniformUnit(uint64_t draw);
+
+/**
+ * @struct RandomStreams
+ * @brief Independent generators for each kind of random decision in the simulation.
+ *
+ * Keeping the streams separate means that, for example, changing how durations
+ * are drawn does not shift the arrival pattern.
+ */
+struct RandomStreams {
+    std::unique_ptr<RandomGenerator> arrivals;  ///< When requests arrive and how many.
+    std::unique_ptr<RandomGenerator> durations; ///< How long requests take.
+    std::unique_ptr<RandomGenerator> addresses; ///< Source and destination addresses.
+    std::unique_ptr<RandomGenerator> jobTypes;  ///< Standard or priority.
+
+    /**
+     * @brief Builds the default xoshiro256** streams for a seed.
+     * @param seed Seed value.
+     * @return Streams jumped 0, 1, 2 and 3 times from the seed.
+     */
+    static RandomStreams fromSeed(uint64_t seed);
+
+    /**
+     * @brief Builds a further stream for a subsystem outside the workload.
+     * @param seed Seed value.
+     * @param index Stream number; 0 to 3 are the streams fromSeed() hands out.
+     * @return Generator jumped index times from the seed.
+     */
+    static std::unique_ptr<RandomGenerator> extraStream(uint64_t seed, size_t index);
+};
+
+#endif
\ No newline at end of file
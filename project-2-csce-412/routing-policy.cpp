@@ -0,0 +1,393 @@
+/**
+ * @file routing-policy.cpp
+ * @brief Implementation of the RoutingPolicy classes.
+ */
+
+#include "routing-policy.h"
+#include <algorithm>
+#include "affinity-policy.h"
+
+namespace {
+
+const size_t ROUTING_STREAM = 4;    ///< Random stream number used by routing policies.
+
+} // namespace
+
+/**
+ * @brief Parses a routing policy name ("central", "round-robin", "least-work", "jsq",
+ *        "p2c", "jiq", "ring" or "maglev").
+ * @param name Policy name.
+ * @param kind Parsed kind on success.
+ * @return True if the name was recognized.
+ */
+bool parseRoutingKind(const std::string &name, RoutingKind &kind) {
+    if (name == "central") {
+        kind = RoutingKind::Central;
+    } else if (name == "round-robin") {
+        kind = RoutingKind::RoundRobin;
+    } else if (name == "least-work") {
+        kind = RoutingKind::LeastWork;
+    } else if (name == "jsq") {
+        kind = RoutingKind::ShortestQueue;
+    } else if (name == "p2c") {
+        kind = RoutingKind::PowerOfTwo;
+    } else if (name == "jiq") {
+        kind = RoutingKind::IdleQueue;
+    } else if (name == "ring") {
+        kind = RoutingKind::Ring;
+    } else if (name == "maglev") {
+        kind = RoutingKind::Maglev;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Virtual destructor.
+ */
+RoutingPolicy::~RoutingPolicy() {}
+
+/**
+ * @brief Checks whether the policy always sends a source address to the same server.
+ * @return False unless overridden.
+ */
+bool RoutingPolicy::isAffine() const {
+    return false;
+}
+
+/**
+ * @brief Ignores server speeds unless overridden.
+ * @param server Server index.
+ * @param speed Speed factor.
+ */
+void RoutingPolicy::setSpeed(size_t, double) {}
+
+/**
+ * @brief Constructs a round-robin policy.
+ */
+RoundRobinPolicy::RoundRobinPolicy() : servers(0), cursor(0) {}
+
+/**
+ * @brief Retrieves the policy's name.
+ * @return "round-robin".
+ */
+const char *RoundRobinPolicy::name() const {
+    return "round-robin";
+}
+
+/**
+ * @brief Changes the number of servers that can be picked.
+ * @param n Number of servers.
+ */
+void RoundRobinPolicy::resize(size_t n) {
+    servers = n;
+    if (cursor >= servers) {
+        cursor = 0;
+    }
+    if (!speeds.empty()) {
+        speeds.resize(n, 1.0);
+        credits.resize(n, 0.0);
+    }
+}
+
+/**
+ * @brief Ignores load updates; round-robin does not look at load.
+ * @param server Server index.
+ * @param requests Outstanding requests.
+ * @param work Outstanding work.
+ */
+void RoundRobinPolicy::update(size_t, size_t, size_t) {}
+
+/**
+ * @brief Records how fast a server works; its share of requests follows its speed.
+ * @param server Server index.
+ * @param speed Speed factor, above 0.
+ */
+void RoundRobinPolicy::setSpeed(size_t server, double speed) {
+    if (speeds.empty()) {
+        speeds.assign(servers, 1.0);
+        credits.assign(servers, 0.0);
+    }
+    if (server < servers) {
+        speeds[server] = speed;
+    }
+}
+
+/**
+ * @brief Picks the next server in turn.
+ * 
+ * With speeds set, a server reached with less than one credit earns its speed
+ * and takes the request if that brings it to one; it keeps the turn while it
+ * has a credit left.
+ * 
+ * @param r Request to route.
+ * @return Server index.
+ */
+size_t RoundRobinPolicy::pick(const Request &) {
+    if (speeds.empty()) {
+        size_t server = cursor;
+        if (++cursor == servers) {
+            cursor = 0;
+        }
+        return server;
+    }
+    for (;;) {
+        if (credits[cursor] < 1.0) {
+            credits[cursor] += speeds[cursor];
+        }
+        size_t server = cursor;
+        bool take = credits[server] >= 1.0;
+        if (take) {
+            credits[server] -= 1.0;
+        }
+        if (credits[server] < 1.0 && ++cursor == servers) {
+            cursor = 0;
+        }
+        if (take) {
+            return server;
+        }
+    }
+}
+
+/**
+ * @brief Constructs a least-loaded policy.
+ * @param work True for least outstanding work, false for join-shortest-queue.
+ */
+MinLoadPolicy::MinLoadPolicy(bool work) : byWork(work) {}
+
+/**
+ * @brief Retrieves the policy's name.
+ * @return "least-work" or "jsq".
+ */
+const char *MinLoadPolicy::name() const {
+    return byWork ? "least-work" : "jsq";
+}
+
+/**
+ * @brief Changes the number of servers that can be picked.
+ * @param n Number of servers.
+ */
+void MinLoadPolicy::resize(size_t n) {
+    loads.resize(n);
+    if (!speeds.empty()) {
+        speeds.resize(n, 1.0);
+    }
+}
+
+/**
+ * @brief Records a server's outstanding load.
+ * @param server Server index.
+ * @param requests Outstanding requests.
+ * @param work Outstanding work.
+ */
+void MinLoadPolicy::update(size_t server, size_t requests, size_t work) {
+    if (server >= loads.size()) {
+        return;
+    }
+    size_t load = byWork ? work : requests;
+    if (speeds.empty()) {
+        loads.set(server, load);
+    } else {
+        loads.set(server, (uint64_t)((double)load * SCALE / speeds[server]));
+    }
+}
+
+/**
+ * @brief Records how fast a server works; its load is divided by its speed.
+ * @param server Server index.
+ * @param speed Speed factor, above 0.
+ */
+void MinLoadPolicy::setSpeed(size_t server, double speed) {
+    if (speeds.empty()) {
+        speeds.assign(loads.size(), 1.0);
+    }
+    if (server < speeds.size()) {
+        speeds[server] = speed;
+    }
+}
+
+/**
+ * @brief Picks the least-loaded server, the lowest index on ties.
+ * @param r Request to route.
+ * @return Server index.
+ */
+size_t MinLoadPolicy::pick(const Request &) {
+    return loads.argmin();
+}
+
+/**
+ * @brief Constructs a power-of-two-choices policy.
+ * @param rng Source of the samples.
+ */
+PowerOfTwoPolicy::PowerOfTwoPolicy(std::unique_ptr<RandomGenerator> rng) : random(std::move(rng)) {}
+
+/**
+ * @brief Retrieves the policy's name.
+ * @return "p2c".
+ */
+const char *PowerOfTwoPolicy::name() const {
+    return "p2c";
+}
+
+/**
+ * @brief Changes the number of servers that can be picked.
+ * @param n Number of servers.
+ */
+void PowerOfTwoPolicy::resize(size_t n) {
+    loads.resize(n, 0);
+    if (!speeds.empty()) {
+        speeds.resize(n, 1.0);
+        cumulative.clear();
+    }
+}
+
+/**
+ * @brief Records a server's outstanding load.
+ * @param server Server index.
+ * @param requests Outstanding requests.
+ * @param work Outstanding work.
+ */
+void PowerOfTwoPolicy::update(size_t server, size_t requests, size_t) {
+    if (server < loads.size()) {
+        loads[server] = requests;
+    }
+}
+
+/**
+ * @brief Records how fast a server works; its outstanding requests are divided by its speed.
+ * @param server Server index.
+ * @param speed Speed factor, above 0.
+ */
+void PowerOfTwoPolicy::setSpeed(size_t server, double speed) {
+    if (speeds.empty()) {
+        speeds.assign(loads.size(), 1.0);
+    }
+    if (server < speeds.size()) {
+        speeds[server] = speed;
+        cumulative.clear();
+    }
+}
+
+/**
+ * @brief Samples a server with probability proportional to its speed.
+ * @param draw 32 random bits in the high half.
+ * @return Server index.
+ */
+size_t PowerOfTwoPolicy::sampleBySpeed(uint64_t draw) {
+    if (cumulative.empty()) {
+        double total = 0.0;
+        cumulative.reserve(speeds.size());
+        for (double speed : speeds) {
+            total += speed;
+            cumulative.push_back(total);
+        }
+    }
+    double point = (double)(draw >> 32) * (1.0 / 4294967296.0) * cumulative.back();
+    size_t index = std::upper_bound(cumulative.begin(), cumulative.end(), point) -
+                   cumulative.begin();
+    return std::min(index, cumulative.size() - 1);
+}
+
+/**
+ * @brief Picks the less loaded of two random servers, the first on ties.
+ * 
+ * Both samples come from one 64-bit draw, one from each half.
+ * 
+ * @param r Request to route.
+ * @return Server index.
+ */
+size_t PowerOfTwoPolicy::pick(const Request &) {
+    uint64_t draw = random->next();
+    if (!speeds.empty()) {
+        size_t a = sampleBySpeed(draw);
+        size_t b = sampleBySpeed(draw << 32);
+        return (double)loads[b] * speeds[a] < (double)loads[a] * speeds[b] ? b : a;
+    }
+    size_t a = uniformBelow(draw, (uint32_t)loads.size());
+    size_t b = uniformBelow(draw << 32, (uint32_t)loads.size());
+    return loads[b] < loads[a] ? b : a;
+}
+
+/**
+ * @brief Constructs a join-idle-queue policy.
+ * @param rng Source of fallback picks.
+ */
+IdleQueuePolicy::IdleQueuePolicy(std::unique_ptr<RandomGenerator> rng)
+    : idle(0), servers(0), random(std::move(rng)) {}
+
+/**
+ * @brief Retrieves the policy's name.
+ * @return "jiq".
+ */
+const char *IdleQueuePolicy::name() const {
+    return "jiq";
+}
+
+/**
+ * @brief Changes the number of servers that can be picked.
+ * @param n Number of servers.
+ */
+void IdleQueuePolicy::resize(size_t n) {
+    idle.resize(n);
+    servers = n;
+}
+
+/**
+ * @brief Records a server's outstanding load; a server with none joins the idle queue.
+ * @param server Server index.
+ * @param requests Outstanding requests.
+ * @param work Outstanding work.
+ */
+void IdleQueuePolicy::update(size_t server, size_t requests, size_t) {
+    if (server >= servers) {
+        return;
+    }
+    if (requests == 0) {
+        idle.insert(server);
+    } else {
+        idle.erase(server);
+    }
+}
+
+/**
+ * @brief Picks the lowest-numbered idle server, or a random server if none is idle.
+ * @param r Request to route.
+ * @return Server index.
+ */
+size_t IdleQueuePolicy::pick(const Request &) {
+    if (!idle.empty()) {
+        return idle.next(0);
+    }
+    return uniformBelow(random->next(), (uint32_t)servers);
+}
+
+/**
+ * @brief Creates a routing policy.
+ * @param cfg Policy to create and its parameters.
+ * @param seed Seed for policies that pick at random.
+ * @return New policy, or nullptr for RoutingKind::Central.
+ */
+std::unique_ptr<RoutingPolicy> makeRoutingPolicy(const RoutingConfig &cfg, uint64_t seed) {
+    switch (cfg.kind) {
+    case RoutingKind::RoundRobin:
+        return std::unique_ptr<RoutingPolicy>(new RoundRobinPolicy());
+    case RoutingKind::LeastWork:
+        return std::unique_ptr<RoutingPolicy>(new MinLoadPolicy(true));
+    case RoutingKind::ShortestQueue:
+        return std::unique_ptr<RoutingPolicy>(new MinLoadPolicy(false));
+    case RoutingKind::PowerOfTwo:
+        return std::unique_ptr<RoutingPolicy>(
+            new PowerOfTwoPolicy(RandomStreams::extraStream(seed, ROUTING_STREAM)));
+    case RoutingKind::IdleQueue:
+        return std::unique_ptr<RoutingPolicy>(
+            new IdleQueuePolicy(RandomStreams::extraStream(seed, ROUTING_STREAM)));
+    case RoutingKind::Ring:
+        return std::unique_ptr<RoutingPolicy>(new RingHashPolicy(cfg.virtualNodes));
+    case RoutingKind::Maglev:
+        return std::unique_ptr<RoutingPolicy>(new MaglevPolicy());
+    case RoutingKind::Central:
+        break;
+    }
+    return nullptr;
+}
\ No newline at end of file
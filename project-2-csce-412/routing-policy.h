@@ -0,0 +1,260 @@
+/**
+ * @file routing-policy.h
+ * @brief Header file for the RoutingPolicy classes that assign requests to servers.
+ */
+
+#ifndef ROUTINGPOLICY_H
+#define ROUTINGPOLICY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "idle-set.h"
+#include "min-tree.h"
+#include "request.h"
+#include "rng.h"
+
+/**
+ * @enum RoutingKind
+ * @brief Which routing policy to use.
+ */
+enum class RoutingKind {
+    Central,        ///< No routing: one shared queue that idle servers pull from.
+    RoundRobin,     ///< Servers in turn.
+    LeastWork,      ///< Server with the least outstanding work (sum of assigned durations).
+    ShortestQueue,  ///< Server with the fewest outstanding requests (JSQ).
+    PowerOfTwo,     ///< Shorter queue of two servers picked at random.
+    IdleQueue,      ///< Any idle server, else a random one (JIQ).
+    Ring,           ///< Consistent hashing of the source address on a ring.
+    Maglev          ///< Maglev hashing of the source address.
+};
+
+/**
+ * @struct RoutingConfig
+ * @brief Parameters of the routing policy.
+ */
+struct RoutingConfig {
+    RoutingKind kind = RoutingKind::Central;    ///< Which policy to use.
+    size_t virtualNodes = 100;                  ///< Ring: points per server.
+};
+
+/**
+ * @struct RemapEvent
+ * @brief How many client keys changed server when the fleet was resized.
+ */
+struct RemapEvent {
+    size_t time;    ///< Tick of the resize.
+    size_t from;    ///< Servers before.
+    size_t to;      ///< Servers after.
+    size_t moved;   ///< Probe keys whose server changed.
+    size_t probed;  ///< Probe keys checked.
+};
+
+/**
+ * @brief Parses a routing policy name ("central", "round-robin", "least-work", "jsq",
+ *        "p2c", "jiq", "ring" or "maglev").
+ * @param name Policy name.
+ * @param kind Parsed kind on success.
+ * @return True if the name was recognized.
+ */
+bool parseRoutingKind(const std::string &name, RoutingKind &kind);
+
+/**
+ * @class RoutingPolicy
+ * @brief Picks the server whose local queue a new request joins.
+ *
+ * The load balancer tells the policy how much work each server has outstanding
+ * (queued plus in service) whenever that changes, and asks it for a server for
+ * each request. Only servers [0, size) can be picked.
+ */
+class RoutingPolicy {
+public:
+    /**
+     * @brief Virtual destructor.
+     */
+    virtual ~RoutingPolicy();
+
+    /**
+     * @brief Retrieves the policy's name.
+     * @return Name as accepted by parseRoutingKind().
+     */
+    virtual const char *name() const = 0;
+
+    /**
+     * @brief Checks whether the policy always sends a source address to the same server.
+     *
+     * pick() of such a policy has no side effects, so it can be used to probe
+     * where keys land.
+     *
+     * @return True for session-affinity policies.
+     */
+    virtual bool isAffine() const;
+
+    /**
+     * @brief Changes the number of servers that can be picked.
+     *
+     * The load balancer calls update() for every added server afterwards.
+     *
+     * @param servers Number of servers.
+     */
+    virtual void resize(size_t servers) = 0;
+
+    /**
+     * @brief Records a server's outstanding load.
+     * @param server Server index.
+     * @param requests Requests queued on or being processed by the server.
+     * @param work Sum of the durations of those requests.
+     */
+    virtual void update(size_t server, size_t requests, size_t work) = 0;
+
+    /**
+     * @brief Records how fast a server works, for policies that weigh servers by capacity.
+     *
+     * Every server counts as speed 1 until told otherwise. The load balancer
+     * calls this after resize() and before the first update().
+     *
+     * @param server Server index.
+     * @param speed Speed factor, above 0.
+     */
+    virtual void setSpeed(size_t server, double speed);
+
+    /**
+     * @brief Picks a server for a request.
+     * @param r Request to route.
+     * @return Server index.
+     */
+    virtual size_t pick(const Request &r) = 0;
+};
+
+/**
+ * @class RoundRobinPolicy
+ * @brief Sends requests to servers in turn. O(1).
+ *
+ * With speeds set, each turn earns a server its speed in credits and every
+ * request spends one, so a server twice as fast takes two requests in a row
+ * and one half as fast takes a request every other round.
+ */
+class RoundRobinPolicy : public RoutingPolicy {
+private:
+    size_t servers;                 ///< Number of servers.
+    size_t cursor;                  ///< Next server to pick.
+    std::vector<double> speeds;     ///< Speed of each server; empty while all are 1.
+    std::vector<double> credits;    ///< Requests each server may still take this turn.
+
+public:
+    /**
+     * @brief Constructs a round-robin policy.
+     */
+    RoundRobinPolicy();
+
+    const char *name() const override;
+    void resize(size_t servers) override;
+    void update(size_t server, size_t requests, size_t work) override;
+    void setSpeed(size_t server, double speed) override;
+    size_t pick(const Request &r) override;
+};
+
+/**
+ * @class MinLoadPolicy
+ * @brief Sends requests to the least-loaded server, by request count or by work. O(log n).
+ *
+ * With speeds set, load is divided by speed, so servers are compared by how
+ * long they would take to get through what they hold.
+ */
+class MinLoadPolicy : public RoutingPolicy {
+private:
+    static constexpr double SCALE = 1024.0; ///< Fixed-point scale of speed-weighted loads.
+
+    MinTree loads;                  ///< Load of each server.
+    bool byWork;                    ///< Whether load is outstanding work rather than outstanding requests.
+    std::vector<double> speeds;     ///< Speed of each server; empty while all are 1.
+
+public:
+    /**
+     * @brief Constructs a least-loaded policy.
+     * @param work True for least outstanding work, false for join-shortest-queue.
+     */
+    explicit MinLoadPolicy(bool work);
+
+    const char *name() const override;
+    void resize(size_t servers) override;
+    void update(size_t server, size_t requests, size_t work) override;
+    void setSpeed(size_t server, double speed) override;
+    size_t pick(const Request &r) override;
+};
+
+/**
+ * @class PowerOfTwoPolicy
+ * @brief Samples two servers at random and picks the one with fewer outstanding requests.
+ *        O(1), or O(log n) with speeds set.
+ *
+ * With speeds set, servers are sampled in proportion to their speed and their
+ * outstanding requests are divided by speed before comparing; sampling
+ * uniformly would send a quarter of the traffic to two slow servers whenever
+ * half the fleet is slow.
+ */
+class PowerOfTwoPolicy : public RoutingPolicy {
+private:
+    std::vector<size_t> loads;                  ///< Outstanding requests of each server.
+    std::vector<double> speeds;                 ///< Speed of each server; empty while all are 1.
+    std::vector<double> cumulative;             ///< Running sums of speeds; empty when stale.
+
+    /**
+     * @brief Samples a server with probability proportional to its speed.
+     * @param draw 32 random bits in the high half.
+     * @return Server index.
+     */
+    size_t sampleBySpeed(uint64_t draw);
+    std::unique_ptr<RandomGenerator> random;    ///< Source of the samples.
+
+public:
+    /**
+     * @brief Constructs a power-of-two-choices policy.
+     * @param rng Source of the samples.
+     */
+    explicit PowerOfTwoPolicy(std::unique_ptr<RandomGenerator> rng);
+
+    const char *name() const override;
+    void resize(size_t servers) override;
+    void update(size_t server, size_t requests, size_t work) override;
+    void setSpeed(size_t server, double speed) override;
+    size_t pick(const Request &r) override;
+};
+
+/**
+ * @class IdleQueuePolicy
+ * @brief Join-idle-queue: sends requests to an idle server if there is one, else a random one.
+ *
+ * Servers with nothing outstanding are kept in an IdleSet, so finding one is
+ * O(1) amortized and needs no scan of the fleet.
+ */
+class IdleQueuePolicy : public RoutingPolicy {
+private:
+    IdleSet idle;                               ///< Servers with nothing outstanding.
+    size_t servers;                             ///< Number of servers.
+    std::unique_ptr<RandomGenerator> random;    ///< Source of fallback picks.
+
+public:
+    /**
+     * @brief Constructs a join-idle-queue policy.
+     * @param rng Source of fallback picks.
+     */
+    explicit IdleQueuePolicy(std::unique_ptr<RandomGenerator> rng);
+
+    const char *name() const override;
+    void resize(size_t servers) override;
+    void update(size_t server, size_t requests, size_t work) override;
+    size_t pick(const Request &r) override;
+};
+
+/**
+ * @brief Creates a routing policy.
+ * @param cfg Policy to create and its parameters.
+ * @param seed Seed for policies that pick at random.
+ * @return New policy, or nullptr for RoutingKind::Central.
+ */
+std::unique_ptr<RoutingPolicy> makeRoutingPolicy(const RoutingConfig &cfg, uint64_t seed);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,237 @@
+/**
+ * @file scheduler.cpp
+ * @brief Implementation of the Scheduler class.
+ */
+
+#include "scheduler.h"
+#include <algorithm>
+
+/**
+ * @brief Parses a scheduling policy name ("fifo", "strict" or "wfq").
+ * @param name Policy name.
+ * @param policy Parsed policy on success.
+ * @return True if the name was recognized.
+ */
+bool parseSchedulingPolicy(const std::string &name, SchedulingPolicy &policy) {
+    if (name == "fifo") {
+        policy = SchedulingPolicy::Fifo;
+    } else if (name == "strict") {
+        policy = SchedulingPolicy::Strict;
+    } else if (name == "wfq") {
+        policy = SchedulingPolicy::WeightedFair;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Maps a job type to its class index (0 = priority, 1 = standard).
+ * @param type Job type.
+ * @return Class index.
+ */
+size_t Scheduler::classOf(JobType type) {
+    return type == JobType::Priority ? 0 : 1;
+}
+
+/**
+ * @brief Maps a class index back to its job type.
+ * @param cls Class index.
+ * @return Job type.
+ */
+JobType Scheduler::classType(size_t cls) {
+    return cls == 0 ? JobType::Priority : JobType::Standard;
+}
+
+/**
+ * @brief Constructs an empty scheduler.
+ * @param cfg Scheduling parameters.
+ */
+Scheduler::Scheduler(const SchedulerConfig &cfg) : virtualTime(0.0) {
+    configure(cfg);
+}
+
+/**
+ * @brief Changes the scheduling parameters, moving queued requests to their new lanes.
+ * 
+ * Queued requests are merged back into arrival order before being re-laned, so
+ * switching policy never reorders requests of the same class.
+ * 
+ * @param cfg Scheduling parameters.
+ */
+void Scheduler::configure(const SchedulerConfig &cfg) {
+    std::vector<Request> queued = drain();
+    config = cfg;
+    weights[0] = cfg.priorityWeight;
+    weights[1] = cfg.standardWeight;
+    for (size_t c = 0; c < CLASSES; c++) {
+        laneTags[c] = 0.0;
+    }
+    virtualTime = 0.0;
+    push(queued.data(), queued.size());
+}
+
+/**
+ * @brief Removes every queued request.
+ * @return Removed requests in arrival order.
+ */
+std::vector<Request> Scheduler::drain() {
+    std::vector<Request> queued(size());
+    size_t n = 0;
+    for (RequestQueue &lane : lanes) {
+        n += lane.pop(queued.data() + n, lane.size());
+    }
+    std::stable_sort(queued.begin(), queued.end(), [](const Request &a, const Request &b) {
+        return a.getArrivalTime() < b.getArrivalTime();
+    });
+    return queued;
+}
+
+/**
+ * @brief Retrieves the scheduling parameters.
+ * @return Scheduling parameters.
+ */
+const SchedulerConfig& Scheduler::getConfig() const {
+    return config;
+}
+
+/**
+ * @brief Makes room for at least n more requests without reallocating.
+ * 
+ * Under FIFO everything shares the first lane; otherwise each lane is sized for
+ * the whole batch, since the class mix is not known in advance.
+ * 
+ * @param n Number of requests.
+ */
+void Scheduler::reserve(size_t n) {
+    size_t used = config.policy == SchedulingPolicy::Fifo ? 1 : CLASSES;
+    for (size_t c = 0; c < used; c++) {
+        lanes[c].reserve(lanes[c].size() + n);
+    }
+}
+
+/**
+ * @brief Checks whether any request is waiting.
+ * @return True if every lane is empty.
+ */
+bool Scheduler::empty() const {
+    for (const RequestQueue &lane : lanes) {
+        if (!lane.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Retrieves the number of waiting requests.
+ * @return Number of waiting requests.
+ */
+size_t Scheduler::size() const {
+    size_t total = 0;
+    for (const RequestQueue &lane : lanes) {
+        total += lane.size();
+    }
+    return total;
+}
+
+/**
+ * @brief Queues a request. Its arrival time must already be set.
+ * @param r Request to queue.
+ */
+void Scheduler::push(const Request &r) {
+    if (config.policy == SchedulingPolicy::Fifo) {
+        lanes[0].push(r);
+    } else {
+        lanes[classOf(r.getJobType())].push(r);
+    }
+}
+
+/**
+ * @brief Queues several requests. Their arrival times must already be set.
+ * @param rs Requests to queue.
+ * @param n Number of requests.
+ */
+void Scheduler::push(const Request *rs, size_t n) {
+    if (config.policy == SchedulingPolicy::Fifo) {
+        lanes[0].push(rs, n);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        lanes[classOf(rs[i].getJobType())].push(rs[i]);
+    }
+}
+
+/**
+ * @brief Computes the weighted fair finish tag of a lane's front request.
+ * @param lane Lane index. The lane must not be empty.
+ * @return Finish tag.
+ */
+double Scheduler::finishTag(size_t lane) const {
+    double start = std::max(laneTags[lane], virtualTime);
+    return start + (double)lanes[lane].front().getDuration() / weights[lane];
+}
+
+/**
+ * @brief Picks the lane the next request comes from.
+ * 
+ * The policy picks a lane first. With aging on, a lower lane whose front request
+ * has waited at least the limit, and arrived before the picked lane's front
+ * request, takes its place.
+ * 
+ * @param now Current simulation time.
+ * @return Lane index. At least one lane must be non-empty.
+ */
+size_t Scheduler::pickLane(size_t now) const {
+    if (config.policy == SchedulingPolicy::Fifo) {
+        return 0;
+    }
+
+    size_t pick = CLASSES;
+    double bestTag = 0.0;
+    for (size_t c = 0; c < CLASSES; c++) {
+        if (lanes[c].empty()) {
+            continue;
+        }
+        if (config.policy == SchedulingPolicy::Strict) {
+            pick = c;
+            break;
+        }
+        double tag = finishTag(c);
+        if (pick == CLASSES || tag < bestTag) {
+            pick = c;
+            bestTag = tag;
+        }
+    }
+
+    if (config.agingLimit > 0) {
+        for (size_t c = pick + 1; c < CLASSES; c++) {
+            if (lanes[c].empty()) {
+                continue;
+            }
+            size_t arrival = lanes[c].front().getArrivalTime();
+            if (now - arrival >= config.agingLimit &&
+                arrival < lanes[pick].front().getArrivalTime()) {
+                pick = c;
+            }
+        }
+    }
+    return pick;
+}
+
+/**
+ * @brief Removes the next request to run.
+ * @param now Current simulation time.
+ * @return Next request. The scheduler must not be empty.
+ */
+Request Scheduler::pop(size_t now) {
+    size_t lane = pickLane(now);
+    if (config.policy == SchedulingPolicy::WeightedFair) {
+        laneTags[lane] = finishTag(lane);
+        virtualTime = laneTags[lane];
+    }
+
+    Request r = lanes[lane].front();
+    lanes[lane].pop();
+    return r;
+}
\ No newline at end of file
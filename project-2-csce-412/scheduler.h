@@ -0,0 +1,162 @@
+/**
+ * @file scheduler.h
+ * @brief Header file for the Scheduler class that decides which queued request runs next.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "request-queue.h"
+
+/**
+ * @enum SchedulingPolicy
+ * @brief How the scheduler picks between the per-class lanes.
+ */
+enum class SchedulingPolicy {
+    Fifo,           ///< One lane; requests run in arrival order regardless of class.
+    Strict,         ///< Priority requests always run before standard ones.
+    WeightedFair    ///< Lanes share servers in proportion to their weights.
+};
+
+/**
+ * @struct SchedulerConfig
+ * @brief Parameters of the scheduling policy.
+ */
+struct SchedulerConfig {
+    SchedulingPolicy policy = SchedulingPolicy::Fifo;   ///< How lanes are picked.
+    double priorityWeight = 3.0;                        ///< Weighted fair: share of the priority lane.
+    double standardWeight = 1.0;                        ///< Weighted fair: share of the standard lane.
+    size_t agingLimit = 0;                              ///< Wait after which a standard request
+                                                        ///< is served like a priority one; 0 = never.
+};
+
+/**
+ * @brief Parses a scheduling policy name ("fifo", "strict" or "wfq").
+ * @param name Policy name.
+ * @param policy Parsed policy on success.
+ * @return True if the name was recognized.
+ */
+bool parseSchedulingPolicy(const std::string &name, SchedulingPolicy &policy);
+
+/**
+ * @class Scheduler
+ * @brief Queues waiting requests in one lane per job class and picks the next to run.
+ *
+ * Each lane is a FIFO ring buffer, so within a class requests always run in
+ * arrival order and picking a lane is a comparison of the lane heads. Weighted
+ * fair queuing uses self-clocked finish tags: a lane's next request is tagged
+ * with the lane's previous tag (or the scheduler's virtual time, whichever is
+ * later) plus its duration divided by the lane weight, and the smallest tag
+ * runs. Aging lets a standard request that has waited past the limit run ahead
+ * of younger priority requests, so neither policy can starve the standard lane.
+ */
+class Scheduler {
+public:
+    /**
+     * @brief Number of job classes, and of lanes.
+     */
+    static const size_t CLASSES = 2;
+
+    /**
+     * @brief Maps a job type to its class index (0 = priority, 1 = standard).
+     * @param type Job type.
+     * @return Class index.
+     */
+    static size_t classOf(JobType type);
+
+    /**
+     * @brief Maps a class index back to its job type.
+     * @param cls Class index.
+     * @return Job type.
+     */
+    static JobType classType(size_t cls);
+
+private:
+    SchedulerConfig config;                 ///< Scheduling parameters.
+    RequestQueue lanes[CLASSES];            ///< Waiting requests, one lane per class.
+    double weights[CLASSES];                ///< Weighted fair: lane weights.
+    double laneTags[CLASSES];               ///< Weighted fair: finish tag of each lane's last request.
+    double virtualTime;                     ///< Weighted fair: finish tag of the last request served.
+
+    /**
+     * @brief Picks the lane the next request comes from.
+     * @param now Current simulation time.
+     * @return Lane index. At least one lane must be non-empty.
+     */
+    size_t pickLane(size_t now) const;
+
+    /**
+     * @brief Computes the weighted fair finish tag of a lane's front request.
+     * @param lane Lane index. The lane must not be empty.
+     * @return Finish tag.
+     */
+    double finishTag(size_t lane) const;
+
+public:
+    /**
+     * @brief Constructs an empty scheduler.
+     * @param cfg Scheduling parameters.
+     */
+    explicit Scheduler(const SchedulerConfig &cfg = SchedulerConfig());
+
+    /**
+     * @brief Changes the scheduling parameters, moving queued requests to their new lanes.
+     * @param cfg Scheduling parameters.
+     */
+    void configure(const SchedulerConfig &cfg);
+
+    /**
+     * @brief Retrieves the scheduling parameters.
+     * @return Scheduling parameters.
+     */
+    const SchedulerConfig& getConfig() const;
+
+    /**
+     * @brief Makes room for at least n more requests without reallocating.
+     * @param n Number of requests.
+     */
+    void reserve(size_t n);
+
+    /**
+     * @brief Checks whether any request is waiting.
+     * @return True if every lane is empty.
+     */
+    bool empty() const;
+
+    /**
+     * @brief Retrieves the number of waiting requests.
+     * @return Number of waiting requests.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Queues a request. Its arrival time must already be set.
+     * @param r Request to queue.
+     */
+    void push(const Request &r);
+
+    /**
+     * @brief Queues several requests. Their arrival times must already be set.
+     * @param rs Requests to queue.
+     * @param n Number of requests.
+     */
+    void push(const Request *rs, size_t n);
+
+    /**
+     * @brief Removes every queued request.
+     * @return Removed requests in arrival order.
+     */
+    std::vector<Request> drain();
+
+    /**
+     * @brief Removes the next request to run.
+     * @param now Current simulation time.
+     * @return Next request. The scheduler must not be empty.
+     */
+    Request pop(size_t now);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,70 @@
+/**
+ * @file server-class.cpp
+ * @brief Implementation of fleet parsing.
+ */
+
+#include "server-class.h"
+#include <cstdlib>
+#include <sstream>
+
+/**
+ * @brief Parses a fleet description: comma-separated "name:count[:speed[:slots]]" groups.
+ * @param text Fleet description, e.g. "fast:4:2:4,slow:16".
+ * @param fleet Parsed classes on success, in order.
+ * @return True if every group was valid.
+ */
+bool parseFleet(const std::string &text, std::vector<ServerClass> &fleet) {
+    std::vector<ServerClass> parsed;
+    std::istringstream groups(text);
+    std::string group;
+    while (std::getline(groups, group, ',')) {
+        std::istringstream fields(group);
+        std::vector<std::string> parts;
+        std::string part;
+        while (std::getline(fields, part, ':')) {
+            parts.push_back(part);
+        }
+        if (parts.size() < 2 || parts.size() > 4 || parts[0].empty()) {
+            return false;
+        }
+
+        ServerClass cls;
+        cls.name = parts[0];
+        char *end;
+        cls.count = std::strtoul(parts[1].c_str(), &end, 10);
+        if (parts[1].empty() || *end != '\0' || parts[1][0] == '-') {
+            return false;
+        }
+        if (parts.size() > 2) {
+            cls.speed = std::strtod(parts[2].c_str(), &end);
+            if (parts[2].empty() || *end != '\0' || !(cls.speed > 0.0)) {
+                return false;
+            }
+        }
+        if (parts.size() > 3) {
+            cls.slots = std::strtoul(parts[3].c_str(), &end, 10);
+            if (parts[3].empty() || *end != '\0' || parts[3][0] == '-' || cls.slots == 0) {
+                return false;
+            }
+        }
+        parsed.push_back(cls);
+    }
+    if (parsed.empty() || fleetSlots(parsed) == 0) {
+        return false;
+    }
+    fleet = parsed;
+    return true;
+}
+
+/**
+ * @brief Counts the slots of a fleet, i.e. the entries it takes in the server pool.
+ * @param fleet Server classes.
+ * @return Sum of count * slots.
+ */
+size_t fleetSlots(const std::vector<ServerClass> &fleet) {
+    size_t slots = 0;
+    for (const ServerClass &cls : fleet) {
+        slots += cls.count * cls.slots;
+    }
+    return slots;
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+/**
+ * @file server-class.h
+ * @brief Header file for server classes, the hardware kinds a mixed fleet is built from.
+ */
+
+#ifndef SERVERCLASS_H
+#define SERVERCLASS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @struct ServerClass
+ * @brief A group of identical servers in a mixed fleet.
+ *
+ * A server with several slots runs that many requests side by side, each at the
+ * full speed; in the server pool every slot is an entry of its own. The speed
+ * divides request durations, so a request of duration d takes ceil(d / speed)
+ * ticks.
+ */
+struct ServerClass {
+    std::string name;       ///< Name used in reports.
+    size_t count = 0;       ///< Number of servers.
+    double speed = 1.0;     ///< Work done per tick, relative to a standard server.
+    size_t slots = 1;       ///< Requests each server runs at once.
+};
+
+/**
+ * @brief Parses a fleet description: comma-separated "name:count[:speed[:slots]]" groups.
+ * @param text Fleet description, e.g. "fast:4:2:4,slow:16".
+ * @param fleet Parsed classes on success, in order.
+ * @return True if every group was valid.
+ */
+bool parseFleet(const std::string &text, std::vector<ServerClass> &fleet);
+
+/**
+ * @brief Counts the slots of a fleet, i.e. the entries it takes in the server pool.
+ * @param fleet Server classes.
+ * @return Sum of count * slots.
+ */
+size_t fleetSlots(const std::vector<ServerClass> &fleet);
+
+#endif
\ No newline at end of file
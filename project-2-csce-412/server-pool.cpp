@@ -0,0 +1,247 @@
+/**
+ * @file server-pool.cpp
+ * @brief Implementation of the ServerPool class.
+ */
+
+#include "server-pool.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Constructs a pool of idle servers using the fastest available tick kernel.
+ * @param count Number of servers.
+ */
+ServerPool::ServerPool(size_t count)
+    : busy(count, 0), remaining(count, 0), requests(count), started(count, 0), speeds(count, 1.0),
+      finished((count + 63) / 64, 0) {
+    selectTickKernel("auto", kernel);
+}
+
+/**
+ * @brief Retrieves the number of servers.
+ * @return Number of servers.
+ */
+size_t ServerPool::size() const {
+    return busy.size();
+}
+
+/**
+ * @brief Adds idle servers to the end of the pool or removes servers from the end.
+ * @param count New number of servers. Removed servers must be idle.
+ */
+void ServerPool::resize(size_t count) {
+    busy.resize(count, 0);
+    remaining.resize(count, 0);
+    requests.resize(count);
+    started.resize(count, 0);
+    speeds.resize(count, 1.0);
+    finished.resize((count + 63) / 64, 0);
+    if (names.size() > count) {
+        names.resize(count);
+    }
+}
+
+/**
+ * @brief Selects the kernel used to advance servers each tick.
+ * @param k Tick kernel.
+ */
+void ServerPool::setTickKernel(TickKernel k) {
+    kernel = k;
+}
+
+/**
+ * @brief Retrieves the kernel used to advance servers each tick.
+ * @return Tick kernel.
+ */
+TickKernel ServerPool::getTickKernel() const {
+    return kernel;
+}
+
+/**
+ * @brief Advances every busy server by one tick.
+ * 
+ * A busy server loses one tick and stops being busy when none are left; the
+ * servers that stop are recorded in the finished bitmask.
+ * 
+ * @return Number of servers that finished their request on this tick.
+ */
+size_t ServerPool::tick() {
+    return tick(0, busy.size());
+}
+
+/**
+ * @brief Advances the busy servers in a range by one tick.
+ * @param begin First server; a multiple of 64.
+ * @param end One past the last server.
+ * @return Number of servers in the range that finished their request.
+ */
+size_t ServerPool::tick(size_t begin, size_t end) {
+    if (begin >= end) {
+        return 0;
+    }
+    return kernel(busy.data() + begin, remaining.data() + begin, end - begin,
+                  finished.data() + begin / 64);
+}
+
+/**
+ * @brief Retrieves the servers that finished on the last call to tick().
+ * @return Bitmask with one bit per server, 64 servers per word.
+ */
+const std::vector<uint64_t>& ServerPool::getFinished() const {
+    return finished;
+}
+
+/**
+ * @brief Advances one server by a number of ticks.
+ * @param index Server index.
+ * @param ticks Number of ticks.
+ */
+void ServerPool::advance(size_t index, size_t ticks) {
+    if (busy[index]) {
+        remaining[index] -= (uint32_t)std::min<size_t>(ticks, remaining[index]);
+        busy[index] = remaining[index] != 0;
+    }
+}
+
+/**
+ * @brief Retrieves how many ticks a server's request has left.
+ * @param index Server index.
+ * @return Remaining ticks (zero when idle).
+ */
+size_t ServerPool::getRemaining(size_t index) const {
+    return remaining[index];
+}
+
+/**
+ * @brief Counts the servers that are processing a request.
+ * @return Number of busy servers.
+ */
+size_t ServerPool::countBusy() const {
+    size_t count = 0;
+    for (uint32_t b : busy) {
+        count += b;
+    }
+    return count;
+}
+
+/**
+ * @brief Checks if a server is busy.
+ * @param index Server index.
+ * @return True if the server is busy.
+ */
+bool ServerPool::isBusy(size_t index) const {
+    return busy[index] != 0;
+}
+
+/**
+ * @brief Checks if a server holds a request it has finished processing.
+ * @param index Server index.
+ * @return True if the request is finished but not yet cleared.
+ */
+bool ServerPool::hasRequestFinished(size_t index) const {
+    return !busy[index] && requests[index].getDuration() != 0;
+}
+
+/**
+ * @brief Assigns a new request to a server; it takes ceil(duration / speed) ticks.
+ * 
+ * A zero-length request still occupies the server for one tick.
+ * 
+ * @param index Server index.
+ * @param r Request to process.
+ */
+void ServerPool::setRequest(size_t index, const Request &r) {
+    requests[index] = r;
+    busy[index] = 1;
+    size_t ticks = r.getDuration();
+    if (speeds[index] != 1.0) {
+        ticks = (size_t)std::ceil((double)ticks / speeds[index]);
+    }
+    remaining[index] = (uint32_t)std::max<size_t>(ticks, 1);
+}
+
+/**
+ * @brief Sets how much work a server does per tick (1 by default).
+ * @param index Server index.
+ * @param speed Speed factor, above 0. Applies from the next request on.
+ */
+void ServerPool::setSpeed(size_t index, double speed) {
+    speeds[index] = speed;
+}
+
+/**
+ * @brief Retrieves how much work a server does per tick.
+ * @param index Server index.
+ * @return Speed factor.
+ */
+double ServerPool::getSpeed(size_t index) const {
+    return speeds[index];
+}
+
+/**
+ * @brief Retrieves the request held by a server.
+ * @param index Server index.
+ * @return Current request.
+ */
+const Request& ServerPool::getRequest(size_t index) const {
+    return requests[index];
+}
+
+/**
+ * @brief Records the tick at which a server's request started.
+ * 
+ * Start times are kept in 32 bits, which validateConfig() guarantees by
+ * rejecting runs of 2^32 ticks or more; completeShard() relies on them
+ * adding up exactly with the remaining ticks.
+ * 
+ * @param index Server index.
+ * @param time Start time, below 2^32.
+ */
+void ServerPool::setStartTime(size_t index, size_t time) {
+    started[index] = (uint32_t)time;
+}
+
+/**
+ * @brief Retrieves the tick at which a server's request started.
+ * @param index Server index.
+ * @return Start time.
+ */
+size_t ServerPool::getStartTime(size_t index) const {
+    return started[index];
+}
+
+/**
+ * @brief Clears a server's request after completion.
+ * @param index Server index.
+ */
+void ServerPool::clearRequest(size_t index) {
+    requests[index] = Request();
+    remaining[index] = 0;
+}
+
+/**
+ * @brief Stops a server's request before it finishes, e.g. because the server crashed.
+ * 
+ * The server is left idle with no request, as if it had never started one.
+ * 
+ * @param index Server index.
+ */
+void ServerPool::abortRequest(size_t index) {
+    busy[index] = 0;
+    clearRequest(index);
+}
+
+/**
+ * @brief Retrieves the name of a server.
+ * @param index Server index.
+ * @return Server name ("Server" followed by the index).
+ */
+const std::string& ServerPool::getName(size_t index) const {
+    if (names.size() < busy.size()) {
+        names.resize(busy.size());
+    }
+    if (names[index].empty()) {
+        names[index] = "Server" + std::to_string(index);
+    }
+    return names[index];
+}
\ No newline at end of file
@@ -0,0 +1,186 @@
+/**
+ * @file server-pool.h
+ * @brief Header file for the ServerPool class.
+ */
+
+#ifndef SERVERPOOL_H
+#define SERVERPOOL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "request.h"
+#include "tick-kernel.h"
+
+/**
+ * @class ServerPool
+ * @brief Stores the state of every server as a structure of arrays.
+ *
+ * The per-tick sweep only needs to know whether a server is busy and how many
+ * ticks its request has left, so those live in their own dense arrays (8 bytes
+ * per server). The request being served, the tick it started and the server name
+ * are kept apart and are only touched when a request starts, finishes or is logged.
+ */
+class ServerPool {
+private:
+    std::vector<uint32_t> busy;                 ///< 1 while a server is processing a request.
+    std::vector<uint32_t> remaining;            ///< Ticks left on each server's request.
+    std::vector<Request> requests;              ///< Request held by each server.
+    std::vector<uint32_t> started;              ///< Tick each server's request started; < 2^32.
+    std::vector<double> speeds;                 ///< Work each server does per tick; 1 by default.
+    mutable std::vector<std::string> names;     ///< Names, built the first time they are asked for.
+    std::vector<uint64_t> finished;             ///< Bitmask of servers that finished on the last tick.
+    TickKernel kernel;                          ///< Kernel used by tick().
+
+public:
+    /**
+     * @brief Constructs a pool of idle servers.
+     * @param count Number of servers.
+     */
+    explicit ServerPool(size_t count);
+
+    /**
+     * @brief Retrieves the number of servers.
+     * @return Number of servers.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Adds idle servers to the end of the pool or removes servers from the end.
+     * @param count New number of servers. Removed servers must be idle.
+     */
+    void resize(size_t count);
+
+    /**
+     * @brief Selects the kernel used to advance servers each tick.
+     * @param k Tick kernel.
+     */
+    void setTickKernel(TickKernel k);
+
+    /**
+     * @brief Retrieves the kernel used to advance servers each tick.
+     * @return Tick kernel.
+     */
+    TickKernel getTickKernel() const;
+
+    /**
+     * @brief Advances every busy server by one tick.
+     * @return Number of servers that finished their request on this tick.
+     */
+    size_t tick();
+
+    /**
+     * @brief Advances the busy servers in a range by one tick.
+     *
+     * Only the finished words covering the range are written, so threads can
+     * tick disjoint ranges whose starts are multiples of 64 at the same time.
+     *
+     * @param begin First server; a multiple of 64.
+     * @param end One past the last server.
+     * @return Number of servers in the range that finished their request.
+     */
+    size_t tick(size_t begin, size_t end);
+
+    /**
+     * @brief Retrieves the servers that finished on the last call to tick().
+     * @return Bitmask with one bit per server, 64 servers per word.
+     */
+    const std::vector<uint64_t>& getFinished() const;
+
+    /**
+     * @brief Advances one server by a number of ticks.
+     * @param index Server index.
+     * @param ticks Number of ticks.
+     */
+    void advance(size_t index, size_t ticks);
+
+    /**
+     * @brief Retrieves how many ticks a server's request has left.
+     * @param index Server index.
+     * @return Remaining ticks (zero when idle).
+     */
+    size_t getRemaining(size_t index) const;
+
+    /**
+     * @brief Counts the servers that are processing a request.
+     * @return Number of busy servers.
+     */
+    size_t countBusy() const;
+
+    /**
+     * @brief Checks if a server is busy.
+     * @param index Server index.
+     * @return True if the server is busy.
+     */
+    bool isBusy(size_t index) const;
+
+    /**
+     * @brief Checks if a server holds a request it has finished processing.
+     * @param index Server index.
+     * @return True if the request is finished but not yet cleared.
+     */
+    bool hasRequestFinished(size_t index) const;
+
+    /**
+     * @brief Assigns a new request to a server; it takes ceil(duration / speed) ticks.
+     * @param index Server index.
+     * @param r Request to process.
+     */
+    void setRequest(size_t index, const Request &r);
+
+    /**
+     * @brief Sets how much work a server does per tick (1 by default).
+     * @param index Server index.
+     * @param speed Speed factor, above 0. Applies from the next request on.
+     */
+    void setSpeed(size_t index, double speed);
+
+    /**
+     * @brief Retrieves how much work a server does per tick.
+     * @param index Server index.
+     * @return Speed factor.
+     */
+    double getSpeed(size_t index) const;
+
+    /**
+     * @brief Retrieves the request held by a server.
+     * @param index Server index.
+     * @return Current request.
+     */
+    const Request& getRequest(size_t index) const;
+
+    /**
+     * @brief Records the tick at which a server's request started.
+     * @param index Server index.
+     * @param time Start time, below 2^32.
+     */
+    void setStartTime(size_t index, size_t time);
+
+    /**
+     * @brief Retrieves the tick at which a server's request started.
+     * @param index Server index.
+     * @return Start time.
+     */
+    size_t getStartTime(size_t index) const;
+
+    /**
+     * @brief Clears a server's request after completion.
+     * @param index Server index.
+     */
+    void clearRequest(size_t index);
+
+    /**
+     * @brief Stops a server's request before it finishes, e.g. because the server crashed.
+     * @param index Server index.
+     */
+    void abortRequest(size_t index);
+
+    /**
+     * @brief Retrieves the name of a server.
+     * @param index Server index.
+     * @return Server name ("Server" followed by the index).
+     */
+    const std::string& getName(size_t index) const;
+};
+
+#endif
\ No newline at end of file
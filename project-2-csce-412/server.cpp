@@ -6,18 +6,27 @@
 #include "server.h"
 
 /**
- * @brief Constructs a Server with a given name.
- * @param name Name of the server.
+ * @brief Constructs a handle to a server in a pool.
+ * @param owner Pool holding the server.
+ * @param i Index of the server within the pool.
  */
-Server::Server(const std::string &name)
-    : serverName(name), busy(false), timeSpent(0) {}
+Server::Server(ServerPool &owner, size_t i)
+    : pool(&owner), index(i) {}
+
+/**
+ * @brief Retrieves the index of the server within its pool.
+ * @return Server index.
+ */
+size_t Server::getIndex() const {
+    return index;
+}
 
 /**
  * @brief Checks if the server is busy.
  * @return True if the server is busy, otherwise false.
  */
 bool Server::isBusy() const {
-    return busy;
+    return pool->isBusy(index);
 }
 
 /**
@@ -25,21 +34,19 @@ bool Server::isBusy() const {
  * @param r Request to process.
  */
 void Server::setRequest(const Request &r) {
-    currentReq = r;
-    busy = true;
-    timeSpent = 0;
+    pool->setRequest(index, r);
 }
 
 /**
- * @brief Processes the current request for one time step.
+ * @brief Processes the current request for a number of time steps.
+ * 
+ * The event-driven engine calls this once per request with the whole duration
+ * instead of once per tick.
+ * 
+ * @param ticks Number of time steps to advance.
  */
-void Server::handleRequest() {
-    if (busy) {
-        timeSpent++;
-        if (timeSpent >= currentReq.getDuration()) {
-            busy = false;
-        }
-    }
+void Server::handleRequest(size_t ticks) {
+    pool->advance(index, ticks);
 }
 
 /**
@@ -47,15 +54,14 @@ void Server::handleRequest() {
  * @return True if the request is finished, otherwise false.
  */
 bool Server::hasRequestFinished() const {
-    return (!busy && currentReq.getDuration() != 0);
+    return pool->hasRequestFinished(index);
 }
 
 /**
  * @brief Clears the current request after completion.
  */
 void Server::clearCurrentRequest() {
-    currentReq = Request();
-    timeSpent = 0;
+    pool->clearRequest(index);
 }
 
 /**
@@ -63,7 +69,7 @@ void Server::clearCurrentRequest() {
  * @return Current request.
  */
 const Request& Server::getCurrentRequest() const {
-    return currentReq;
+    return pool->getRequest(index);
 }
 
 /**
@@ -71,5 +77,5 @@ const Request& Server::getCurrentRequest() const {
  * @return Name of the server.
  */
 const std::string& Server::getName() const {
-    return serverName;
-}
+    return pool->getName(index);
+}
\ No newline at end of file
@@ -9,24 +9,33 @@
 #include <iostream>
 #include <string>
 #include "request.h"
+#include "server-pool.h"
 
 /**
  * @class Server
  * @brief Represents a server that processes requests.
+ *
+ * A Server is a lightweight handle onto one slot of a ServerPool, which holds the
+ * actual state. Copies refer to the same server.
  */
 class Server {
 private:
-    std::string serverName; ///< Name of the server.
-    Request currentReq;     ///< The current request being processed.
-    bool busy;              ///< Indicates whether the server is busy.
-    size_t timeSpent;       ///< Time spent on the current request.
+    ServerPool *pool;   ///< Pool holding the server's state.
+    size_t index;       ///< Index of the server within the pool.
 
 public:
     /**
-     * @brief Constructs a Server with a given name.
-     * @param name Name of the server.
+     * @brief Constructs a handle to a server in a pool.
+     * @param owner Pool holding the server.
+     * @param i Index of the server within the pool.
      */
-    Server(const std::string &name);
+    Server(ServerPool &owner, size_t i);
+
+    /**
+     * @brief Retrieves the index of the server within its pool.
+     * @return Server index.
+     */
+    size_t getIndex() const;
 
     /**
      * @brief Checks if the server is busy.
@@ -41,9 +50,10 @@ public:
     void setRequest(const Request &r);
 
     /**
-     * @brief Processes the current request for one time step.
+     * @brief Processes the current request for a number of time steps.
+     * @param ticks Number of time steps to advance (defaults to one).
      */
-    void handleRequest();
+    void handleRequest(size_t ticks = 1);
 
     /**
      * @brief Retrieves the name of the server.
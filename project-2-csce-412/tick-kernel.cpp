@@ -0,0 +1,174 @@
+/**
+ * @file tick-kernel.cpp
+ * @brief Scalar, SSE4.2 and AVX2 tick kernels, selected at runtime.
+ * 
+ * The vector kernels are compiled with per-function target attributes, so the
+ * binary runs on any x86-64 CPU and only uses the wider paths when available.
+ */
+
+#include "tick-kernel.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TICK_KERNEL_X86 1
+#endif
+
+namespace {
+
+/**
+ * @brief Advances servers [start, n) one at a time, setting their finished bits.
+ * @param busy Busy flags.
+ * @param remaining Ticks left on each server's request.
+ * @param start First server to process.
+ * @param n Number of servers.
+ * @param finished Bitmask of finished servers (already zeroed).
+ * @return Number of servers that finished.
+ */
+size_t tickTail(uint32_t *busy, uint32_t *remaining, size_t start, size_t n, uint64_t *finished) {
+    size_t count = 0;
+    for (size_t i = start; i < n; i++) {
+        uint32_t left = remaining[i] - busy[i];
+        uint32_t done = busy[i] & (uint32_t)(left == 0);
+        remaining[i] = left;
+        busy[i] ^= done;
+        finished[i / 64] |= (uint64_t)done << (i % 64);
+        count += done;
+    }
+    return count;
+}
+
+} // namespace
+
+/**
+ * @brief Portable reference implementation of the tick kernel.
+ * @param busy Busy flags (0 or 1), one per server.
+ * @param remaining Ticks left on each server's request.
+ * @param n Number of servers.
+ * @param finished Output bitmask of servers that finished on this tick.
+ * @return Number of servers that finished.
+ */
+size_t tickScalar(uint32_t *busy, uint32_t *remaining, size_t n, uint64_t *finished) {
+    memset(finished, 0, (n + 63) / 64 * sizeof(uint64_t));
+    return tickTail(busy, remaining, 0, n, finished);
+}
+
+#ifdef TICK_KERNEL_X86
+
+/**
+ * @brief SSE4.2 implementation of the tick kernel (four servers per step).
+ * @param busy Busy flags (0 or 1), one per server.
+ * @param remaining Ticks left on each server's request.
+ * @param n Number of servers.
+ * @param finished Output bitmask of servers that finished on this tick.
+ * @return Number of servers that finished.
+ */
+__attribute__((target("sse4.2")))
+size_t tickSSE42(uint32_t *busy, uint32_t *remaining, size_t n, uint64_t *finished) {
+    memset(finished, 0, (n + 63) / 64 * sizeof(uint64_t));
+    const __m128i zero = _mm_setzero_si128();
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i b = _mm_loadu_si128((const __m128i *)(busy + i));
+        __m128i left = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(remaining + i)), b);
+        // done = busy && left == 0; busy flags are 0 or 1, so !busy == (b == 0)
+        __m128i done = _mm_andnot_si128(_mm_cmpeq_epi32(b, zero), _mm_cmpeq_epi32(left, zero));
+        _mm_storeu_si128((__m128i *)(remaining + i), left);
+        _mm_storeu_si128((__m128i *)(busy + i), _mm_andnot_si128(done, b));
+        unsigned bits = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(done));
+        finished[i / 64] |= (uint64_t)bits << (i % 64);
+        count += __builtin_popcount(bits);
+    }
+    return count + tickTail(busy, remaining, i, n, finished);
+}
+
+/**
+ * @brief AVX2 implementation of the tick kernel (eight servers per step).
+ * @param busy Busy flags (0 or 1), one per server.
+ * @param remaining Ticks left on each server's request.
+ * @param n Number of servers.
+ * @param finished Output bitmask of servers that finished on this tick.
+ * @return Number of servers that finished.
+ */
+__attribute__((target("avx2")))
+size_t tickAVX2(uint32_t *busy, uint32_t *remaining, size_t n, uint64_t *finished) {
+    memset(finished, 0, (n + 63) / 64 * sizeof(uint64_t));
+    const __m256i zero = _mm256_setzero_si256();
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i b = _mm256_loadu_si256((const __m256i *)(busy + i));
+        __m256i left = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(remaining + i)), b);
+        __m256i done = _mm256_andnot_si256(_mm256_cmpeq_epi32(b, zero),
+                                           _mm256_cmpeq_epi32(left, zero));
+        _mm256_storeu_si256((__m256i *)(remaining + i), left);
+        _mm256_storeu_si256((__m256i *)(busy + i), _mm256_andnot_si256(done, b));
+        unsigned bits = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(done));
+        finished[i / 64] |= (uint64_t)bits << (i % 64);
+        count += __builtin_popcount(bits);
+    }
+    return count + tickTail(busy, remaining, i, n, finished);
+}
+
+#else
+
+/**
+ * @brief Falls back to the scalar kernel on non-x86 targets.
+ */
+size_t tickSSE42(uint32_t *busy, uint32_t *remaining, size_t n, uint64_t *finished) {
+    return tickScalar(busy, remaining, n, finished);
+}
+
+/**
+ * @brief Falls back to the scalar kernel on non-x86 targets.
+ */
+size_t tickAVX2(uint32_t *busy, uint32_t *remaining, size_t n, uint64_t *finished) {
+    return tickScalar(busy, remaining, n, finished);
+}
+
+#endif
+
+/**
+ * @brief Picks a tick kernel by name, or the fastest one the CPU supports.
+ * @param name "auto", "avx2", "sse4.2" or "scalar".
+ * @param kernel Selected kernel on success.
+ * @return False if the name is unknown or the CPU lacks the instruction set.
+ */
+bool selectTickKernel(const std::string &name, TickKernel &kernel) {
+    bool hasAVX2 = false;
+    bool hasSSE42 = false;
+#ifdef TICK_KERNEL_X86
+    __builtin_cpu_init();
+    hasAVX2 = __builtin_cpu_supports("avx2");
+    hasSSE42 = __builtin_cpu_supports("sse4.2");
+#endif
+
+    if (name == "auto") {
+        kernel = hasAVX2 ? tickAVX2 : hasSSE42 ? tickSSE42 : tickScalar;
+    } else if (name == "avx2" && hasAVX2) {
+        kernel = tickAVX2;
+    } else if (name == "sse4.2" && hasSSE42) {
+        kernel = tickSSE42;
+    } else if (name == "scalar") {
+        kernel = tickScalar;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Retrieves the name of a tick kernel.
+ * @param kernel Kernel to describe.
+ * @return Kernel name.
+ */
+const char *tickKernelName(TickKernel kernel) {
+    if (kernel == tickAVX2) {
+        return "avx2";
+    }
+    if (kernel == tickSSE42) {
+        return "sse4.2";
+    }
+    return "scalar";
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+/**
+ * @file tick-kernel.h
+ * @brief Kernels that advance every server by one tick.
+ */
+
+#ifndef TICKKERNEL_H
+#define TICKKERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Advances every busy server by one tick.
+ *
+ * For each server i with busy[i] set, remaining[i] is decremented; servers that
+ * reach zero have busy[i] cleared and bit i set in finished. finished must hold
+ * (n + 63) / 64 words and is overwritten.
+ *
+ * @param busy Busy flags (0 or 1), one per server.
+ * @param remaining Ticks left on each server's request.
+ * @param n Number of servers.
+ * @param finished Output bitmask of servers that finished on this tick.
+ * @return Number of servers that finished.
+ */
+typedef size_t (*TickKernel)(uint32_t *busy, uint32_t *remaining, size_t n, uint64_t *finished);
+
+/**
+ * @brief Portable reference implementation of the tick kernel.
+ * @param busy Busy flags (0 or 1), one per server.
+ * @param remaining Ticks left on each server's request.
+ * @param n Number of servers.
+ * @param finished Output bitmask of servers that finished on this tick.
+ * @return Number of servers that finished.
+ */
+size_t tickScalar(uint32_t *busy, uint32_t *remaining, size_t n, uint64_t *finished);
+
+/**
+ * @brief SSE4.2 implementation of the tick kernel (four servers per step).
+ * @param busy Busy flags (0 or 1), one per server.
+ * @param remaining Ticks left on each server's request.
+ * @param n Number of servers.
+ * @param finished Output bitmask of servers that finished on this tick.
+ * @return Number of servers that finished.
+ */
+size_t tickSSE42(uint32_t *busy, uint32_t *remaining, size_t n, uint64_t *finished);
+
+/**
+ * @brief AVX2 implementation of the tick kernel (eight servers per step).
+ * @param busy Busy flags (0 or 1), one per server.
+ * @param remaining Ticks left on each server's request.
+ * @param n Number of servers.
+ * @param finished Output bitmask of servers that finished on this tick.
+ * @return Number of servers that finished.
+ */
+size_t tickAVX2(uint32_t *busy, uint32_t *remaining, size_t n, uint64_t *finished);
+
+/**
+ * @brief Picks a tick kernel by name, or the fastest one the CPU supports.
+ * @param name "auto", "avx2", "sse4.2" or "scalar".
+ * @param kernel Selected kernel on success.
+ * @return False if the name is unknown or the CPU lacks the instruction set.
+ */
+bool selectTickKernel(const std::string &name, TickKernel &kernel);
+
+/**
+ * @brief Retrieves the name of a tick kernel.
+ * @param kernel Kernel to describe.
+ * @return Kernel name.
+ */
+const char *tickKernelName(TickKernel kernel);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,173 @@
+/**
+ * @file timing-wheel.cpp
+ * @brief Implementation of the TimingWheel class.
+ */
+
+#include "timing-wheel.h"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @brief Constructs an empty wheel at tick 0.
+ */
+TimingWheel::TimingWheel() : now(0), count(0) {
+    std::memset(occupied, 0, sizeof(occupied));
+}
+
+/**
+ * @brief Files a timer on the level and slot that match its distance from now.
+ *
+ * The level is the highest 8-bit digit in which the timer's tick differs from
+ * the current one, so every timer on a level lies in the current block of the
+ * level above.
+ *
+ * @param timer Timer, not earlier than now.
+ */
+void TimingWheel::place(const Timer &timer) {
+    size_t differs = timer.time ^ now;
+    size_t level = differs == 0 ? 0 : (63 - __builtin_clzll(differs)) / BITS;
+    if (level >= LEVELS) {
+        overflow.push_back(timer);
+        return;
+    }
+    size_t slot = (timer.time >> (level * BITS)) & (SLOTS - 1);
+    slots[level][slot].push_back(timer);
+    occupied[level][slot / 64] |= (uint64_t)1 << (slot % 64);
+}
+
+/**
+ * @brief Finds the first non-empty slot of a level at or after a slot.
+ * @param level Level.
+ * @param from First slot to consider.
+ * @return Slot index, or SLOTS if there is none.
+ */
+size_t TimingWheel::firstOccupied(size_t level, size_t from) const {
+    for (size_t w = from / 64; w < SLOTS / 64; w++) {
+        uint64_t bits = occupied[level][w];
+        if (w == from / 64) {
+            bits &= ~(uint64_t)0 << (from % 64);
+        }
+        if (bits != 0) {
+            return w * 64 + __builtin_ctzll(bits);
+        }
+    }
+    return SLOTS;
+}
+
+/**
+ * @brief Finds the earliest time in a list of timers.
+ * @param timers Non-empty list.
+ * @return Earliest time.
+ */
+size_t TimingWheel::earliest(const std::vector<Timer> &timers) {
+    size_t time = timers[0].time;
+    for (const Timer &timer : timers) {
+        time = std::min(time, timer.time);
+    }
+    return time;
+}
+
+/**
+ * @brief Adds a timer.
+ * @param time Tick at which it fires, not earlier than the current tick.
+ * @param id Identifier reported when it fires.
+ */
+void TimingWheel::insert(size_t time, size_t id) {
+    place({time, id});
+    count++;
+}
+
+/**
+ * @brief Finds the tick of the earliest pending timer.
+ *
+ * On level 0 the slot gives the tick directly. Higher levels only give a block,
+ * so the earliest timer in the first non-empty slot is looked up; the clock
+ * reaches that block next, which redistributes the slot anyway.
+ *
+ * @return Tick, or NONE if no timer is pending.
+ */
+size_t TimingWheel::nextTime() const {
+    if (count == 0) {
+        return NONE;
+    }
+    size_t slot = firstOccupied(0, now & (SLOTS - 1));
+    if (slot < SLOTS) {
+        return (now & ~(SLOTS - 1)) | slot;
+    }
+    for (size_t level = 1; level < LEVELS; level++) {
+        slot = firstOccupied(level, ((now >> (level * BITS)) & (SLOTS - 1)) + 1);
+        if (slot < SLOTS) {
+            return earliest(slots[level][slot]);
+        }
+    }
+    return earliest(overflow);
+}
+
+/**
+ * @brief Moves the clock forward and collects the timers firing on the new tick.
+ *
+ * For each level whose block changes, the slot of the new block is emptied
+ * onto the levels below, highest level first. Slots between the old and the
+ * new block are empty, since no timer is earlier than the new tick.
+ *
+ * @param time New tick, no later than nextTime().
+ * @param due Identifiers of the fired timers are appended here, in no particular order.
+ */
+void TimingWheel::advance(size_t time, std::vector<size_t> &due) {
+    size_t previous = now;
+    now = time;
+    if (count == 0) {
+        return;
+    }
+
+    if (!overflow.empty() && (previous >> (LEVELS * BITS)) != (time >> (LEVELS * BITS))) {
+        std::vector<Timer> waiting;
+        waiting.swap(overflow);
+        for (const Timer &timer : waiting) {
+            place(timer);
+        }
+    }
+    for (size_t level = LEVELS - 1; level > 0; level--) {
+        if ((previous >> (level * BITS)) == (time >> (level * BITS))) {
+            continue;
+        }
+        size_t slot = (time >> (level * BITS)) & (SLOTS - 1);
+        if (slots[level][slot].empty()) {
+            continue;
+        }
+        std::vector<Timer> moving;
+        moving.swap(slots[level][slot]);
+        occupied[level][slot / 64] &= ~((uint64_t)1 << (slot % 64));
+        for (const Timer &timer : moving) {
+            place(timer);
+        }
+        // Hand the storage back so the slot does not allocate next time around
+        moving.clear();
+        slots[level][slot].swap(moving);
+    }
+
+    size_t slot = time & (SLOTS - 1);
+    std::vector<Timer> &firing = slots[0][slot];
+    for (const Timer &timer : firing) {
+        due.push_back(timer.id);
+    }
+    count -= firing.size();
+    firing.clear();
+    occupied[0][slot / 64] &= ~((uint64_t)1 << (slot % 64));
+}
+
+/**
+ * @brief Retrieves the number of pending timers.
+ * @return Number of timers.
+ */
+size_t TimingWheel::size() const {
+    return count;
+}
+
+/**
+ * @brief Checks whether no timer is pending.
+ * @return True if the wheel is empty.
+ */
+bool TimingWheel::empty() const {
+    return count == 0;
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+/**
+ * @file timing-wheel.h
+ * @brief Header file for the TimingWheel class.
+ */
+
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class TimingWheel
+ * @brief Hierarchical timing wheel: timers keyed on a tick, inserted and expired in O(1).
+ *
+ * Level l has 256 slots, each spanning 256^l ticks. A timer goes on the lowest
+ * level whose slots tell it apart from the current tick: level 0 holds the
+ * timers of the current 256-tick block, one slot per tick; level 1 those of the
+ * current 65536-tick block, one slot per 256-tick block; and so on. Moving the
+ * clock into a new block redistributes that block's slot to the levels below,
+ * so each timer is touched at most once per level. Timers too far ahead for the
+ * top level wait in an overflow list. Occupancy bitmaps find the next timer
+ * without walking empty slots.
+ */
+class TimingWheel {
+private:
+    static constexpr size_t BITS = 8;               ///< Slot index bits per level.
+    static constexpr size_t SLOTS = 1 << BITS;      ///< Slots per level.
+    static constexpr size_t LEVELS = 4;             ///< Levels before the overflow list.
+
+    /**
+     * @struct Timer
+     * @brief A pending timer.
+     */
+    struct Timer {
+        size_t time;    ///< Tick at which the timer fires.
+        size_t id;      ///< Caller's identifier.
+    };
+
+    std::vector<Timer> slots[LEVELS][SLOTS];        ///< Timers by level and slot.
+    uint64_t occupied[LEVELS][SLOTS / 64];          ///< Bit per non-empty slot.
+    std::vector<Timer> overflow;                    ///< Timers beyond the top level.
+    size_t now;                                     ///< Current tick.
+    size_t count;                                   ///< Number of pending timers.
+
+    /**
+     * @brief Files a timer on the level and slot that match its distance from now.
+     * @param timer Timer, not earlier than now.
+     */
+    void place(const Timer &timer);
+
+    /**
+     * @brief Finds the first non-empty slot of a level at or after a slot.
+     * @param level Level.
+     * @param from First slot to consider.
+     * @return Slot index, or SLOTS if there is none.
+     */
+    size_t firstOccupied(size_t level, size_t from) const;
+
+    /**
+     * @brief Finds the earliest time in a list of timers.
+     * @param timers Non-empty list.
+     * @return Earliest time.
+     */
+    static size_t earliest(const std::vector<Timer> &timers);
+
+public:
+    /// Returned by nextTime() when no timer is pending.
+    static const size_t NONE = SIZE_MAX;
+
+    /**
+     * @brief Constructs an empty wheel at tick 0.
+     */
+    TimingWheel();
+
+    /**
+     * @brief Adds a timer.
+     * @param time Tick at which it fires, not earlier than the current tick.
+     * @param id Identifier reported when it fires.
+     */
+    void insert(size_t time, size_t id);
+
+    /**
+     * @brief Finds the tick of the earliest pending timer.
+     * @return Tick, or NONE if no timer is pending.
+     */
+    size_t nextTime() const;
+
+    /**
+     * @brief Moves the clock forward and collects the timers firing on the new tick.
+     * @param time New tick, no later than nextTime().
+     * @param due Identifiers of the fired timers are appended here, in no particular order.
+     */
+    void advance(size_t time, std::vector<size_t> &due);
+
+    /**
+     * @brief Retrieves the number of pending timers.
+     * @return Number of timers.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Checks whether no timer is pending.
+     * @return True if the wheel is empty.
+     */
+    bool empty() const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,457 @@
+/**
+ * @file trace-reader.cpp
+ * @brief Implementation of the TraceReader class.
+ */
+
+#include "trace-reader.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief Reads a little-endian 32-bit value.
+ * @param p First byte.
+ * @return Value.
+ */
+uint32_t readUint32(const char *p) {
+    const unsigned char *b = (const unsigned char *)p;
+    return (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24;
+}
+
+/**
+ * @brief Checks whether a character separates text fields.
+ * @param c Character.
+ * @return True for spaces, tabs and commas.
+ */
+bool isSeparator(char c) {
+    return c == ' ' || c == '\t' || c == ',';
+}
+
+/**
+ * @brief Splits the next field off a line.
+ * @param p Current position; moved past the field.
+ * @param end End of the line.
+ * @param field Start of the field.
+ * @return One past the end of the field (equal to field if the line has no more fields).
+ */
+const char *nextField(const char *&p, const char *end, const char *&field) {
+    while (p < end && isSeparator(*p)) {
+        p++;
+    }
+    field = p;
+    while (p < end && !isSeparator(*p)) {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * @brief Parses a whole field as an unsigned number.
+ * @param begin Start of the field.
+ * @param end End of the field.
+ * @param value Parsed value.
+ * @return True if the field is a number and nothing else.
+ */
+bool parseNumber(const char *begin, const char *end, uint64_t &value) {
+    auto result = std::from_chars(begin, end, value);
+    return begin < end && result.ec == std::errc() && result.ptr == end;
+}
+
+/**
+ * @brief Parses a dotted-quad or integer IPv4 address.
+ * @param begin Start of the field.
+ * @param end End of the field.
+ * @param ip Packed address, most significant octet first.
+ * @return True if the field is a valid address.
+ */
+bool parseIP(const char *begin, const char *end, uint32_t &ip) {
+    uint64_t value;
+    if (parseNumber(begin, end, value)) {
+        ip = (uint32_t)value;
+        return value <= UINT32_MAX;
+    }
+    ip = 0;
+    const char *p = begin;
+    for (int octet = 0; octet < 4; octet++) {
+        unsigned part;
+        auto result = std::from_chars(p, end, part);
+        if (result.ec != std::errc() || result.ptr == p || part > 255) {
+            return false;
+        }
+        ip = ip << 8 | part;
+        p = result.ptr;
+        if (octet < 3) {
+            if (p == end || *p != '.') {
+                return false;
+            }
+            p++;
+        }
+    }
+    return p == end;
+}
+
+/**
+ * @brief Decodes an unsigned LEB128 varint.
+ * @param p Current position; moved past the varint.
+ * @param end End of the input.
+ * @param value Decoded value.
+ * @return False if the input ends inside the varint or it is too long.
+ */
+bool readVarint(const char *&p, const char *end, size_t &value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        unsigned char byte = (unsigned char)*p++;
+        value |= (size_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a reader with no trace open (an empty trace).
+ */
+TraceReader::TraceReader()
+    : data(nullptr), size(0), format(Format::Text), cursor(0), lastTime(0), released(0),
+      burstTime(0), records(0), skipped(0) {}
+
+/**
+ * @brief Destructor. Unmaps the trace.
+ */
+TraceReader::~TraceReader() {
+    close();
+}
+
+/**
+ * @brief Maps a trace file and detects its format.
+ *
+ * Binary traces start with the magic "LBTR" and a version (1 for fixed-width
+ * records, 2 for compact ones behind a config header); anything else is text.
+ * The mapping is advised as sequential so the kernel reads ahead aggressively.
+ *
+ * @param path Trace file path.
+ * @param error Description of the problem on failure.
+ * @return True if the trace can be replayed.
+ */
+bool TraceReader::open(const std::string &path, std::string &error) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open trace " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        error = "cannot read trace " + path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    size_t length = (size_t)info.st_size;
+    if (length > 0) {
+        void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            error = "cannot map trace " + path + ": " + std::strerror(errno);
+            ::close(fd);
+            return false;
+        }
+        madvise(mapped, length, MADV_SEQUENTIAL);
+        data = (const char *)mapped;
+        size = length;
+    }
+    ::close(fd);
+
+    if (size < 4 || std::memcmp(data, "LBTR", 4) != 0) {
+        return true;
+    }
+    uint32_t version = size >= HEADER_SIZE ? readUint32(data + 4) : 0;
+    if (version == 1) {
+        format = Format::Fixed;
+        cursor = HEADER_SIZE;
+    } else if (version == 2 && size >= HEADER_SIZE + 4 &&
+               readUint32(data + HEADER_SIZE) <= size - HEADER_SIZE - 4) {
+        format = Format::Compact;
+        size_t length = readUint32(data + HEADER_SIZE);
+        header.assign(data + HEADER_SIZE + 4, length);
+        cursor = HEADER_SIZE + 4 + length;
+    } else {
+        error = "unsupported binary trace version in " + path;
+        close();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Unmaps the trace, leaving an empty one.
+ */
+void TraceReader::close() {
+    if (data) {
+        munmap((void *)data, size);
+    }
+    data = nullptr;
+    size = 0;
+    format = Format::Text;
+    header.clear();
+    cursor = 0;
+    lastTime = 0;
+    released = 0;
+    burstTime = 0;
+    records = 0;
+    skipped = 0;
+}
+
+/**
+ * @brief Parses a text line into a request.
+ * @param begin First character of the line.
+ * @param end One past the last character (excluding the newline).
+ * @param r Parsed request.
+ * @param time Parsed arrival tick.
+ * @return Outcome.
+ */
+TraceReader::Parsed TraceReader::parseLine(const char *begin, const char *end, Request &r,
+                                           size_t &time) {
+    if (end > begin && end[-1] == '\r') {
+        end--;
+    }
+    const char *p = begin;
+    const char *field;
+    const char *fieldEnd = nextField(p, end, field);
+    if (field == fieldEnd || *field == '#') {
+        return Parsed::Blank;
+    }
+
+    uint64_t arrival, duration;
+    uint32_t in, out;
+    if (!parseNumber(field, fieldEnd, arrival)) {
+        return Parsed::Malformed;
+    }
+    fieldEnd = nextField(p, end, field);
+    if (!parseIP(field, fieldEnd, in)) {
+        return Parsed::Malformed;
+    }
+    fieldEnd = nextField(p, end, field);
+    if (!parseIP(field, fieldEnd, out)) {
+        return Parsed::Malformed;
+    }
+    fieldEnd = nextField(p, end, field);
+    if (!parseNumber(field, fieldEnd, duration) || duration == 0 || duration > UINT16_MAX) {
+        return Parsed::Malformed;
+    }
+    fieldEnd = nextField(p, end, field);
+    if (fieldEnd - field != 1 || (*field != 'P' && *field != 'S')) {
+        return Parsed::Malformed;
+    }
+    JobType type = (JobType)*field;
+    if (nextField(p, end, field) != field) {
+        return Parsed::Malformed;
+    }
+
+    r = Request(in, out, (uint16_t)duration, type);
+    time = (size_t)arrival;
+    return Parsed::Record;
+}
+
+/**
+ * @brief Parses the record at an offset and moves the offset past it.
+ * @param offset Offset of the record (below size); updated to the next record.
+ * @param r Parsed request.
+ * @param time Arrival tick of the previous record on entry (compact traces
+ *        store deltas), and of this record on return.
+ * @return Outcome.
+ */
+TraceReader::Parsed TraceReader::parseRecord(size_t &offset, Request &r, size_t &time) const {
+    const char *begin = data + offset;
+    if (format == Format::Text) {
+        const char *newline = (const char *)std::memchr(begin, '\n', size - offset);
+        const char *end = newline ? newline : data + size;
+        offset = newline ? (size_t)(newline - data) + 1 : size;
+        return parseLine(begin, end, r, time);
+    }
+
+    if (format == Format::Compact) {
+        // A damaged varint loses the framing, so the rest of the trace is dropped
+        const char *p = begin;
+        const char *end = data + size;
+        size_t delta, packed;
+        if (!readVarint(p, end, delta) || end - p < 8) {
+            offset = size;
+            return Parsed::Malformed;
+        }
+        uint32_t in = readUint32(p);
+        uint32_t out = readUint32(p + 4);
+        p += 8;
+        if (!readVarint(p, end, packed)) {
+            offset = size;
+            return Parsed::Malformed;
+        }
+        offset = (size_t)(p - data);
+        time += delta;
+        size_t duration = packed >> 1;
+        if (duration == 0 || duration > UINT16_MAX) {
+            return Parsed::Malformed;
+        }
+        r = Request(in, out, (uint16_t)duration,
+                    (packed & 1) ? JobType::Priority : JobType::Standard);
+        return Parsed::Record;
+    }
+
+    if (size - offset < RECORD_SIZE) {
+        offset = size;
+        return Parsed::Malformed;
+    }
+    offset += RECORD_SIZE;
+    uint16_t duration = (uint16_t)((unsigned char)begin[12] | (unsigned char)begin[13] << 8);
+    char type = begin[14];
+    if (duration == 0 || (type != 'P' && type != 'S')) {
+        return Parsed::Malformed;
+    }
+    r = Request(readUint32(begin + 4), readUint32(begin + 8), duration, (JobType)type);
+    time = readUint32(begin);
+    return Parsed::Record;
+}
+
+/**
+ * @brief Skips to the next usable record without consuming it.
+ * @param time Arrival tick of that record.
+ * @return False once the trace is exhausted.
+ */
+bool TraceReader::peek(size_t &time) {
+    Request r;
+    while (cursor < size) {
+        size_t next = cursor;
+        time = lastTime;
+        Parsed parsed = parseRecord(next, r, time);
+        if (parsed == Parsed::Record) {
+            return true;
+        }
+        if (parsed == Parsed::Malformed) {
+            skipped++;
+        }
+        cursor = next;
+        lastTime = time;
+    }
+    return false;
+}
+
+/**
+ * @brief Hands pages behind the cursor back to the kernel.
+ *
+ * The mapping is read-only, so dropped pages cost nothing to discard; this keeps
+ * the resident set bounded by the chunk size rather than the trace size.
+ */
+void TraceReader::release() {
+    if (cursor - released < RELEASE_CHUNK) {
+        return;
+    }
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t end = cursor / page * page;
+    madvise((void *)(data + released), end - released, MADV_DONTNEED);
+    released = end;
+}
+
+/**
+ * @brief Counts the records at tick 0.
+ * @param numServers Number of servers at the start (unused).
+ * @return Number of initial requests.
+ */
+size_t TraceReader::initialRequests(size_t) {
+    burstTime = 0;
+    return burstSize();
+}
+
+/**
+ * @brief Finds the tick of the next record, no earlier than from.
+ * @param from First tick to consider.
+ * @param stopTime Last tick of the simulation.
+ * @return Arrival tick, or SIZE_MAX if the trace ends first.
+ */
+size_t TraceReader::nextArrivalTime(size_t from, size_t stopTime) {
+    size_t time;
+    if (!peek(time)) {
+        return SIZE_MAX;
+    }
+    time = std::max(time, from);
+    if (time > stopTime) {
+        return SIZE_MAX;
+    }
+    burstTime = time;
+    return time;
+}
+
+/**
+ * @brief Counts the records up to the tick nextArrivalTime() returned.
+ *
+ * Scans ahead without consuming; generate() then reads the same records.
+ *
+ * @return Burst size.
+ */
+size_t TraceReader::burstSize() {
+    size_t count = 0;
+    size_t offset = cursor;
+    Request r;
+    size_t time = lastTime;
+    while (offset < size) {
+        if (parseRecord(offset, r, time) == Parsed::Record) {
+            if (time > burstTime) {
+                break;
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Reads the next records.
+ * @param out Destination array.
+ * @param n Number of records to read (at most BATCH).
+ */
+void TraceReader::generate(Request *out, size_t n) {
+    size_t time = lastTime;
+    for (size_t i = 0; i < n && cursor < size;) {
+        Parsed parsed = parseRecord(cursor, out[i], time);
+        lastTime = time;
+        if (parsed == Parsed::Record) {
+            i++;
+            records++;
+        } else if (parsed == Parsed::Malformed) {
+            skipped++;
+        }
+    }
+    release();
+}
+
+/**
+ * @brief Retrieves the config text a TraceRecorder stored with the trace.
+ * @return Config-file lines, or an empty string for other traces.
+ */
+const std::string& TraceReader::getHeader() const {
+    return header;
+}
+
+/**
+ * @brief Counts the malformed records skipped so far.
+ * @return Skipped records.
+ */
+size_t TraceReader::getSkipped() const {
+    return skipped;
+}
+
+/**
+ * @brief Counts the records delivered so far.
+ * @return Delivered records.
+ */
+size_t TraceReader::getRecords() const {
+    return records;
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+/**
+ * @file trace-reader.h
+ * @brief Header file for the TraceReader class that replays recorded requests.
+ */
+
+#ifndef TRACEREADER_H
+#define TRACEREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "request.h"
+#include "workload.h"
+
+/**
+ * @class TraceReader
+ * @brief Replays requests from a trace file instead of generating them.
+ *
+ * The file is memory-mapped and parsed in place as the simulation reaches each
+ * record, and pages behind the read position are handed back to the kernel, so
+ * memory use stays flat however long the trace is. Two formats are accepted:
+ *
+ * - Text: one record per line, "time src dst duration type", separated by
+ *   spaces, tabs or commas. Addresses are dotted quads or plain integers, the
+ *   type is P or S. Blank lines and lines starting with # are ignored.
+ * - Binary: the magic "LBTR" and a little-endian uint32 version. Version 1 has
+ *   16-byte records of little-endian uint32 time, src and dst, uint16 duration,
+ *   the type character and a reserved byte. Version 2, written by TraceRecorder,
+ *   has a uint32 header length and that many bytes of config-file text, then
+ *   records of a varint time delta, uint32 src and dst, and a varint holding
+ *   the duration shifted left once with the low bit set for priority jobs.
+ *
+ * Times are ticks and should not decrease; a record stamped earlier than the
+ * current tick arrives with the next burst. Records at tick 0 form the initial
+ * queue. Malformed records are skipped and counted.
+ */
+class TraceReader : public TrafficSource {
+private:
+    static constexpr size_t HEADER_SIZE = 8;        ///< Magic and version bytes.
+    static constexpr size_t RECORD_SIZE = 16;       ///< Bytes per fixed-width record.
+    static constexpr size_t RELEASE_CHUNK = 16 << 20;   ///< Bytes read before pages are released.
+
+    /**
+     * @enum Format
+     * @brief Record layout of the open trace.
+     */
+    enum class Format {
+        Text,       ///< One record per line.
+        Fixed,      ///< Version 1 binary: 16-byte records.
+        Compact     ///< Version 2 binary: delta-encoded varint records.
+    };
+
+    /**
+     * @enum Parsed
+     * @brief Outcome of parsing one record.
+     */
+    enum class Parsed {
+        Record,     ///< A usable request.
+        Blank,      ///< A blank or comment line.
+        Malformed   ///< A record that could not be parsed.
+    };
+
+    const char *data;       ///< Mapped file, or nullptr when none is open.
+    size_t size;            ///< Mapped length in bytes.
+    Format format;          ///< Record layout.
+    std::string header;     ///< Config text stored in a version 2 trace.
+    size_t cursor;          ///< Offset of the next unread record.
+    size_t lastTime;        ///< Arrival tick of the record before the cursor.
+    size_t released;        ///< Offset below which pages have been released.
+    size_t burstTime;       ///< Tick of the burst being delivered.
+    size_t records;         ///< Records delivered so far.
+    size_t skipped;         ///< Malformed records skipped so far.
+
+    /**
+     * @brief Parses a text line into a request.
+     * @param begin First character of the line.
+     * @param end One past the last character (excluding the newline).
+     * @param r Parsed request.
+     * @param time Parsed arrival tick.
+     * @return Outcome.
+     */
+    static Parsed parseLine(const char *begin, const char *end, Request &r, size_t &time);
+
+    /**
+     * @brief Parses the record at an offset and moves the offset past it.
+     * @param offset Offset of the record (below size); updated to the next record.
+     * @param r Parsed request.
+     * @param time Arrival tick of the previous record on entry (compact traces
+     *        store deltas), and of this record on return.
+     * @return Outcome.
+     */
+    Parsed parseRecord(size_t &offset, Request &r, size_t &time) const;
+
+    /**
+     * @brief Skips to the next usable record without consuming it.
+     * @param time Arrival tick of that record.
+     * @return False once the trace is exhausted.
+     */
+    bool peek(size_t &time);
+
+    /**
+     * @brief Hands pages behind the cursor back to the kernel.
+     */
+    void release();
+
+public:
+    /**
+     * @brief Constructs a reader with no trace open (an empty trace).
+     */
+    TraceReader();
+
+    /**
+     * @brief Destructor. Unmaps the trace.
+     */
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    /**
+     * @brief Maps a trace file and detects its format.
+     * @param path Trace file path.
+     * @param error Description of the problem on failure.
+     * @return True if the trace can be replayed.
+     */
+    bool open(const std::string &path, std::string &error);
+
+    /**
+     * @brief Unmaps the trace, leaving an empty one.
+     */
+    void close();
+
+    /**
+     * @brief Counts the records at tick 0.
+     * @param numServers Number of servers at the start (unused).
+     * @return Number of initial requests.
+     */
+    size_t initialRequests(size_t numServers) override;
+
+    /**
+     * @brief Finds the tick of the next record, no earlier than from.
+     * @param from First tick to consider.
+     * @param stopTime Last tick of the simulation.
+     * @return Arrival tick, or SIZE_MAX if the trace ends first.
+     */
+    size_t nextArrivalTime(size_t from, size_t stopTime) override;
+
+    /**
+     * @brief Counts the records up to the tick nextArrivalTime() returned.
+     * @return Burst size.
+     */
+    size_t burstSize() override;
+
+    /**
+     * @brief Reads the next records.
+     * @param out Destination array.
+     * @param n Number of records to read (at most BATCH).
+     */
+    void generate(Request *out, size_t n) override;
+
+    /**
+     * @brief Retrieves the config text a TraceRecorder stored with the trace.
+     * @return Config-file lines, or an empty string for other traces.
+     */
+    const std::string& getHeader() const;
+
+    /**
+     * @brief Counts the malformed records skipped so far.
+     * @return Skipped records.
+     */
+    size_t getSkipped() const override;
+
+    /**
+     * @brief Counts the records delivered so far.
+     * @return Delivered records.
+     */
+    size_t getRecords() const;
+};
+
+#endif
\ No newline at end of file
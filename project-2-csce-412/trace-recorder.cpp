@@ -0,0 +1,190 @@
+/**
+ * @file trace-recorder.cpp
+ * @brief Implementation of the TraceRecorder class.
+ */
+
+#include "trace-recorder.h"
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+const uint32_t VERSION = 2;             ///< Trace format version written.
+const size_t MAX_RECORD = 10 + 8 + 3;   ///< Largest encoded record: time, addresses, duration.
+
+} // namespace
+
+/**
+ * @brief Constructs a recorder around a traffic source.
+ * @param inner Source of the requests to record.
+ */
+TraceRecorder::TraceRecorder(std::unique_ptr<TrafficSource> inner)
+    : source(std::move(inner)), out(nullptr), buffer(BLOCK_SIZE), used(0), time(0),
+      lastTime(0), records(0), failed(false) {}
+
+/**
+ * @brief Destructor. Finishes the trace.
+ */
+TraceRecorder::~TraceRecorder() {
+    close();
+}
+
+/**
+ * @brief Creates the trace file and writes its header.
+ *
+ * The header is the magic "LBTR", the version, and the length-prefixed config
+ * text, so the trace says which seed and options produced it.
+ *
+ * @param path Trace file path.
+ * @param config Config-file text describing the run, stored in the header.
+ * @param error Description of the problem on failure.
+ * @return True if the file was created.
+ */
+bool TraceRecorder::open(const std::string &path, const std::string &config, std::string &error) {
+    close();
+    out = fopen(path.c_str(), "wb");
+    if (out == nullptr) {
+        error = "cannot create trace " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    failed = false;
+    lastTime = 0;
+    records = 0;
+
+    char *p = buffer.data();
+    std::memcpy(p, "LBTR", 4);
+    p += 4;
+    appendUint32(p, VERSION);
+    appendUint32(p, (uint32_t)config.size());
+    used = p - buffer.data();
+    if (config.size() > buffer.size() - used) {
+        buffer.resize(used + config.size());
+    }
+    std::memcpy(buffer.data() + used, config.data(), config.size());
+    used += config.size();
+    return true;
+}
+
+/**
+ * @brief Writes any buffered records and closes the trace.
+ * @return False if any write failed.
+ */
+bool TraceRecorder::close() {
+    if (out == nullptr) {
+        return !failed;
+    }
+    writeBlock();
+    if (fclose(out) != 0) {
+        failed = true;
+    }
+    out = nullptr;
+    return !failed;
+}
+
+/**
+ * @brief Writes the buffer to the trace file.
+ */
+void TraceRecorder::writeBlock() {
+    if (used > 0 && fwrite(buffer.data(), 1, used, out) != used) {
+        failed = true;
+    }
+    used = 0;
+}
+
+/**
+ * @brief Appends an unsigned LEB128 varint to a record.
+ * @param p Destination; moved past the varint.
+ * @param value Number to append.
+ */
+void TraceRecorder::appendVarint(char *&p, size_t value) {
+    while (value >= 0x80) {
+        *p++ = (char)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (char)value;
+}
+
+/**
+ * @brief Appends a little-endian 32-bit value to a record.
+ * @param p Destination; moved past the value.
+ * @param value Number to append.
+ */
+void TraceRecorder::appendUint32(char *&p, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        *p++ = (char)(value >> shift);
+    }
+}
+
+/**
+ * @brief Records the initial queue at tick 0.
+ * @param numServers Number of servers at the start.
+ * @return Number of initial requests.
+ */
+size_t TraceRecorder::initialRequests(size_t numServers) {
+    time = 0;
+    return source->initialRequests(numServers);
+}
+
+/**
+ * @brief Finds the next arrival tick and records later requests at it.
+ * @param from First tick to consider.
+ * @param stopTime Last tick of the simulation.
+ * @return Arrival tick, or SIZE_MAX if none occur before stopTime.
+ */
+size_t TraceRecorder::nextArrivalTime(size_t from, size_t stopTime) {
+    size_t next = source->nextArrivalTime(from, stopTime);
+    if (next != SIZE_MAX) {
+        time = next;
+    }
+    return next;
+}
+
+/**
+ * @brief Counts the requests in the current burst.
+ * @return Burst size.
+ */
+size_t TraceRecorder::burstSize() {
+    return source->burstSize();
+}
+
+/**
+ * @brief Produces the next requests and records them.
+ * @param requests Destination array.
+ * @param n Number of requests to produce (at most BATCH).
+ */
+void TraceRecorder::generate(Request *requests, size_t n) {
+    source->generate(requests, n);
+    if (out == nullptr) {
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (used + MAX_RECORD > buffer.size()) {
+            writeBlock();
+        }
+        const Request &r = requests[i];
+        char *p = buffer.data() + used;
+        appendVarint(p, time - lastTime);
+        appendUint32(p, r.getIpIn());
+        appendUint32(p, r.getIpOut());
+        appendVarint(p, r.getDuration() << 1 | (r.getJobType() == JobType::Priority));
+        used = p - buffer.data();
+        lastTime = time;
+    }
+    records += n;
+}
+
+/**
+ * @brief Counts the records the wrapped source skipped.
+ * @return Skipped records.
+ */
+size_t TraceRecorder::getSkipped() const {
+    return source->getSkipped();
+}
+
+/**
+ * @brief Counts the requests recorded so far.
+ * @return Recorded requests.
+ */
+size_t TraceRecorder::getRecords() const {
+    return records;
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+/**
+ * @file trace-recorder.h
+ * @brief Header file for the TraceRecorder class that saves the requests a run receives.
+ */
+
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "request.h"
+#include "workload.h"
+
+/**
+ * @class TraceRecorder
+ * @brief Passes requests through from another traffic source and writes them to a trace.
+ *
+ * The trace is the compact (version 2) format TraceReader replays: a header of
+ * config-file text describing the run, then one record per request holding the
+ * varint gap to the previous arrival tick, both addresses, and the duration and
+ * job type packed into one varint. Generated addresses are uniformly random, so
+ * they are stored as plain 32-bit values; a typical record takes 10 bytes
+ * rather than 16. Output is collected in large blocks before each write.
+ */
+class TraceRecorder : public TrafficSource {
+private:
+    static constexpr size_t BLOCK_SIZE = 1 << 20;   ///< Bytes buffered before each write.
+
+    std::unique_ptr<TrafficSource> source; ///< Where the requests come from.
+    FILE *out;                      ///< Trace file, or nullptr when none is open.
+    std::vector<char> buffer;       ///< Pending output.
+    size_t used;                    ///< Number of bytes of buffer in use.
+    size_t time;                    ///< Arrival tick of the requests being generated.
+    size_t lastTime;                ///< Arrival tick of the last recorded request.
+    size_t records;                 ///< Requests recorded so far.
+    bool failed;                    ///< Whether a write has failed.
+
+    /**
+     * @brief Writes the buffer to the trace file.
+     */
+    void writeBlock();
+
+    /**
+     * @brief Appends an unsigned LEB128 varint to a record.
+     * @param p Destination; moved past the varint.
+     * @param value Number to append.
+     */
+    static void appendVarint(char *&p, size_t value);
+
+    /**
+     * @brief Appends a little-endian 32-bit value to a record.
+     * @param p Destination; moved past the value.
+     * @param value Number to append.
+     */
+    static void appendUint32(char *&p, uint32_t value);
+
+public:
+    /**
+     * @brief Constructs a recorder around a traffic source.
+     * @param inner Source of the requests to record.
+     */
+    explicit TraceRecorder(std::unique_ptr<TrafficSource> inner);
+
+    /**
+     * @brief Destructor. Finishes the trace.
+     */
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    /**
+     * @brief Creates the trace file and writes its header.
+     * @param path Trace file path.
+     * @param config Config-file text describing the run, stored in the header.
+     * @param error Description of the problem on failure.
+     * @return True if the file was created.
+     */
+    bool open(const std::string &path, const std::string &config, std::string &error);
+
+    /**
+     * @brief Writes any buffered records and closes the trace.
+     * @return False if any write failed.
+     */
+    bool close();
+
+    /**
+     * @brief Records the initial queue at tick 0.
+     * @param numServers Number of servers at the start.
+     * @return Number of initial requests.
+     */
+    size_t initialRequests(size_t numServers) override;
+
+    /**
+     * @brief Finds the next arrival tick and records later requests at it.
+     * @param from First tick to consider.
+     * @param stopTime Last tick of the simulation.
+     * @return Arrival tick, or SIZE_MAX if none occur before stopTime.
+     */
+    size_t nextArrivalTime(size_t from, size_t stopTime) override;
+
+    /**
+     * @brief Counts the requests in the current burst.
+     * @return Burst size.
+     */
+    size_t burstSize() override;
+
+    /**
+     * @brief Produces the next requests and records them.
+     * @param requests Destination array.
+     * @param n Number of requests to produce (at most BATCH).
+     */
+    void generate(Request *requests, size_t n) override;
+
+    /**
+     * @brief Counts the records the wrapped source skipped.
+     * @return Skipped records.
+     */
+    size_t getSkipped() const override;
+
+    /**
+     * @brief Counts the requests recorded so far.
+     * @return Recorded requests.
+     */
+    size_t getRecords() const;
+};
+
+#endif
\ No newline at end of file
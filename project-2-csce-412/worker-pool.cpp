@@ -0,0 +1,92 @@
+/**
+ * @file worker-pool.cpp
+ * @brief Implementation of the WorkerPool class.
+ */
+
+#include "worker-pool.h"
+
+namespace {
+
+const int SPINS = 4096;     ///< Busy-wait iterations before a waiting thread yields.
+
+/**
+ * @brief Waits until a condition holds, spinning first and then yielding.
+ * @param done Condition to wait for.
+ */
+template <typename Condition>
+void waitUntil(Condition done) {
+    for (int spin = 0; !done(); spin++) {
+        if (spin >= SPINS) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Starts a pool.
+ * @param workers Number of workers, including the calling thread (at least 1).
+ */
+WorkerPool::WorkerPool(size_t workers) : task(nullptr), round(0), pending(0), stopping(false) {
+    for (size_t i = 1; i < workers; i++) {
+        threads.emplace_back(&WorkerPool::work, this, i);
+    }
+}
+
+/**
+ * @brief Stops and joins the worker threads.
+ */
+WorkerPool::~WorkerPool() {
+    stopping.store(true, std::memory_order_release);
+    round.fetch_add(1, std::memory_order_release);
+    for (std::thread &t : threads) {
+        t.join();
+    }
+}
+
+/**
+ * @brief Retrieves the number of workers.
+ * @return Number of workers, including the calling thread.
+ */
+size_t WorkerPool::size() const {
+    return threads.size() + 1;
+}
+
+/**
+ * @brief Main loop of a worker thread.
+ * 
+ * Each round is announced by incrementing round after publishing the task; the
+ * worker reports back by decrementing pending, which also publishes everything
+ * the task wrote to the thread waiting in run().
+ * 
+ * @param worker Worker index.
+ */
+void WorkerPool::work(size_t worker) {
+    uint64_t seen = 0;
+    while (true) {
+        waitUntil([&] { return round.load(std::memory_order_acquire) != seen; });
+        seen = round.load(std::memory_order_acquire);
+        if (stopping.load(std::memory_order_acquire)) {
+            return;
+        }
+        (*task)(worker);
+        pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+/**
+ * @brief Runs a task once on every worker and waits until all have returned.
+ * @param fn Task, called with the worker index from 0 to size() - 1.
+ */
+void WorkerPool::run(const std::function<void(size_t)> &fn) {
+    if (threads.empty()) {
+        fn(0);
+        return;
+    }
+    task = &fn;
+    pending.store(threads.size(), std::memory_order_relaxed);
+    round.fetch_add(1, std::memory_order_release);
+    fn(0);
+    waitUntil([&] { return pending.load(std::memory_order_acquire) == 0; });
+}
\ No newline at end of file
@@ -0,0 +1,203 @@
+/**
+ * @file workload.cpp
+ * @brief Implementation of the Workload class.
+ */
+
+#include "workload.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Parses an arrival model name ("bursty" or "poisson").
+ * @param name Model name.
+ * @param kind Parsed kind on success.
+ * @return True if the name was recognized.
+ */
+bool parseArrivalKind(const std::string &name, ArrivalKind &kind) {
+    if (name == "bursty") {
+        kind = ArrivalKind::Bursty;
+    } else if (name == "poisson") {
+        kind = ArrivalKind::Poisson;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Parses a duration distribution name ("uniform", "exponential" or "constant").
+ * @param name Distribution name.
+ * @param kind Parsed kind on success.
+ * @return True if the name was recognized.
+ */
+bool parseDurationKind(const std::string &name, DurationKind &kind) {
+    if (name == "uniform") {
+        kind = DurationKind::Uniform;
+    } else if (name == "exponential") {
+        kind = DurationKind::Exponential;
+    } else if (name == "constant") {
+        kind = DurationKind::Constant;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Constructs a workload.
+ * @param streams Random streams to draw from.
+ * @param arrivalModel Arrival process parameters.
+ * @param durationModel Duration distribution parameters.
+ */
+Workload::Workload(RandomStreams streams, const ArrivalModel &arrivalModel,
+                   const DurationModel &durationModel)
+    : rng(std::move(streams)), arrivals(arrivalModel), durations(durationModel) {
+    if (arrivals.kind == ArrivalKind::Poisson) {
+        burstProbability = 1.0 - std::exp(-arrivals.rate);
+    } else {
+        burstProbability = arrivals.probability;
+    }
+}
+
+/**
+ * @brief Sizes the initial queue at 20 requests per server.
+ * @param numServers Number of servers at the start.
+ * @return Number of initial requests.
+ */
+size_t Workload::initialRequests(size_t numServers) {
+    return numServers * 20;
+}
+
+/**
+ * @brief Finds the next tick (starting at from) on which new requests arrive.
+ * 
+ * The gap to the next burst is geometric, so it is drawn by inversion instead of
+ * rolling every tick.
+ * 
+ * @param from First tick to consider.
+ * @param stopTime Last tick of the simulation.
+ * @return Arrival tick, or SIZE_MAX if none occur before stopTime.
+ */
+size_t Workload::nextArrivalTime(size_t from, size_t stopTime) {
+    if (burstProbability <= 0.0 || from > stopTime) {
+        return SIZE_MAX;
+    }
+    if (burstProbability >= 1.0) {
+        return from;
+    }
+    double u = 1.0 - uniformUnit(rng.arrivals->next());
+    double gap = std::floor(std::log(u) / std::log(1.0 - burstProbability));
+    if (gap > (double)(stopTime - from)) {
+        return SIZE_MAX;
+    }
+    return from + (size_t)gap;
+}
+
+/**
+ * @brief Draws the number of requests in an arrival burst.
+ * 
+ * Bursty arrivals are uniform over [1, maxBurst]. Poisson arrivals are drawn from
+ * the Poisson distribution conditioned on at least one arrival, by inversion for
+ * small rates and by a rounded normal approximation for large ones.
+ * 
+ * @return Burst size (at least one).
+ */
+size_t Workload::burstSize() {
+    if (arrivals.kind == ArrivalKind::Bursty) {
+        return 1 + uniformBelow(rng.arrivals->next(), (uint32_t)arrivals.maxBurst);
+    }
+
+    double lambda = arrivals.rate;
+    if (lambda > 30.0) {
+        double u1 = 1.0 - uniformUnit(rng.arrivals->next());
+        double u2 = uniformUnit(rng.arrivals->next());
+        double z = std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+        return (size_t)std::max(1.0, std::round(lambda + std::sqrt(lambda) * z));
+    }
+
+    // Walk the CDF of the zero-truncated distribution
+    double p0 = std::exp(-lambda);
+    double target = uniformUnit(rng.arrivals->next()) * (1.0 - p0);
+    double term = p0;
+    double cumulative = 0.0;
+    size_t k = 0;
+    do {
+        k++;
+        term *= lambda / (double)k;
+        cumulative += term;
+    } while (cumulative < target && term > 0.0);
+    return k;
+}
+
+/**
+ * @brief Turns a random draw into an IP address.
+ * 
+ * Each 16-bit slice of the draw is scaled onto one octet.
+ * 
+ * @param draw Random 64-bit value.
+ * @return A packed IPv4 address with every octet between 1 and 255.
+ */
+uint32_t Workload::randomIP(uint64_t draw) {
+    uint32_t ip = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        ip |= (uint32_t)(1 + (((draw & 0xffff) * 255) >> 16)) << shift;
+        draw >>= 16;
+    }
+    return ip;
+}
+
+/**
+ * @brief Turns a random bit into a job type.
+ * 
+ * @param bit Random value whose lowest bit is used.
+ * @return The job type (Standard or Priority).
+ */
+JobType Workload::randomJobType(uint64_t bit) {
+    return (bit & 1) == 0 ? JobType::Standard : JobType::Priority;
+}
+
+/**
+ * @brief Turns a random draw into a request duration.
+ * 
+ * @param draw Random 64-bit value.
+ * @return The duration, at least one tick and at most UINT16_MAX.
+ */
+uint16_t Workload::randomDuration(uint64_t draw) const {
+    double value;
+    switch (durations.kind) {
+    case DurationKind::Exponential:
+        value = std::round(-durations.mean * std::log(1.0 - uniformUnit(draw)));
+        break;
+    case DurationKind::Constant:
+        value = std::round(durations.mean);
+        break;
+    default:
+        value = (double)(durations.min +
+                         uniformBelow(draw, (uint32_t)(durations.max - durations.min + 1)));
+        break;
+    }
+    return (uint16_t)std::min(std::max(value, 1.0), (double)UINT16_MAX);
+}
+
+/**
+ * @brief Generates random requests.
+ * 
+ * Draws are taken in batches from the address, duration and job type streams;
+ * a single draw covers one address, one duration, or 64 job types.
+ * 
+ * @param out Destination array.
+ * @param n Number of requests to generate (at most BATCH).
+ */
+void Workload::generate(Request *out, size_t n) {
+    uint64_t addresses[2 * BATCH];
+    uint64_t draws[BATCH];
+    uint64_t types[BATCH / 64];
+    rng.addresses->fill(addresses, 2 * n);
+    rng.durations->fill(draws, n);
+    rng.jobTypes->fill(types, (n + 63) / 64);
+
+    for (size_t i = 0; i < n; i++) {
+        out[i] = Request(randomIP(addresses[2 * i]), randomIP(addresses[2 * i + 1]),
+                         randomDuration(draws[i]), randomJobType(types[i / 64] >> (i % 64)));
+    }
+}
\ No newline at end of file
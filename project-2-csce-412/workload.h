@@ -0,0 +1,200 @@
+/**
+ * @file workload.h
+ * @brief Header file for the Workload class that generates synthetic requests.
+ */
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "request.h"
+#include "rng.h"
+
+/**
+ * @enum ArrivalKind
+ * @brief Shape of the arrival process.
+ */
+enum class ArrivalKind {
+    Bursty,     ///< Each tick, a burst of 1..maxBurst requests arrives with a fixed probability.
+    Poisson     ///< Each tick, a Poisson-distributed number of requests arrives.
+};
+
+/**
+ * @struct ArrivalModel
+ * @brief Parameters of the arrival process.
+ */
+struct ArrivalModel {
+    ArrivalKind kind = ArrivalKind::Bursty; ///< Shape of the arrival process.
+    double probability = 0.05;              ///< Bursty: chance of a burst on any tick.
+    size_t maxBurst = 3;                    ///< Bursty: largest burst size.
+    double rate = 0.1;                      ///< Poisson: mean arrivals per tick.
+};
+
+/**
+ * @enum DurationKind
+ * @brief Distribution of request durations.
+ */
+enum class DurationKind {
+    Uniform,        ///< Uniform over [min, max].
+    Exponential,    ///< Exponential with the given mean, rounded, at least 1.
+    Constant        ///< Always mean, rounded.
+};
+
+/**
+ * @struct DurationModel
+ * @brief Parameters of the duration distribution.
+ */
+struct DurationModel {
+    DurationKind kind = DurationKind::Uniform;  ///< Distribution of durations.
+    size_t min = 3;                             ///< Uniform: shortest duration.
+    size_t max = 16;                            ///< Uniform: longest duration.
+    double mean = 9.5;                          ///< Exponential and constant: mean duration.
+};
+
+/**
+ * @brief Parses an arrival model name ("bursty" or "poisson").
+ * @param name Model name.
+ * @param kind Parsed kind on success.
+ * @return True if the name was recognized.
+ */
+bool parseArrivalKind(const std::string &name, ArrivalKind &kind);
+
+/**
+ * @brief Parses a duration distribution name ("uniform", "exponential" or "constant").
+ * @param name Distribution name.
+ * @param kind Parsed kind on success.
+ * @return True if the name was recognized.
+ */
+bool parseDurationKind(const std::string &name, DurationKind &kind);
+
+/**
+ * @class TrafficSource
+ * @brief Supplies the requests that arrive during a simulation.
+ *
+ * The load balancer asks how many requests are queued at the start, then
+ * repeatedly asks for the next arrival tick, the size of the burst on it, and
+ * the requests themselves in batches of at most BATCH.
+ */
+class TrafficSource {
+public:
+    /// Largest number of requests generate() produces per call.
+    static constexpr size_t BATCH = 256;
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~TrafficSource() = default;
+
+    /**
+     * @brief Counts the requests queued before the first tick.
+     * @param numServers Number of servers at the start.
+     * @return Number of requests the next generate() calls produce for the initial queue.
+     */
+    virtual size_t initialRequests(size_t numServers) = 0;
+
+    /**
+     * @brief Finds the next tick (starting at from) on which new requests arrive.
+     * @param from First tick to consider.
+     * @param stopTime Last tick of the simulation.
+     * @return Arrival tick, or SIZE_MAX if none occur before stopTime.
+     */
+    virtual size_t nextArrivalTime(size_t from, size_t stopTime) = 0;
+
+    /**
+     * @brief Counts the requests arriving on the tick nextArrivalTime() returned.
+     * @return Burst size (at least one).
+     */
+    virtual size_t burstSize() = 0;
+
+    /**
+     * @brief Produces the next requests.
+     * @param out Destination array.
+     * @param n Number of requests to produce (at most BATCH).
+     */
+    virtual void generate(Request *out, size_t n) = 0;
+
+    /**
+     * @brief Counts input records that could not be turned into requests.
+     * @return Skipped records (none for generated traffic).
+     */
+    virtual size_t getSkipped() const { return 0; }
+};
+
+/**
+ * @class Workload
+ * @brief Generates synthetic requests and decides when they arrive.
+ *
+ * Arrivals are modelled as bursts: each tick has the same independent chance of a
+ * burst, so the gap to the next one is geometric and is drawn directly, and the
+ * burst size is drawn when it happens. Both arrival models fit this shape.
+ */
+class Workload : public TrafficSource {
+private:
+    RandomStreams rng;          ///< Random streams for arrivals, durations, addresses and job types.
+    ArrivalModel arrivals;      ///< Arrival process parameters.
+    DurationModel durations;    ///< Duration distribution parameters.
+    double burstProbability;    ///< Chance that at least one request arrives on a tick.
+
+    /**
+     * @brief Turns a random draw into an IP address.
+     * @param draw Random 64-bit value.
+     * @return Packed IPv4 address.
+     */
+    static uint32_t randomIP(uint64_t draw);
+
+    /**
+     * @brief Turns a random bit into a job type.
+     * @param bit Random value whose lowest bit is used.
+     * @return Job type.
+     */
+    static JobType randomJobType(uint64_t bit);
+
+    /**
+     * @brief Turns a random draw into a request duration.
+     * @param draw Random 64-bit value.
+     * @return Request duration.
+     */
+    uint16_t randomDuration(uint64_t draw) const;
+
+public:
+    /**
+     * @brief Constructs a workload.
+     * @param streams Random streams to draw from.
+     * @param arrivalModel Arrival process parameters.
+     * @param durationModel Duration distribution parameters.
+     */
+    Workload(RandomStreams streams, const ArrivalModel &arrivalModel = ArrivalModel(),
+             const DurationModel &durationModel = DurationModel());
+
+    /**
+     * @brief Sizes the initial queue at 20 requests per server.
+     * @param numServers Number of servers at the start.
+     * @return Number of initial requests.
+     */
+    size_t initialRequests(size_t numServers) override;
+
+    /**
+     * @brief Finds the next tick (starting at from) on which new requests arrive.
+     * @param from First tick to consider.
+     * @param stopTime Last tick of the simulation.
+     * @return Arrival tick, or SIZE_MAX if none occur before stopTime.
+     */
+    size_t nextArrivalTime(size_t from, size_t stopTime) override;
+
+    /**
+     * @brief Draws the number of requests in an arrival burst.
+     * @return Burst size (at least one).
+     */
+    size_t burstSize() override;
+
+    /**
+     * @brief Generates random requests.
+     * @param out Destination array.
+     * @param n Number of requests to generate (at most BATCH).
+     */
+    void generate(Request *out, size_t n) override;
+};
+
+#endif
\ No newline at end of file